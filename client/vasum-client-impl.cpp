@@ -104,6 +104,28 @@ void convert(const api::ZoneInfoOut& info, Zone& zone)
     zone = vsmZone;
 }
 
+void convert(const api::NetDevStatsOut& in, VsmNetdevStats*& out, unsigned int& count)
+{
+    out = reinterpret_cast<VsmNetdevStats*>(calloc(in.values.size(), sizeof(VsmNetdevStats)));
+    count = in.values.size();
+    for (size_t i = 0; i < in.values.size(); ++i) {
+        const api::NetDevStats& stats = in.values[i];
+        out[i].name = ::strdup(stats.netDev.c_str());
+        out[i].rxBytes = stats.rxBytes;
+        out[i].txBytes = stats.txBytes;
+        out[i].rxPackets = stats.rxPackets;
+        out[i].txPackets = stats.txPackets;
+        out[i].rxDropped = stats.rxDropped;
+        out[i].txDropped = stats.txDropped;
+        out[i].rxErrors = stats.rxErrors;
+        out[i].txErrors = stats.txErrors;
+        out[i].rxBytesRate = stats.rxBytesRate;
+        out[i].txBytesRate = stats.txBytesRate;
+        out[i].rxPacketsRate = stats.rxPacketsRate;
+        out[i].txPacketsRate = stats.txPacketsRate;
+    }
+}
+
 std::string toString(const in_addr* addr)
 {
     char buf[INET_ADDRSTRLEN];
@@ -778,6 +800,93 @@ VsmStatus Client::vsm_destroy_netdev(const char* id, const char* devId) noexcept
     });
 }
 
+VsmStatus Client::vsm_netdev_apply(const char* id,
+                                   const VsmNetdevConfig* config,
+                                   VsmArrayString* changes) noexcept
+{
+    return coverException([&] {
+        IS_SET(id);
+        IS_SET(config);
+        IS_SET(config->name);
+        IS_SET(changes);
+        if (config->addressCount > 0) {
+            IS_SET(config->addresses);
+        }
+        if (config->routeCount > 0) {
+            IS_SET(config->routes);
+        }
+
+        auto in = std::make_shared<api::NetDevApplyIn>();
+        in->zone = id;
+        in->netDev = config->name;
+        switch (config->type) {
+            case VSMNETDEV_VETH:
+                in->type = api::NETDEV_VETH;
+                break;
+            case VSMNETDEV_PHYS:
+                in->type = api::NETDEV_PHYS;
+                break;
+            case VSMNETDEV_MACVLAN:
+                in->type = api::NETDEV_MACVLAN;
+                break;
+            default:
+                throw InvalidArgumentException("Unknown network device type");
+        }
+        in->hostDev = config->hostDev ? config->hostDev : "";
+        in->macvlanMode = config->macvlanMode;
+        in->mtu = config->mtu;
+        in->mac = config->mac ? config->mac : "";
+        for (unsigned int i = 0; i < config->addressCount; ++i) {
+            IS_SET(config->addresses[i]);
+            in->addresses.push_back(config->addresses[i]);
+        }
+        for (unsigned int i = 0; i < config->routeCount; ++i) {
+            const VsmNetdevRoute& route = config->routes[i];
+            IS_SET(route.dst);
+            in->routes.push_back({route.dst, route.gateway ? route.gateway : "", route.metric});
+        }
+        in->up = config->up != 0;
+
+        api::NetDevApplyOut out = *mClient->callSync<api::NetDevApplyIn, api::NetDevApplyOut>(
+            api::cargo::ipc::METHOD_NETDEV_APPLY,
+            in);
+        convert(out, *changes);
+    });
+}
+
+VsmStatus Client::vsm_netdev_set_bandwidth(const char* id,
+                                           const char* netdevId,
+                                           uint64_t downloadRate,
+                                           uint64_t uploadRate,
+                                           uint32_t burst) noexcept
+{
+    return coverException([&] {
+        IS_SET(id);
+        IS_SET(netdevId);
+
+        mClient->callSync<api::SetNetDevBandwidthIn, api::Void>(
+            api::cargo::ipc::METHOD_SET_NETDEV_BANDWIDTH,
+            std::make_shared<api::SetNetDevBandwidthIn>(
+                api::SetNetDevBandwidthIn{ id, netdevId, downloadRate, uploadRate, burst }));
+    });
+}
+
+VsmStatus Client::vsm_zone_get_netdev_stats(const char* id,
+                                            VsmNetdevStats** stats,
+                                            unsigned int* count) noexcept
+{
+    return coverException([&] {
+        IS_SET(id);
+        IS_SET(stats);
+        IS_SET(count);
+
+        api::NetDevStatsOut out = *mClient->callSync<api::ZoneId, api::NetDevStatsOut>(
+            api::cargo::ipc::METHOD_GET_NETDEV_STATS,
+            std::make_shared<api::ZoneId>(api::ZoneId{ id }));
+        convert(out, *stats, *count);
+    });
+}
+
 VsmStatus Client::vsm_declare_file(const char* id,
                               VsmFileType type,
                               const char *path,
@@ -845,6 +954,59 @@ VsmStatus Client::vsm_declare_link(const char* source,
     });
 }
 
+VsmStatus Client::vsm_declare_batch(const char* id,
+                                    const VsmDeclaration* declarations,
+                                    unsigned int count) noexcept
+{
+    return coverException([&] {
+        IS_SET(id);
+        if (count > 0) {
+            IS_SET(declarations);
+        }
+
+        auto batch = std::make_shared<api::DeclareBatchIn>();
+        batch->zone = id;
+        batch->declarations.reserve(count);
+        for (unsigned int i = 0; i < count; ++i) {
+            const VsmDeclaration& declaration = declarations[i];
+            IS_SET(declaration.target);
+            if (declaration.type != VSMDECLARATION_FILE) {
+                IS_SET(declaration.source);
+            }
+            if (declaration.type == VSMDECLARATION_MOUNT) {
+                IS_SET(declaration.fsType);
+            }
+
+            api::DeclarationIn in;
+            switch (declaration.type) {
+                case VSMDECLARATION_FILE:
+                    in.kind = api::DECLARATION_FILE;
+                    break;
+                case VSMDECLARATION_MOUNT:
+                    in.kind = api::DECLARATION_MOUNT;
+                    break;
+                case VSMDECLARATION_LINK:
+                    in.kind = api::DECLARATION_LINK;
+                    break;
+                default:
+                    throw InvalidArgumentException("Unknown declaration type");
+            }
+            in.fileType = declaration.fileType;
+            in.source = declaration.source ? declaration.source : "";
+            in.target = declaration.target;
+            in.fsType = declaration.fsType ? declaration.fsType : "";
+            in.flags = declaration.flags;
+            in.mode = static_cast<int32_t>(declaration.mode);
+            in.data = declaration.data ? declaration.data : "";
+            batch->declarations.push_back(std::move(in));
+        }
+
+        mClient->callSync<api::DeclareBatchIn, api::Declarations>(
+            api::cargo::ipc::METHOD_DECLARE_BATCH,
+            batch);
+    });
+}
+
 VsmStatus Client::vsm_list_declarations(const char* id, VsmArrayString* declarations) noexcept
 {
     return coverException([&] {
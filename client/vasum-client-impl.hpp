@@ -327,6 +327,29 @@ public:
      */
     VsmStatus vsm_destroy_netdev(const char* zone, const char* devId) noexcept;
 
+    /**
+     *  @see ::vsm_netdev_apply
+     */
+    VsmStatus vsm_netdev_apply(const char* zone,
+                               const VsmNetdevConfig* config,
+                               VsmArrayString* changes) noexcept;
+
+    /**
+     *  @see ::vsm_netdev_set_bandwidth
+     */
+    VsmStatus vsm_netdev_set_bandwidth(const char* zone,
+                                       const char* netdevId,
+                                       uint64_t downloadRate,
+                                       uint64_t uploadRate,
+                                       uint32_t burst) noexcept;
+
+    /**
+     *  @see ::vsm_zone_get_netdev_stats
+     */
+    VsmStatus vsm_zone_get_netdev_stats(const char* zone,
+                                        VsmNetdevStats** stats,
+                                        unsigned int* count) noexcept;
+
     /**
      *  @see ::vsm_declare_file
      */
@@ -355,6 +378,13 @@ public:
                                const char* target,
                                VsmString* id) noexcept;
 
+    /**
+     * @see ::vsm_declare_batch
+     */
+    VsmStatus vsm_declare_batch(const char* zone,
+                                const VsmDeclaration* declarations,
+                                unsigned int count) noexcept;
+
     /**
      * @see ::vsm_list_declarations
      */
@@ -162,6 +162,17 @@ API void vsm_netdev_free(VsmNetdev netdev)
     free(n);
 }
 
+API void vsm_netdev_stats_free(VsmNetdevStats* stats, unsigned int count)
+{
+    if (!stats) {
+        return;
+    }
+    for (unsigned int i = 0; i < count; ++i) {
+        free(stats[i].name);
+    }
+    free(stats);
+}
+
 API void vsm_client_free(VsmClient client)
 {
     if (client != NULL) {
@@ -390,6 +401,32 @@ API VsmStatus vsm_destroy_netdev(VsmClient client, const char* zone, const char*
     return getClient(client).vsm_destroy_netdev(zone, devId);
 }
 
+API VsmStatus vsm_netdev_apply(VsmClient client,
+                               const char* zone,
+                               const VsmNetdevConfig* config,
+                               VsmArrayString* changes)
+{
+    return getClient(client).vsm_netdev_apply(zone, config, changes);
+}
+
+API VsmStatus vsm_netdev_set_bandwidth(VsmClient client,
+                                       const char* zone,
+                                       const char* netdevId,
+                                       uint64_t downloadRate,
+                                       uint64_t uploadRate,
+                                       uint32_t burst)
+{
+    return getClient(client).vsm_netdev_set_bandwidth(zone, netdevId, downloadRate, uploadRate, burst);
+}
+
+API VsmStatus vsm_zone_get_netdev_stats(VsmClient client,
+                                        const char* zone,
+                                        VsmNetdevStats** stats,
+                                        unsigned int* count)
+{
+    return getClient(client).vsm_zone_get_netdev_stats(zone, stats, count);
+}
+
 API VsmStatus vsm_declare_file(VsmClient client,
                                const char* zone,
                                VsmFileType type,
@@ -420,6 +457,14 @@ API VsmStatus vsm_declare_link(VsmClient client,
     return getClient(client).vsm_declare_link(source, zone, target, NULL);
 }
 
+API VsmStatus vsm_declare_batch(VsmClient client,
+                                const char* zone,
+                                const VsmDeclaration* declarations,
+                                unsigned int count)
+{
+    return getClient(client).vsm_declare_batch(zone, declarations, count);
+}
+
 API VsmStatus vsm_list_declarations(VsmClient client,
                                     const char* zone,
                                     VsmArrayString* declarations)
@@ -248,6 +248,83 @@ typedef enum {
     VSMFILE_REGULAR
 } VsmFileType;
 
+/**
+ * Declaration type
+ */
+typedef enum {
+    VSMDECLARATION_FILE,
+    VSMDECLARATION_MOUNT,
+    VSMDECLARATION_LINK
+} VsmDeclarationType;
+
+/**
+ * Single declaration passed to vsm_declare_batch()
+ *
+ * Meaning of the fields is the same as of the parameters of
+ * ::vsm_declare_file, ::vsm_declare_mount and ::vsm_declare_link.
+ * Fields not used by the given type are ignored.
+ */
+typedef struct {
+    VsmDeclarationType type;  /**< declaration type */
+    VsmFileType fileType;     /**< file type (file) */
+    const char* source;       /**< source path in host (mount, link) */
+    const char* target;       /**< path in zone (file, mount, link) */
+    const char* fsType;       /**< filesystem type (mount) */
+    uint64_t flags;           /**< open flags (file) or mount flags (mount) */
+    mode_t mode;              /**< file mode (file) */
+    const char* data;         /**< additional mount data (mount), may be NULL */
+} VsmDeclaration;
+
+/**
+ * Static route of a network device passed to vsm_netdev_apply()
+ */
+typedef struct {
+    const char* dst;          /**< destination in CIDR notation, e.g. "0.0.0.0/0" for default route */
+    const char* gateway;      /**< gateway address, NULL for directly connected network */
+    unsigned int metric;      /**< route priority */
+} VsmNetdevRoute;
+
+/**
+ * Desired state of a network device passed to vsm_netdev_apply()
+ *
+ * Addresses and routes are complete lists: the ones not listed are removed.
+ */
+typedef struct {
+    const char* name;                 /**< network device name in zone */
+    VsmNetdevType type;               /**< device type used when the device doesn't exist */
+    const char* hostDev;              /**< bridge (veth) or lower device (macvlan), may be NULL */
+    enum macvlan_mode macvlanMode;    /**< macvlan mode (macvlan) */
+    unsigned int mtu;                 /**< mtu, 0 keeps the current value */
+    const char* mac;                  /**< hardware address, NULL keeps the current value */
+    const char* const* addresses;     /**< ipv4/ipv6 addresses in CIDR notation */
+    unsigned int addressCount;        /**< number of addresses */
+    const VsmNetdevRoute* routes;     /**< static routes through the device */
+    unsigned int routeCount;          /**< number of routes */
+    int up;                           /**< non zero if the device should be up */
+} VsmNetdevConfig;
+
+/**
+ * Traffic statistics of a network device returned by vsm_zone_get_netdev_stats()
+ *
+ * Rates are computed from the two last samples taken by the server,
+ * they are 0 if sampling is disabled in the server configuration.
+ */
+typedef struct {
+    char* name;                   /**< network device name in zone */
+    uint64_t rxBytes;             /**< received bytes */
+    uint64_t txBytes;             /**< transmitted bytes */
+    uint64_t rxPackets;           /**< received packets */
+    uint64_t txPackets;           /**< transmitted packets */
+    uint64_t rxDropped;           /**< dropped received packets */
+    uint64_t txDropped;           /**< dropped transmitted packets */
+    uint64_t rxErrors;            /**< receive errors */
+    uint64_t txErrors;            /**< transmit errors */
+    uint64_t rxBytesRate;         /**< received bytes per second */
+    uint64_t txBytesRate;         /**< transmitted bytes per second */
+    uint64_t rxPacketsRate;       /**< received packets per second */
+    uint64_t txPacketsRate;       /**< transmitted packets per second */
+} VsmNetdevStats;
+
 /**
  * Event dispacher types.
  */
@@ -843,6 +920,76 @@ VsmStatus vsm_lookup_netdev_by_name(VsmClient client,
  */
 VsmStatus vsm_destroy_netdev(VsmClient client, const char* zone, const char* devId);
 
+/**
+ * Bring network device in zone to the given state
+ *
+ * The device is created if it doesn't exist. Then the differences in link
+ * attributes, addresses and static routes are sent to the kernel at once.
+ * The configuration is validated before the first change, but the changes
+ * are applied one by one and not rolled back: when one of them fails,
+ * the device may be left partially configured and an error is returned.
+ * Applying the same configuration again completes it, and changes nothing
+ * when the device is already in the given state.
+ *
+ * @param[in] client vasum-server's client
+ * @param[in] zone zone name
+ * @param[in] config desired network device state
+ * @param[out] changes descriptions of the changes that were made
+ * @return status of this function call
+ */
+VsmStatus vsm_netdev_apply(VsmClient client,
+                           const char* zone,
+                           const VsmNetdevConfig* config,
+                           VsmArrayString* changes);
+
+/**
+ * Limit bandwidth of zone veth device
+ *
+ * Traffic control is attached to the host side of the veth pair: traffic sent
+ * to the zone is shaped by a token bucket, traffic sent by the zone above the
+ * limit is dropped. Limits are saved and applied again when the zone starts.
+ * Each device of a zone has its own limits.
+ *
+ * @param[in] client vasum-server's client
+ * @param[in] zone zone name
+ * @param[in] netdevId veth device name in zone
+ * @param[in] downloadRate limit of traffic sent to the zone in bits per second, 0 means no limit
+ * @param[in] uploadRate limit of traffic sent by the zone in bits per second, 0 means no limit
+ * @param[in] burst bytes which can be sent at full speed, 0 selects it automatically
+ * @return status of this function call
+ */
+VsmStatus vsm_netdev_set_bandwidth(VsmClient client,
+                                   const char* zone,
+                                   const char* netdevId,
+                                   uint64_t downloadRate,
+                                   uint64_t uploadRate,
+                                   uint32_t burst);
+
+/**
+ * Get traffic statistics of all network devices in zone
+ *
+ * Counters are read from the kernel on every call, so they are up to date.
+ *
+ * @param[in] client vasum-server's client
+ * @param[in] zone zone name
+ * @param[out] stats array of statistics, one per network device
+ * @param[out] count number of elements in @p stats
+ * @return status of this function call
+ * @remark Use vsm_netdev_stats_free() to free memory occupied by @p stats.
+ */
+VsmStatus vsm_zone_get_netdev_stats(VsmClient client,
+                                    const char* zone,
+                                    VsmNetdevStats** stats,
+                                    unsigned int* count);
+
+/**
+ * Release array of network device statistics
+ *
+ * @param[in] stats array returned by vsm_zone_get_netdev_stats()
+ * @param[in] count number of elements in @p stats
+ */
+void vsm_netdev_stats_free(VsmNetdevStats* stats, unsigned int count);
+
 /**
  * Create file, directory or pipe in zone
  *
@@ -905,6 +1052,23 @@ VsmStatus vsm_declare_link(VsmClient client,
                            const char* zone,
                            const char *target);
 
+/**
+ * Declare many files, mounts and links at once
+ *
+ * All declarations are validated and stored atomically: if any of them
+ * is invalid or already declared, none of them is stored.
+ *
+ * @param[in] client vasum-server's client
+ * @param[in] zone zone id
+ * @param[in] declarations array of declarations
+ * @param[in] count number of elements in declarations
+ * @return status of this function call
+ */
+VsmStatus vsm_declare_batch(VsmClient client,
+                            const char* zone,
+                            const VsmDeclaration* declarations,
+                            unsigned int count);
+
 /**
  * Get all declarations
  *
@@ -87,6 +87,7 @@ typedef api::StringPair ConnectionState;
 typedef api::VectorOfStrings ZoneIds;
 typedef api::VectorOfStrings Declarations;
 typedef api::VectorOfStrings NetDevList;
+typedef api::VectorOfStrings NetDevApplyOut;
 typedef api::VectorOfStringPairs Connections;
 typedef api::VectorOfStringPairs GetNetDevAttrs;
 
@@ -159,6 +160,110 @@ struct DeleteNetdevIpAddressIn {
     )
 };
 
+struct SetNetDevBandwidthIn {
+    std::string zone;
+    std::string netDev;
+    uint64_t downloadRate; // bits per second, 0 means no limit
+    uint64_t uploadRate;   // bits per second, 0 means no limit
+    uint32_t burst;        // bytes, 0 selects it automatically
+
+    CARGO_REGISTER
+    (
+        zone,
+        netDev,
+        downloadRate,
+        uploadRate,
+        burst
+    )
+};
+
+struct NetDevStats {
+    std::string netDev;
+    uint64_t rxBytes;
+    uint64_t txBytes;
+    uint64_t rxPackets;
+    uint64_t txPackets;
+    uint64_t rxDropped;
+    uint64_t txDropped;
+    uint64_t rxErrors;
+    uint64_t txErrors;
+    uint64_t rxBytesRate;   // per second
+    uint64_t txBytesRate;   // per second
+    uint64_t rxPacketsRate; // per second
+    uint64_t txPacketsRate; // per second
+
+    CARGO_REGISTER
+    (
+        netDev,
+        rxBytes,
+        txBytes,
+        rxPackets,
+        txPackets,
+        rxDropped,
+        txDropped,
+        rxErrors,
+        txErrors,
+        rxBytesRate,
+        txBytesRate,
+        rxPacketsRate,
+        txPacketsRate
+    )
+};
+
+struct NetDevStatsOut {
+    std::vector<NetDevStats> values;
+
+    CARGO_REGISTER
+    (
+        values
+    )
+};
+
+struct NetDevRouteIn {
+    std::string dst;     // CIDR notation
+    std::string gateway; // empty for directly connected network
+    uint32_t metric;
+
+    CARGO_REGISTER
+    (
+        dst,
+        gateway,
+        metric
+    )
+};
+
+// Types of NetDevApplyIn
+const int32_t NETDEV_VETH = 0;
+const int32_t NETDEV_PHYS = 1;
+const int32_t NETDEV_MACVLAN = 2;
+
+struct NetDevApplyIn {
+    std::string zone;
+    std::string netDev;
+    int32_t type;                       // NETDEV_*, used when netDev is created
+    std::string hostDev;                // bridge (veth) or lower device (macvlan)
+    uint32_t macvlanMode;
+    uint32_t mtu;                       // 0 keeps the current value
+    std::string mac;                    // empty keeps the current value
+    std::vector<std::string> addresses; // CIDR notation
+    std::vector<NetDevRouteIn> routes;
+    bool up;
+
+    CARGO_REGISTER
+    (
+        zone,
+        netDev,
+        type,
+        hostDev,
+        macvlanMode,
+        mtu,
+        mac,
+        addresses,
+        routes,
+        up
+    )
+};
+
 struct DeclareFileIn {
     std::string zone;
     int32_t type;
@@ -208,6 +313,45 @@ struct DeclareLinkIn {
     )
 };
 
+// Kinds of DeclarationIn
+const int32_t DECLARATION_FILE = 0;
+const int32_t DECLARATION_MOUNT = 1;
+const int32_t DECLARATION_LINK = 2;
+
+struct DeclarationIn {
+    int32_t kind;       // DECLARATION_*
+    int32_t fileType;   // VsmFileType, files only
+    std::string source; // mounts and links
+    std::string target; // path of a file, mount point or link name
+    std::string fsType; // mounts only
+    uint64_t flags;     // open flags of a file or mount flags
+    int32_t mode;       // files only
+    std::string data;   // mounts only
+
+    CARGO_REGISTER
+    (
+        kind,
+        fileType,
+        source,
+        target,
+        fsType,
+        flags,
+        mode,
+        data
+    )
+};
+
+struct DeclareBatchIn {
+    std::string zone;
+    std::vector<DeclarationIn> declarations;
+
+    CARGO_REGISTER
+    (
+        zone,
+        declarations
+    )
+};
+
 struct GrantDeviceIn {
     std::string id;
     std::string device;
@@ -107,6 +107,15 @@ std::string LxcZone::toString(State state) {
     throw LxcException("Invalid state");
 }
 
+LxcZone::State LxcZone::fromString(const std::string& str)
+{
+    const auto it = STATE_MAP.find(str);
+    if (it == STATE_MAP.end()) {
+        throw LxcException("Invalid state: " + str);
+    }
+    return it->second;
+}
+
 LxcZone::LxcZone(const std::string& lxcPath, const std::string& zoneName)
     : mLxcContainer(nullptr)
 {
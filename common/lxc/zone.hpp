@@ -87,6 +87,12 @@ public:
      */
     static std::string toString(State state);
 
+    /**
+     * Parse string representation of state
+     * @throw LxcException if the string is not a valid state
+     */
+    static State fromString(const std::string& str);
+
     /**
      * Get zone state
      */
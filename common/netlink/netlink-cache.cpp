@@ -0,0 +1,296 @@
+/*
+ *  Copyright (c) 2015 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *  Contact: agent <agent@local>
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License
+ */
+
+/**
+ * @file
+ * @author  agent (agent@local)
+ * @brief   Cache of network namespace links and addresses definition
+ */
+
+#include "config.hpp"
+
+#include "netlink/netlink-cache.hpp"
+#include "netlink/netlink-message.hpp"
+#include "utils/make-clean.hpp"
+#include "logger/logger.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <linux/rtnetlink.h>
+#include <sys/socket.h>
+
+namespace {
+
+const unsigned int NOTIFICATION_GROUPS = RTMGRP_LINK | RTMGRP_IPV4_IFADDR | RTMGRP_IPV6_IFADDR;
+
+inline const ifinfomsg* asInfo(const nlmsghdr& msg)
+{
+    return reinterpret_cast<const ifinfomsg*>(NLMSG_DATA(&msg));
+}
+
+inline const ifaddrmsg* asAddr(const nlmsghdr& msg)
+{
+    return reinterpret_cast<const ifaddrmsg*>(NLMSG_DATA(&msg));
+}
+
+std::string getLinkName(const nlmsghdr& msg)
+{
+    int len = IFLA_PAYLOAD(&msg);
+    for (const rtattr* rta = IFLA_RTA(asInfo(msg)); RTA_OK(rta, len); rta = RTA_NEXT(rta, len)) {
+        if (rta->rta_type == IFLA_IFNAME) {
+            const char* name = reinterpret_cast<const char*>(RTA_DATA(rta));
+            return std::string(name, ::strnlen(name, RTA_PAYLOAD(rta)));
+        }
+    }
+    return std::string();
+}
+
+void append(std::vector<char>& buf,
+            std::size_t& size,
+            const std::vector<char>& msg,
+            const nlmsghdr& request,
+            std::uint16_t flags)
+{
+    const std::size_t end = size + NLMSG_ALIGN(msg.size());
+    if (buf.size() < end) {
+        buf.resize(std::max(end, 2 * buf.size()));
+    }
+    std::copy(msg.begin(), msg.end(), buf.begin() + size);
+    nlmsghdr* hdr = reinterpret_cast<nlmsghdr*>(buf.data() + size);
+    hdr->nlmsg_flags = flags;
+    hdr->nlmsg_seq = request.nlmsg_seq;
+    hdr->nlmsg_pid = request.nlmsg_pid;
+    size = end;
+}
+
+} // namespace
+
+namespace vasum {
+namespace netlink {
+
+NetlinkCache::NetlinkCache(int pid)
+    : mSynced(false)
+{
+    mMonitor.open(pid, NOTIFICATION_GROUPS);
+}
+
+bool NetlinkCache::canAnswer(const nlmsghdr& request)
+{
+    if (!(request.nlmsg_flags & NLM_F_REQUEST)) {
+        return false;
+    }
+
+    const bool isDump = request.nlmsg_flags & NLM_F_DUMP;
+    if (request.nlmsg_type == RTM_GETLINK) {
+        if (request.nlmsg_len < NLMSG_LENGTH(sizeof(ifinfomsg))) {
+            return false;
+        }
+        const ifinfomsg* info = asInfo(request);
+        if (info->ifi_family != AF_UNSPEC && info->ifi_family != AF_PACKET) {
+            // e.g. AF_BRIDGE dumps describe bridge ports
+            return false;
+        }
+        int len = IFLA_PAYLOAD(&request);
+        if (isDump || info->ifi_index != 0) {
+            return len == 0 && (!isDump || info->ifi_index == 0);
+        }
+        const rtattr* rta = IFLA_RTA(info);
+        return RTA_OK(rta, len) && rta->rta_type == IFLA_IFNAME && len == static_cast<int>(RTA_ALIGN(rta->rta_len));
+    }
+    if (request.nlmsg_type == RTM_GETADDR) {
+        if (!isDump || request.nlmsg_len < NLMSG_LENGTH(sizeof(ifaddrmsg))) {
+            return false;
+        }
+        const ifaddrmsg* addr = asAddr(request);
+        return IFA_PAYLOAD(&request) == 0 &&
+               (addr->ifa_family == AF_UNSPEC || addr->ifa_family == AF_INET || addr->ifa_family == AF_INET6);
+    }
+    return false;
+}
+
+std::size_t NetlinkCache::answer(Netlink& nl, const nlmsghdr& request, std::vector<char>& buf)
+{
+    update(nl);
+
+    std::size_t size = 0;
+    const bool isDump = request.nlmsg_flags & NLM_F_DUMP;
+    if (request.nlmsg_type == RTM_GETLINK && !isDump) {
+        const Message* link = findLink(request);
+        if (link) {
+            append(buf, size, *link, request, 0);
+        }
+        return size;
+    }
+
+    if (request.nlmsg_type == RTM_GETLINK) {
+        for (const auto& link : mLinks) {
+            append(buf, size, link.second, request, NLM_F_MULTI);
+        }
+    } else {
+        const ifaddrmsg* filter = asAddr(request);
+        for (const auto& address : mAddresses) {
+            if ((filter->ifa_family == AF_UNSPEC || std::get<0>(address.first) == filter->ifa_family) &&
+                (filter->ifa_index == 0 || std::get<1>(address.first) == static_cast<int>(filter->ifa_index))) {
+                append(buf, size, address.second, request, NLM_F_MULTI);
+            }
+        }
+    }
+
+    Message done(NLMSG_LENGTH(sizeof(int)), 0);
+    nlmsghdr* hdr = reinterpret_cast<nlmsghdr*>(done.data());
+    hdr->nlmsg_len = done.size();
+    hdr->nlmsg_type = NLMSG_DONE;
+    append(buf, size, done, request, NLM_F_MULTI);
+    return size;
+}
+
+void NetlinkCache::update(Netlink& nl)
+{
+    if (!mSynced) {
+        sync(nl);
+    }
+    for (;;) {
+        int size = mMonitor.rcvNotification(mBuf);
+        if (size == 0) {
+            return;
+        }
+        if (size < 0) {
+            // some changes are unknown, read everything again
+            sync(nl);
+            continue;
+        }
+        unsigned int len = size;
+        for (const nlmsghdr* msg = reinterpret_cast<const nlmsghdr*>(mBuf.data());
+             NLMSG_OK(msg, len);
+             msg = NLMSG_NEXT(msg, len)) {
+            apply(*msg);
+        }
+    }
+}
+
+void NetlinkCache::sync(Netlink& nl)
+{
+    LOGD("Reading network namespace links and addresses");
+    mSynced = false;
+    mLinks.clear();
+    mAddresses.clear();
+    // state received by dumps includes everything notified so far,
+    // only notifications sent after that are still needed
+    mMonitor.discardPending();
+    dump(nl, RTM_GETLINK);
+    dump(nl, RTM_GETADDR);
+    mSynced = true;
+}
+
+void NetlinkCache::dump(Netlink& nl, std::uint16_t type)
+{
+    NetlinkMessage nlm(type, NLM_F_REQUEST | NLM_F_DUMP);
+    if (type == RTM_GETLINK) {
+        ifinfomsg info = utils::make_clean<ifinfomsg>();
+        info.ifi_family = AF_UNSPEC;
+        nlm.put(info);
+    } else {
+        ifaddrmsg addr = utils::make_clean<ifaddrmsg>();
+        addr.ifa_family = AF_UNSPEC;
+        nlm.put(addr);
+    }
+
+    nl.discardPending();
+    nl.send(&nlm.hdr());
+    unsigned int len = nl.rcv(nlm.hdr().nlmsg_seq, mBuf);
+    for (const nlmsghdr* msg = reinterpret_cast<const nlmsghdr*>(mBuf.data());
+         NLMSG_OK(msg, len);
+         msg = NLMSG_NEXT(msg, len)) {
+        apply(*msg);
+    }
+}
+
+void NetlinkCache::apply(const nlmsghdr& msg)
+{
+    const char* begin = reinterpret_cast<const char*>(&msg);
+    switch (msg.nlmsg_type) {
+    case RTM_NEWLINK:
+    case RTM_DELLINK: {
+        if (msg.nlmsg_len < NLMSG_LENGTH(sizeof(ifinfomsg))) {
+            return;
+        }
+        const ifinfomsg* info = asInfo(msg);
+        if (info->ifi_family != AF_UNSPEC) {
+            // bridge port notifications don't describe the link itself
+            return;
+        }
+        if (msg.nlmsg_type == RTM_NEWLINK) {
+            mLinks[info->ifi_index].assign(begin, begin + msg.nlmsg_len);
+            return;
+        }
+        mLinks.erase(info->ifi_index);
+        for (auto it = mAddresses.begin(); it != mAddresses.end();) {
+            if (std::get<1>(it->first) == info->ifi_index) {
+                it = mAddresses.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        return;
+    }
+    case RTM_NEWADDR:
+    case RTM_DELADDR: {
+        if (msg.nlmsg_len < NLMSG_LENGTH(sizeof(ifaddrmsg))) {
+            return;
+        }
+        const ifaddrmsg* addr = asAddr(msg);
+        std::string id(1, static_cast<char>(addr->ifa_prefixlen));
+        int len = IFA_PAYLOAD(&msg);
+        for (const rtattr* rta = IFA_RTA(addr); RTA_OK(rta, len); rta = RTA_NEXT(rta, len)) {
+            if (rta->rta_type == IFA_ADDRESS || rta->rta_type == IFA_LOCAL) {
+                id.push_back(static_cast<char>(rta->rta_type));
+                id.append(reinterpret_cast<const char*>(RTA_DATA(rta)), RTA_PAYLOAD(rta));
+            }
+        }
+        const AddressKey key(addr->ifa_family, addr->ifa_index, id);
+        if (msg.nlmsg_type == RTM_NEWADDR) {
+            mAddresses[key].assign(begin, begin + msg.nlmsg_len);
+        } else {
+            mAddresses.erase(key);
+        }
+        return;
+    }
+    default:
+        return;
+    }
+}
+
+const NetlinkCache::Message* NetlinkCache::findLink(const nlmsghdr& request) const
+{
+    const ifinfomsg* info = asInfo(request);
+    if (info->ifi_index != 0) {
+        const auto it = mLinks.find(info->ifi_index);
+        return it == mLinks.end() ? nullptr : &it->second;
+    }
+
+    const std::string name = getLinkName(request);
+    for (const auto& link : mLinks) {
+        if (getLinkName(*reinterpret_cast<const nlmsghdr*>(link.second.data())) == name) {
+            return &link.second;
+        }
+    }
+    return nullptr;
+}
+
+} // namespace netlink
+} // namespace vasum
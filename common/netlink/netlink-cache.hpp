@@ -0,0 +1,104 @@
+/*
+ *  Copyright (c) 2015 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *  Contact: agent <agent@local>
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License
+ */
+
+/**
+ * @file
+ * @author  agent (agent@local)
+ * @brief   Cache of network namespace links and addresses declaration
+ */
+
+#ifndef COMMON_NETLINK_NETLINK_CACHE_HPP
+#define COMMON_NETLINK_NETLINK_CACHE_HPP
+
+#include "netlink/netlink.hpp"
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <tuple>
+#include <vector>
+#include <linux/netlink.h>
+
+//FIXME remove from namespace vasum
+namespace vasum {
+namespace netlink {
+
+/**
+ * NetlinkCache keeps links and addresses of one network namespace
+ *
+ * The state is read by dumps on first use and then updated by rtnetlink
+ * notifications (RTNLGRP_LINK, RTNLGRP_IPV4_IFADDR, RTNLGRP_IPV6_IFADDR).
+ * Requests are answered from memory with the messages the kernel has sent,
+ * so the answers can be parsed like the kernel ones. Link statistics in them
+ * are as old as the last change of the link.
+ *
+ * It is not thread safe
+ */
+class NetlinkCache {
+public:
+    /**
+     * @param pid Process id which describes network namespace
+     */
+    explicit NetlinkCache(int pid);
+
+    NetlinkCache(const NetlinkCache& other) = delete;
+    NetlinkCache& operator=(const NetlinkCache& other) = delete;
+
+    /**
+     * Check if the request can be answered from cache
+     *
+     * Link requests (dump or single link by index or name) and address
+     * dumps without additional attributes are supported.
+     */
+    static bool canAnswer(const nlmsghdr& request);
+
+    /**
+     * Answer the request
+     *
+     * Pending notifications are applied first, so changes made before
+     * (by any process) are visible in the answer.
+     *
+     * @param nl connection to the namespace, used to dump the state
+     * @param request request accepted by canAnswer
+     * @param buf buffer for the answer, data is placed at its beginning
+     * @return length of the answer, 0 if the requested link doesn't exist
+     */
+    std::size_t answer(Netlink& nl, const nlmsghdr& request, std::vector<char>& buf);
+
+private:
+    typedef std::vector<char> Message;
+    // family, interface index, prefix length and addresses
+    typedef std::tuple<int, int, std::string> AddressKey;
+
+    Netlink mMonitor;
+    bool mSynced;
+    std::map<int, Message> mLinks;
+    std::map<AddressKey, Message> mAddresses;
+    std::vector<char> mBuf;
+
+    void update(Netlink& nl);
+    void sync(Netlink& nl);
+    void dump(Netlink& nl, std::uint16_t type);
+    void apply(const nlmsghdr& msg);
+    const Message* findLink(const nlmsghdr& request) const;
+};
+
+} // namespace netlink
+} // namespace vasum
+
+#endif // COMMON_NETLINK_NETLINK_CACHE_HPP
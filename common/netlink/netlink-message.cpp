@@ -26,18 +26,24 @@
 
 #include "netlink-message.hpp"
 #include "netlink.hpp"
+#include "netlink-cache.hpp"
 #include "base-exception.hpp"
 #include "logger/logger.hpp"
+#include "utils/exception.hpp"
 
 #include <algorithm>
 #include <memory>
 #include <cstring>
 #include <atomic>
 #include <cassert>
+#include <cerrno>
+#include <mutex>
+#include <unordered_map>
 
 #include <linux/netlink.h>
 #include <linux/rtnetlink.h>
 #include <sys/socket.h>
+#include <sys/stat.h>
 #include <unistd.h>
 
 namespace {
@@ -51,6 +57,140 @@ inline char* NLMSG_TAIL(nlmsghdr* nmsg)
     return reinterpret_cast<char*>(nmsg) + NLMSG_ALIGN(nmsg->nlmsg_len);
 }
 
+// Max number of messages sent in one datagram by NetlinkTransaction,
+// it keeps the acknowledgements within the default socket receive buffer
+const std::size_t MAX_TRANSACTION_BATCH = 64;
+
+// Receive buffers are reused by later responses, up to the given number and size
+const std::size_t MAX_POOLED_BUFFERS = 8;
+const std::size_t MAX_POOLED_BUFFER_SIZE = 4 * 1024 * 1024;
+
+std::vector<std::unique_ptr<std::vector<char>>> gBufferPool;
+std::mutex gBufferPoolMutex;
+
+std::unique_ptr<std::vector<char>> acquireBuffer()
+{
+    std::lock_guard<std::mutex> lock(gBufferPoolMutex);
+    if (gBufferPool.empty()) {
+        return std::unique_ptr<std::vector<char>>(new std::vector<char>());
+    }
+    std::unique_ptr<std::vector<char>> buffer = std::move(gBufferPool.back());
+    gBufferPool.pop_back();
+    return buffer;
+}
+
+void releaseBuffer(std::unique_ptr<std::vector<char>>&& buffer)
+{
+    if (buffer->size() > MAX_POOLED_BUFFER_SIZE) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(gBufferPoolMutex);
+    if (gBufferPool.size() < MAX_POOLED_BUFFERS) {
+        gBufferPool.push_back(std::move(buffer));
+    }
+}
+
+// Upper limit of cached connections, the least recently used one is closed above it
+const std::size_t MAX_CACHED_CONNECTIONS = 32;
+
+/**
+ * Netlink connection opened in a network namespace
+ *
+ * pid is the process used to enter the namespace (0 for own namespace).
+ * The connection is valid as long as that process stays in the namespace.
+ */
+struct Connection {
+    vasum::netlink::Netlink nl;
+    std::unique_ptr<vasum::netlink::NetlinkCache> cache;
+    std::mutex mutex;
+    int pid;
+    ino_t inode;
+    unsigned long long lastUse;
+};
+
+// network namespace inode -> connection
+std::unordered_map<ino_t, std::shared_ptr<Connection>> gConnections;
+std::mutex gConnectionsMutex;
+unsigned long long gUseCounter = 0;
+std::atomic<bool> gCacheEnabled(false);
+
+bool isOwnNamespace(int pid)
+{
+    return pid == 0 || pid == 1 || pid == ::getpid();
+}
+
+bool getNetNsInode(int pid, ino_t& inode)
+{
+    const std::string path = isOwnNamespace(pid) ? "/proc/self/ns/net"
+                                                 : "/proc/" + std::to_string(pid) + "/ns/net";
+    struct stat st;
+    if (::stat(path.c_str(), &st) != 0) {
+        return false;
+    }
+    inode = st.st_ino;
+    return true;
+}
+
+void pruneStaleConnections()
+{
+    // assume gConnectionsMutex is locked
+    for (auto it = gConnections.begin(); it != gConnections.end();) {
+        const Connection& connection = *it->second;
+        ino_t inode;
+        if (connection.pid != 0 && (!getNetNsInode(connection.pid, inode) || inode != connection.inode)) {
+            it = gConnections.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void pruneConnections()
+{
+    // assume gConnectionsMutex is locked
+    pruneStaleConnections();
+
+    if (gConnections.size() >= MAX_CACHED_CONNECTIONS) {
+        auto lru = std::min_element(gConnections.begin(), gConnections.end(),
+            [](const decltype(gConnections)::value_type& a, const decltype(gConnections)::value_type& b) {
+                return a.second->lastUse < b.second->lastUse;
+            });
+        gConnections.erase(lru);
+    }
+}
+
+std::shared_ptr<Connection> getConnection(int pid)
+{
+    ino_t inode;
+    if (!getNetNsInode(pid, inode)) {
+        throw vasum::VasumException("Can't open netlink connection (zone not running)");
+    }
+
+    std::lock_guard<std::mutex> lock(gConnectionsMutex);
+    auto it = gConnections.find(inode);
+    if (it == gConnections.end()) {
+        pruneConnections();
+
+        std::shared_ptr<Connection> connection = std::make_shared<Connection>();
+        connection->nl.open(pid);
+        connection->inode = inode;
+        it = gConnections.emplace(inode, std::move(connection)).first;
+    }
+    // the process which has entered the namespace most recently is used for validation
+    it->second->pid = isOwnNamespace(pid) ? 0 : pid;
+    it->second->lastUse = ++gUseCounter;
+    return it->second;
+}
+
+void dropConnection(const std::shared_ptr<Connection>& connection)
+{
+    std::lock_guard<std::mutex> lock(gConnectionsMutex);
+    auto it = gConnections.find(connection->inode);
+    if (it != gConnections.end() && it->second == connection) {
+        gConnections.erase(it);
+    }
+}
+
 } // namespace
 
 namespace vasum {
@@ -62,6 +202,8 @@ NetlinkResponse send(const NetlinkMessage& msg)
 }
 
 NetlinkMessage::NetlinkMessage(uint16_t type, uint16_t flags)
+    : mStrictCheck(false)
+    , mUncached(false)
 {
     static std::atomic<uint32_t> seq(0);
     mNlmsg.resize(NLMSG_HDRLEN, 0);
@@ -89,6 +231,18 @@ NetlinkMessage& NetlinkMessage::endNested()
     return *this;
 }
 
+NetlinkMessage& NetlinkMessage::setStrictCheck()
+{
+    mStrictCheck = true;
+    return *this;
+}
+
+NetlinkMessage& NetlinkMessage::setUncached()
+{
+    mUncached = true;
+    return *this;
+}
+
 NetlinkMessage& NetlinkMessage::put(int ifla, const std::string& value)
 {
     return put(ifla, value.c_str(), value.size() + 1);
@@ -132,13 +286,21 @@ void NetlinkMessage::setMinCapacity(unsigned int size)
     }
 }
 
-NetlinkResponse::NetlinkResponse(std::unique_ptr<std::vector<char>>&& message)
+NetlinkResponse::NetlinkResponse(std::unique_ptr<std::vector<char>>&& message, int size)
     : mNlmsg(std::move(message))
+    , mSize(size)
     , mNlmsgHdr(asHdr(mNlmsg.get()->data()))
     , mPosition(NLMSG_HDRLEN)
 {
 }
 
+NetlinkResponse::~NetlinkResponse()
+{
+    if (mNlmsg) {
+        releaseBuffer(std::move(mNlmsg));
+    }
+}
+
 bool NetlinkResponse::hasMessage() const
 {
     unsigned int tail = size() - getHdrPosition();
@@ -169,6 +331,11 @@ bool NetlinkResponse::hasAttribute() const
 {
     assert(mPosition >= getHdrPosition());
     int tail = mNlmsgHdr->nlmsg_len - (mPosition - getHdrPosition());
+    if (!mNested.empty()) {
+        // attributes of the opened nested attribute only
+        const rtattr *nest = asAttr(mNlmsg->data() + mNested.top());
+        tail = mNested.top() + nest->rta_len - mPosition;
+    }
     return RTA_OK(asAttr(get(0)), tail);
 }
 
@@ -215,6 +382,7 @@ NetlinkResponse& NetlinkResponse::closeNested()
     }
     mNested.pop();
     mPosition = pos;
+    skipAttribute();
     return *this;
 }
 
@@ -294,7 +462,7 @@ NetlinkResponse& NetlinkResponse::seek(int len)
 
 int NetlinkResponse::size() const
 {
-    return mNlmsg->size();
+    return mSize;
 }
 
 inline int NetlinkResponse::getHdrPosition() const
@@ -308,19 +476,146 @@ NetlinkResponse send(const NetlinkMessage& msg, int pid)
     const auto &hdr = msg.hdr();
     assert(hdr.nlmsg_flags & NLM_F_ACK);
 
-    std::unique_ptr<std::vector<char>> data;
-    Netlink nl;
-    nl.open(pid);
+    std::unique_ptr<std::vector<char>> data = acquireBuffer();
+    std::size_t size;
+    bool cached = false;
+    std::shared_ptr<Connection> connection = getConnection(pid);
+    std::lock_guard<std::mutex> lock(connection->mutex);
     try {
-        nl.send(&hdr);
-        data = nl.rcv(hdr.nlmsg_seq);
+        if (!gCacheEnabled) {
+            connection->cache.reset();
+        } else if (!msg.mUncached && NetlinkCache::canAnswer(hdr)) {
+            if (!connection->cache) {
+                connection->cache.reset(new NetlinkCache(pid));
+            }
+            size = connection->cache->answer(connection->nl, hdr, *data);
+            cached = true;
+        }
+        if (!cached) {
+            connection->nl.discardPending();
+            connection->nl.setStrictCheck(msg.mStrictCheck);
+            connection->nl.send(&hdr);
+            size = connection->nl.rcv(hdr.nlmsg_seq, *data);
+        }
     } catch (const std::exception& ex) {
         LOGE("Sending failed (" << ex.what() << "), pid=" + std::to_string(pid));
-        nl.close();
+        // don't reuse a connection which may be left in an unknown state
+        dropConnection(connection);
+        releaseBuffer(std::move(data));
         throw;
     }
-    nl.close();
-    return NetlinkResponse(std::move(data));
+    if (cached && size == 0) {
+        // the same error as the kernel reports
+        releaseBuffer(std::move(data));
+        throw VasumException("Receive failed: " + utils::getSystemErrorMessage(ENODEV));
+    }
+    return NetlinkResponse(std::move(data), size);
+}
+
+NetlinkTransaction::NetlinkTransaction(int pid)
+    : mPid(pid)
+    , mStopOnError(false)
+{
+}
+
+NetlinkTransaction& NetlinkTransaction::setStopOnError()
+{
+    mStopOnError = true;
+    return *this;
+}
+
+const std::vector<int>& NetlinkTransaction::getErrors() const
+{
+    return mErrors;
+}
+
+NetlinkTransaction& NetlinkTransaction::add(NetlinkMessage msg)
+{
+    assert(msg.hdr().nlmsg_flags & NLM_F_ACK);
+    // NLM_F_EXCL of new requests has the same value as NLM_F_MATCH
+    assert((msg.hdr().nlmsg_flags & NLM_F_DUMP) != NLM_F_DUMP);
+    mMessages.push_back(std::move(msg));
+    return *this;
+}
+
+std::size_t NetlinkTransaction::size() const
+{
+    return mMessages.size();
+}
+
+void NetlinkTransaction::commit()
+{
+    std::vector<NetlinkMessage> messages;
+    messages.swap(mMessages);
+    mErrors.clear();
+    if (messages.empty()) {
+        return;
+    }
+
+    // the kernel processes a whole datagram even if a message fails, so stopping
+    // requires one message per datagram, its ACK is ready when send() returns
+    const std::size_t batchSize = mStopOnError ? 1 : MAX_TRANSACTION_BATCH;
+    mErrors.reserve(messages.size());
+    std::shared_ptr<Connection> connection = getConnection(mPid);
+    {
+        std::lock_guard<std::mutex> lock(connection->mutex);
+        try {
+            connection->nl.discardPending();
+            connection->nl.setStrictCheck(false);
+            for (std::size_t begin = 0; begin < messages.size(); begin += batchSize) {
+                const std::size_t end = std::min(messages.size(), begin + batchSize);
+                std::vector<const void*> hdrs;
+                std::vector<unsigned int> seqs;
+                for (std::size_t i = begin; i < end; ++i) {
+                    hdrs.push_back(&messages[i].hdr());
+                    seqs.push_back(messages[i].hdr().nlmsg_seq);
+                }
+                connection->nl.send(hdrs);
+                const std::vector<int> batchErrors = connection->nl.rcvAcks(seqs);
+                mErrors.insert(mErrors.end(), batchErrors.begin(), batchErrors.end());
+                if (mStopOnError && batchErrors.front() != 0) {
+                    break;
+                }
+            }
+        } catch (const std::exception& ex) {
+            LOGE("Sending failed (" << ex.what() << "), pid=" + std::to_string(mPid));
+            dropConnection(connection);
+            throw;
+        }
+    }
+
+    for (std::size_t i = 0; i < mErrors.size(); ++i) {
+        if (mErrors[i] != 0) {
+            const std::string msg = "Netlink request " + std::to_string(i + 1) + "/" +
+                                    std::to_string(messages.size()) + " (type " +
+                                    std::to_string(messages[i].hdr().nlmsg_type) + ") failed: " +
+                                    utils::getSystemErrorMessage(mErrors[i]);
+            LOGE(msg);
+            throw VasumException(msg);
+        }
+    }
+}
+
+void closeConnection(int pid)
+{
+    if (isOwnNamespace(pid)) {
+        return;
+    }
+    ino_t inode;
+    const bool found = getNetNsInode(pid, inode);
+
+    std::lock_guard<std::mutex> lock(gConnectionsMutex);
+    if (found) {
+        // the connection might have been validated with another process of the namespace
+        gConnections.erase(inode);
+    }
+    // connections of namespaces left by their processes, including this one if it's gone
+    pruneStaleConnections();
+}
+
+void setCacheEnabled(bool enabled)
+{
+    gCacheEnabled = enabled;
 }
 
 } // namespace netlink
@@ -41,6 +41,8 @@ namespace netlink {
 
 class NetlinkResponse;
 class NetlinkMessage;
+class NetlinkTransaction;
+class NetlinkCache;
 
 /**
  *  NetlinkMessage is used to creatie a netlink messages
@@ -84,6 +86,24 @@ public:
     template<class T>
     NetlinkMessage& put(const T& value);
 
+    /**
+     * Request kernel side filtering of dump
+     *
+     * The kernel checks the request strictly and returns only entries
+     * matching its header and attributes (e.g. ifa_index, RTA_OIF, RTA_TABLE).
+     * Kernels without NETLINK_GET_STRICT_CHK ignore the filters, so the answer
+     * has to be filtered anyway.
+     */
+    NetlinkMessage& setStrictCheck();
+
+    /**
+     * Always send the request to the kernel, even if it can be answered from cache
+     *
+     * Changes of link statistics are not notified, so cached links carry
+     * counters from the time of their last change.
+     */
+    NetlinkMessage& setUncached();
+
     /**
      * Send netlink message
      *
@@ -92,9 +112,13 @@ public:
      * @param pid Process id which describes network namespace
      */
     friend NetlinkResponse send(const NetlinkMessage& msg, int pid);
+    friend class NetlinkTransaction;
+    friend class NetlinkCache;
 private:
     std::vector<char> mNlmsg;
     std::stack<int> mNested;
+    bool mStrictCheck;
+    bool mUncached;
 
     NetlinkMessage& put(int ifla, const void* data, int len);
     NetlinkMessage& put(const void* data, int len);
@@ -108,6 +132,10 @@ private:
  */
 class NetlinkResponse {
 public:
+    NetlinkResponse(NetlinkResponse&&) = default;
+    NetlinkResponse& operator=(NetlinkResponse&&) = default;
+    ~NetlinkResponse();
+
     /**
      * Check if theres is next message in netlink response
      */
@@ -140,11 +168,15 @@ public:
 
     /**
      * Start reading nested attribute
+     *
+     * Until closeNested(), hasAttribute() checks attributes of the nested one only
      */
     NetlinkResponse& openNested(int ifla);
 
     /**
      * End reading nested attribute
+     *
+     * All its attributes have to be fetched or skipped before
      */
     NetlinkResponse& closeNested();
 
@@ -188,9 +220,11 @@ public:
      */
     friend NetlinkResponse send(const NetlinkMessage& msg, int pid);
 private:
-    NetlinkResponse(std::unique_ptr<std::vector<char>>&& message);
+    NetlinkResponse(std::unique_ptr<std::vector<char>>&& message, int size);
 
+    // received messages are at the beginning of the buffer, it may be larger than mSize
     std::unique_ptr<std::vector<char>> mNlmsg;
+    int mSize;
     std::stack<int> mNested;
     nlmsghdr* mNlmsgHdr;
     int mPosition;
@@ -211,6 +245,86 @@ private:
  */
 NetlinkResponse send(const NetlinkMessage& msg);
 
+/**
+ *  NetlinkTransaction sends many requests at once
+ *
+ *  Messages are sent in one datagram and their acknowledgements are
+ *  collected in one receive loop. The kernel processes all messages in
+ *  the order they were added, also those following a failed one
+ *  unless setStopOnError() is used.
+ *  Only requests answered with an ACK can be added (no dumps).
+ */
+class NetlinkTransaction {
+public:
+    /**
+     * @param pid Process id which describes network namespace
+     */
+    explicit NetlinkTransaction(int pid = 0);
+
+    /**
+     * Add message to the transaction
+     */
+    NetlinkTransaction& add(NetlinkMessage msg);
+
+    /**
+     * Number of messages waiting to be sent
+     */
+    std::size_t size() const;
+
+    /**
+     * Don't send messages following a failed one
+     *
+     * Messages are sent one by one then, which costs a system call each.
+     */
+    NetlinkTransaction& setStopOnError();
+
+    /**
+     * Results of the messages acknowledged in the last commit, 0 or an errno each
+     *
+     * Messages following a failed one have no result when setStopOnError() is used.
+     */
+    const std::vector<int>& getErrors() const;
+
+    /**
+     * Send all added messages and wait for their acknowledgements
+     *
+     * The transaction is empty afterwards. If any message fails,
+     * an exception describing the first failed one is thrown.
+     */
+    void commit();
+
+private:
+    int mPid;
+    bool mStopOnError;
+    std::vector<int> mErrors;
+    std::vector<NetlinkMessage> mMessages;
+};
+
+/**
+ * Close cached connection to network namespace of the process
+ *
+ * Connections opened by send() are kept open and reused as long as the
+ * process, which was used to enter the namespace, lives in it. Call this
+ * when the process is about to go away (e.g. zone is being stopped), so
+ * the connection doesn't hold the namespace any longer. The connection is
+ * found by the namespace, whichever of its processes was used to enter it.
+ *
+ * @param pid Process id which describes network namespace
+ */
+void closeConnection(int pid);
+
+/**
+ * Enable or disable answering link and address requests from memory
+ *
+ * When enabled, requests for links (RTM_GETLINK) and address dumps
+ * (RTM_GETADDR) are answered by a cache of the network namespace state.
+ * The cache is filled on the first request and then kept up to date by
+ * rtnetlink notifications, instead of dumping kernel tables every time.
+ * It lives as long as the cached connection to the namespace.
+ * Disabled by default.
+ */
+void setCacheEnabled(bool enabled);
+
 template<class T>
 NetlinkMessage& NetlinkMessage::put(int ifla, const T& value)
 {
@@ -33,7 +33,9 @@
 #include "logger/logger.hpp"
 
 #include <cassert>
+#include <cerrno>
 #include <algorithm>
+#include <unordered_map>
 #include <sys/socket.h>
 #include <unistd.h>
 #include <linux/netlink.h>
@@ -42,12 +44,26 @@
 #define PAGE_SIZE 4096
 #endif
 
+#ifndef SOL_NETLINK
+#define SOL_NETLINK 270
+#endif
+
+#ifndef NETLINK_GET_STRICT_CHK
+#define NETLINK_GET_STRICT_CHK 12
+#endif
+
+#ifndef NETLINK_CAP_ACK
+#define NETLINK_CAP_ACK 10
+#endif
+
 using namespace utils;
 using namespace vasum;
 
 namespace {
 
 const int NLMSG_RCV_GOOD_SIZE = 2*PAGE_SIZE;
+// Max number of datagrams fetched by a single recvmmsg call
+const unsigned int NLMSG_RCV_BATCH = 16;
 
 int vsm_recvmsg(int fd, struct msghdr *msg, int flags)
 {
@@ -73,6 +89,22 @@ int vsm_recvmsg(int fd, struct msghdr *msg, int flags)
     throw VasumException("Can't receive netlink message");
 }
 
+size_t vsm_peeksize(int fd)
+{
+    // with MSG_TRUNC netlink reports the real length of the next datagram
+    for (;;) {
+        ssize_t ret = ::recv(fd, NULL, 0, MSG_PEEK | MSG_TRUNC);
+        if (ret >= 0) {
+            return ret;
+        }
+        if (errno != EINTR) {
+            const std::string msg = "Can't receive message: " + getSystemErrorMessage();
+            LOGE(msg);
+            throw VasumException(msg);
+        }
+    }
+}
+
 void vsm_sendmsg(int fd, const struct msghdr *msg, int flags)
 {
     int ret = sendmsg(fd, msg, flags);
@@ -88,7 +120,10 @@ void vsm_sendmsg(int fd, const struct msghdr *msg, int flags)
 namespace vasum {
 namespace netlink {
 
-Netlink::Netlink() : mFd(-1)
+Netlink::Netlink()
+    : mFd(-1)
+    , mStrictCheck(false)
+    , mStrictCheckSupported(true)
 {
 }
 
@@ -97,7 +132,7 @@ Netlink::~Netlink()
     close();
 }
 
-void Netlink::open(int netNsPid)
+void Netlink::open(int netNsPid, unsigned int groups)
 {
     auto fdFactory = []{ return socket(AF_NETLINK, SOCK_RAW, NETLINK_ROUTE); };
 
@@ -116,6 +151,7 @@ void Netlink::open(int netNsPid)
 
     sockaddr_nl local = utils::make_clean<sockaddr_nl>();
     local.nl_family = AF_NETLINK;
+    local.nl_groups = groups;
 
     if (bind(mFd, (struct sockaddr *)&local, sizeof(local)) < 0) {
         int err = errno;
@@ -124,6 +160,13 @@ void Netlink::open(int netNsPid)
         LOGE(msg);
         throw VasumException(msg);
     }
+
+    // Error acknowledgements don't echo the whole request then, so they fit
+    // the receive buffers. Older kernels echo it, truncation is detected.
+    int capAck = 1;
+    if (::setsockopt(mFd, SOL_NETLINK, NETLINK_CAP_ACK, &capAck, sizeof(capAck)) < 0) {
+        LOGD("Netlink capped acknowledgements are not supported: " << getSystemErrorMessage());
+    }
 }
 
 void Netlink::close()
@@ -132,6 +175,7 @@ void Netlink::close()
         utils::close(mFd);
         mFd = -1;
     }
+    mStrictCheck = false;
 }
 
 unsigned int Netlink::send(const void *nlmsg)
@@ -152,10 +196,103 @@ unsigned int Netlink::send(const void *nlmsg)
     return reinterpret_cast<const nlmsghdr*>(nlmsg)->nlmsg_seq;
 }
 
-std::unique_ptr<std::vector<char>> Netlink::rcv(unsigned int nlmsgSeq)
+void Netlink::send(const std::vector<const void*>& nlmsgs)
 {
-    std::unique_ptr<std::vector<char>> buf(new std::vector<char>());
+    // messages in one datagram have to start at aligned offsets
+    static const char padding[NLMSG_ALIGNTO] = {0};
+
+    std::vector<iovec> iovs;
+    iovs.reserve(nlmsgs.size() * 2);
+    for (const void* nlmsg : nlmsgs) {
+        const unsigned int len = reinterpret_cast<const nlmsghdr*>(nlmsg)->nlmsg_len;
+        iovec iov = utils::make_clean<iovec>();
+        iov.iov_base = const_cast<void*>(nlmsg);
+        iov.iov_len = len;
+        iovs.push_back(iov);
+        if (NLMSG_ALIGN(len) != len) {
+            iov.iov_base = const_cast<char*>(padding);
+            iov.iov_len = NLMSG_ALIGN(len) - len;
+            iovs.push_back(iov);
+        }
+    }
 
+    msghdr msg = utils::make_clean<msghdr>();
+    sockaddr_nl nladdr = utils::make_clean<sockaddr_nl>();
+    msg.msg_name = &nladdr;
+    msg.msg_namelen = sizeof(nladdr);
+    msg.msg_iov = iovs.data();
+    msg.msg_iovlen = iovs.size();
+    nladdr.nl_family = AF_NETLINK;
+
+    vsm_sendmsg(mFd, &msg, 0);
+}
+
+std::vector<int> Netlink::rcvAcks(const std::vector<unsigned int>& nlmsgSeqs)
+{
+    std::vector<int> errors(nlmsgSeqs.size(), 0);
+    // sequence number -> position in nlmsgSeqs
+    std::unordered_map<unsigned int, std::size_t> pending;
+    for (std::size_t i = 0; i < nlmsgSeqs.size(); ++i) {
+        pending.emplace(nlmsgSeqs[i], i);
+    }
+
+    const unsigned int batch = std::min<std::size_t>(pending.size(), NLMSG_RCV_BATCH);
+    std::vector<char> buf(batch * NLMSG_RCV_GOOD_SIZE);
+    std::vector<iovec> iovs(batch);
+    std::vector<mmsghdr> msgs(batch);
+
+    while (!pending.empty()) {
+        const unsigned int count = std::min<std::size_t>(pending.size(), batch);
+        for (unsigned int i = 0; i < count; ++i) {
+            iovs[i].iov_base = buf.data() + i * NLMSG_RCV_GOOD_SIZE;
+            iovs[i].iov_len = NLMSG_RCV_GOOD_SIZE;
+            msgs[i] = utils::make_clean<mmsghdr>();
+            msgs[i].msg_hdr.msg_iov = &iovs[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+        }
+
+        int ret = ::recvmmsg(mFd, msgs.data(), count, MSG_WAITFORONE, NULL);
+        if (ret < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            const std::string msg = "Can't receive netlink acknowledgements: " + getSystemErrorMessage();
+            LOGE(msg);
+            throw VasumException(msg);
+        }
+
+        for (int i = 0; i < ret; ++i) {
+            if (msgs[i].msg_hdr.msg_flags & MSG_TRUNC) {
+                // the cut message can't be matched, waiting for it would never end
+                const std::string msg = "Receive failed: acknowledgement truncated";
+                LOGE(msg);
+                throw VasumException(msg);
+            }
+            unsigned int len = msgs[i].msg_len;
+            nlmsghdr* answer = reinterpret_cast<nlmsghdr*>(iovs[i].iov_base);
+            for (; NLMSG_OK(answer, len); answer = NLMSG_NEXT(answer, len)) {
+                if (answer->nlmsg_type == NLMSG_OVERRUN) {
+                    throw VasumException("Receive failed: data lost");
+                }
+                if (answer->nlmsg_type != NLMSG_ERROR) {
+                    continue;
+                }
+                const auto it = pending.find(answer->nlmsg_seq);
+                if (it == pending.end()) {
+                    LOGW("Unexpected netlink acknowledgement, seq: " << answer->nlmsg_seq);
+                    continue;
+                }
+                const nlmsgerr* err = reinterpret_cast<const nlmsgerr*>(NLMSG_DATA(answer));
+                errors[it->second] = -err->error;
+                pending.erase(it);
+            }
+        }
+    }
+    return errors;
+}
+
+std::size_t Netlink::rcv(unsigned int nlmsgSeq, std::vector<char>& buf)
+{
     msghdr msg = utils::make_clean<msghdr>();
     sockaddr_nl nladdr = utils::make_clean<sockaddr_nl>();
     iovec iov = utils::make_clean<iovec>();
@@ -170,10 +307,13 @@ std::unique_ptr<std::vector<char>> Netlink::rcv(unsigned int nlmsgSeq)
     nlmsghdr* lastOk = NULL;
     size_t offset = 0;
     do {
-        buf->resize(offset + NLMSG_RCV_GOOD_SIZE);
-        answer = reinterpret_cast<nlmsghdr*>(buf->data() + offset);
+        const size_t size = vsm_peeksize(mFd);
+        if (buf.size() < offset + size) {
+            buf.resize(std::max<size_t>(offset + size, std::max<size_t>(NLMSG_RCV_GOOD_SIZE, 2 * buf.size())));
+        }
+        answer = reinterpret_cast<nlmsghdr*>(buf.data() + offset);
         iov.iov_base = answer;
-        iov.iov_len = buf->size() - offset;
+        iov.iov_len = size;
         unsigned int ret = vsm_recvmsg(mFd, &msg, 0);
         for (unsigned int len = ret; NLMSG_OK(answer, len); answer = NLMSG_NEXT(answer, len)) {
             lastOk = answer;
@@ -198,8 +338,81 @@ std::unique_ptr<std::vector<char>> Netlink::rcv(unsigned int nlmsgSeq)
         offset +=  NLMSG_ALIGN(ret);
     } while (lastOk->nlmsg_type != NLMSG_DONE && lastOk->nlmsg_flags & NLM_F_MULTI);
 
-    buf->resize(offset);
-    return buf;
+    return std::min(offset, buf.size());
+}
+
+void Netlink::discardPending()
+{
+    char buf[NLMSG_HDRLEN];
+    for (;;) {
+        ssize_t ret = ::recv(mFd, buf, sizeof(buf), MSG_DONTWAIT | MSG_TRUNC);
+        if (ret < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                const std::string msg = "Can't discard pending messages: " + getSystemErrorMessage();
+                LOGE(msg);
+                throw VasumException(msg);
+            }
+            return;
+        }
+        if (ret == 0) {
+            return;
+        }
+    }
+}
+
+int Netlink::rcvNotification(std::vector<char>& buf)
+{
+    for (;;) {
+        ssize_t size = ::recv(mFd, NULL, 0, MSG_PEEK | MSG_TRUNC | MSG_DONTWAIT);
+        if (size > 0) {
+            if (buf.size() < static_cast<size_t>(size)) {
+                buf.resize(size);
+            }
+            size = ::recv(mFd, buf.data(), size, MSG_DONTWAIT);
+        }
+        if (size >= 0) {
+            return size;
+        }
+        if (errno == EINTR) {
+            continue;
+        }
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            return 0;
+        }
+        if (errno == ENOBUFS) {
+            LOGW("Netlink notifications were lost");
+            return -1;
+        }
+        const std::string msg = "Can't receive notification: " + getSystemErrorMessage();
+        LOGE(msg);
+        throw VasumException(msg);
+    }
+}
+
+bool Netlink::setStrictCheck(bool enable)
+{
+    if (enable == mStrictCheck) {
+        return true;
+    }
+    if (enable && !mStrictCheckSupported) {
+        return false;
+    }
+    int value = enable ? 1 : 0;
+    if (::setsockopt(mFd, SOL_NETLINK, NETLINK_GET_STRICT_CHK, &value, sizeof(value)) < 0) {
+        if (errno != ENOPROTOOPT) {
+            const std::string msg = "Can't set strict checking: " + getSystemErrorMessage();
+            LOGE(msg);
+            throw VasumException(msg);
+        }
+        LOGD("Netlink strict checking is not supported, dumps are filtered in userspace");
+        mStrictCheckSupported = false;
+        return false;
+    }
+    mStrictCheck = enable;
+    return true;
 }
 
 } //namespace netlink
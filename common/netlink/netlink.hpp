@@ -48,8 +48,9 @@ public:
      * Open connnection
      *
      * @param netNsPid pid which defines net namespace
+     * @param groups multicast groups to subscribe (RTMGRP_* bit mask)
      */
-    void open(int netNsPid = 0);
+    void open(int netNsPid = 0, unsigned int groups = 0);
 
     /**
      * Close connection
@@ -67,18 +68,75 @@ public:
      */
     unsigned int send(const void* nlmsg);
 
+    /**
+     * Send many messages in one datagram
+     *
+     * The kernel processes the messages in the given order
+     *
+     * @param nlmsgs pointers to messages
+     */
+    void send(const std::vector<const void*>& nlmsgs);
+
     /**
      * Receive message
      *
      * It is not thread safe and even you shouldn't call this function on
      * different instances at the same time
      *
+     * Each datagram is received directly to its place in the buffer.
+     * The buffer is only enlarged (never shrunk or cleared), so a reused
+     * buffer doesn't cause any allocation once it has grown large enough.
+     *
      * @param nlmsgSeq sequence number
-     * @return received data
+     * @param buf buffer for received data, data is placed at its beginning
+     * @return length of received data
+     */
+    std::size_t rcv(unsigned int nlmsgSeq, std::vector<char>& buf);
+
+    /**
+     * Receive acknowledgements of many messages
+     *
+     * Waits until every message is acknowledged, other answers are ignored.
+     * Messages which don't produce an ACK (dumps) mustn't be passed here.
+     *
+     * @param nlmsgSeqs sequence numbers of the messages
+     * @return error codes (errno values, 0 on success) in the order of nlmsgSeqs
+     */
+    std::vector<int> rcvAcks(const std::vector<unsigned int>& nlmsgSeqs);
+
+    /**
+     * Drop all messages waiting in the socket
+     *
+     * Used before reusing an opened connection, so that leftovers of
+     * a previous request (e.g. a trailing ACK) aren't taken as an answer
+     */
+    void discardPending();
+
+    /**
+     * Receive notification sent to the subscribed multicast groups
+     *
+     * Doesn't wait if there is no notification pending.
+     *
+     * @param buf buffer for received data, enlarged when needed
+     * @return length of received data, 0 if there is nothing pending
+     *         or -1 if notifications were lost (receive buffer overrun)
+     */
+    int rcvNotification(std::vector<char>& buf);
+
+    /**
+     * Enable or disable strict checking of requests (NETLINK_GET_STRICT_CHK)
+     *
+     * With strict checking the kernel validates headers of dump requests
+     * and returns only entries matching the filters given in them.
+     *
+     * @param enable new state
+     * @return false if the kernel doesn't support strict checking
      */
-    std::unique_ptr<std::vector<char>> rcv(unsigned int nlmsgSeq);
+    bool setStrictCheck(bool enable);
 private:
     int mFd;
+    bool mStrictCheck;
+    bool mStrictCheckSupported;
 };
 
 } // namesapce netlink
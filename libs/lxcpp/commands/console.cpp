@@ -35,25 +35,34 @@
 #include "utils/credentials.hpp"
 
 #include <unistd.h>
+#include <algorithm>
 #include <functional>
 #include <iostream>
-#include <cstring>
 #include <sys/ioctl.h>
 
 
 namespace lxcpp {
 
 
-Console::Console(PTYsConfig &terminals, cargo::ipc::Client &client, unsigned int terminalNum)
+Console::Console(PTYsConfig &terminals,
+                 cargo::ipc::Client &client,
+                 unsigned int terminalNum,
+                 int inFD,
+                 int outFD)
     : mTerminals(terminals),
       mTerminalNum(terminalNum),
       mClient(client),
+      mInFD(inFD),
+      mOutFD(outFD),
       mServiceMode(false),
       mQuitReason(ConsoleQuitReason::NONE),
       mEventPoll(),
       mSignalFD(mEventPoll),
-      mAppToTermOffset(0),
-      mTermToAppOffset(0)
+      mAppToTerm(IO_BUFFER_SIZE, IO_BUFFER_MAX_SIZE),
+      mTermToApp(IO_BUFFER_SIZE, IO_BUFFER_MAX_SIZE),
+      mPTYEvents(0),
+      mInEvents(0),
+      mOutEvents(0)
 {
     if (terminalNum >= terminals.mCount) {
         const std::string msg = "Requested terminal number does not exist";
@@ -68,7 +77,7 @@ Console::~Console()
 
 void Console::execute()
 {
-    if (!lxcpp::isatty(STDIN_FILENO) || !lxcpp::isatty(STDOUT_FILENO)) {
+    if (!lxcpp::isatty(mInFD) || !lxcpp::isatty(mOutFD)) {
         const std::string msg = "Standard input is not a terminal, cannot launch the console";
         LOGE(msg);
         throw TerminalException(msg);
@@ -81,22 +90,32 @@ void Console::execute()
 
     setupTTY();
     resizePTY();
+    replayLog();
 
     using namespace std::placeholders;
-    mEventPoll.addFD(STDIN_FILENO, EPOLLIN, std::bind(&Console::onStdInput, this, _1, _2));
-    mEventPoll.addFD(STDOUT_FILENO, 0, std::bind(&Console::onStdOutput, this, _1, _2));
-    mEventPoll.addFD(getCurrentFD(), EPOLLIN, std::bind(&Console::onPTY, this, _1, _2));
+    mInEvents = EPOLLIN;
+    mOutEvents = 0;
+    mPTYEvents = getPTYEvents();
+    mEventPoll.addFD(mInFD, mInEvents, std::bind(&Console::onStdInput, this, _1, _2));
+    mEventPoll.addFD(mOutFD, mOutEvents, std::bind(&Console::onStdOutput, this, _1, _2));
+    mEventPoll.addFD(getCurrentFD(), mPTYEvents, std::bind(&Console::onPTY, this, _1, _2));
 
     while (mQuitReason == ConsoleQuitReason::NONE) {
         mEventPoll.dispatchIteration(-1);
     }
 
     mEventPoll.removeFD(getCurrentFD());
-    mEventPoll.removeFD(STDIN_FILENO);
-    mEventPoll.removeFD(STDOUT_FILENO);
-
+    mEventPoll.removeFD(mInFD);
+    mEventPoll.removeFD(mOutFD);
+    detachLog();
     restoreTTY();
 
+    // Show what the container managed to print before the end,
+    // the output is blocking again so it's written at once
+    while (mAppToTerm.writeTo(mOutFD) > 0) {}
+    mAppToTerm.clear();
+    mTermToApp.clear();
+
     switch (mQuitReason) {
     case ConsoleQuitReason::USER:
         std::cout << std::endl << "User requested quit" << std::endl;
@@ -124,14 +143,17 @@ void Console::setupTTY()
     mSignalFD.setHandler(SIGWINCH, std::bind(&Console::resizePTY, this));
 
     // save the current terminal state and set it in raw mode:
-    mTTYState = makeRawTerm(STDIN_FILENO);
+    mTTYState = makeRawTerm(mInFD);
+
+    // a slow terminal mustn't block the loop, the output waits in mAppToTerm
+    utils::setNonBlocking(mOutFD, true);
 }
 
 void Console::resizePTY()
 {
     // resize the underlying PTY terminal to the size of the user terminal
     struct winsize wsz;
-    utils::ioctl(STDIN_FILENO, TIOCGWINSZ, &wsz);
+    utils::ioctl(mInFD, TIOCGWINSZ, &wsz);
     utils::ioctl(getCurrentFD(), TIOCSWINSZ, &wsz);
 
     // Notify the guard so it can resize its internal PTY
@@ -139,6 +161,44 @@ void Console::resizePTY()
                                            std::make_shared<api::Int>(mTerminalNum));
 }
 
+void Console::replayLog()
+{
+    if (mTerminals.mLogSize == 0) {
+        return;
+    }
+
+    std::string log;
+    try {
+        // The guard stops the output first, so all that waits in the PTY
+        // is in the log as well and can be dropped
+        mClient.callSync<api::Int, api::Void>(api::METHOD_DETACH_TERMINAL,
+                                              std::make_shared<api::Int>(mTerminalNum));
+        char buf[IO_BUFFER_SIZE];
+        while (TEMP_FAILURE_RETRY(::read(getCurrentFD(), buf, sizeof(buf))) > 0) {}
+
+        // Output after the returned log goes to the PTY only
+        auto request = std::make_shared<api::TerminalLogRequest>(mTerminalNum, 0, true);
+        log = mClient.callSync<api::TerminalLogRequest, api::String>(api::METHOD_GET_TERMINAL_LOG,
+                                                                     request)->value;
+    } catch (const std::exception& e) {
+        // Not fatal, the console works without the earlier output
+        LOGW("Failed to get the terminal log: " << e.what());
+        return;
+    }
+
+    utils::write(mOutFD, log.data(), log.size());
+}
+
+void Console::detachLog()
+{
+    if (mTerminals.mLogSize == 0) {
+        return;
+    }
+
+    mClient.callAsync<api::Int, api::Void>(api::METHOD_DETACH_TERMINAL,
+                                           std::make_shared<api::Int>(mTerminalNum));
+}
+
 void Console::restoreTTY()
 {
     // restore signal state
@@ -147,47 +207,34 @@ void Console::restoreTTY()
     }
 
     // restore terminal state
-    lxcpp::tcsetattr(STDIN_FILENO, TCSAFLUSH, &mTTYState);
+    utils::setNonBlocking(mOutFD, false);
+    lxcpp::tcsetattr(mInFD, TCSAFLUSH, &mTTYState);
 }
 
 void Console::onPTY(int fd, cargo::ipc::epoll::Events events)
 {
     if ((events & EPOLLIN) == EPOLLIN) {
-        const size_t avail = IO_BUFFER_SIZE - mAppToTermOffset;
-        char *buf = mAppToTerm + mAppToTermOffset;
-
-        const ssize_t read = ::read(fd, buf, avail);
-
-        if (read > 0) {
-            mAppToTermOffset += read;
-
-            if (mAppToTermOffset) {
-                mEventPoll.modifyFD(STDOUT_FILENO, EPOLLOUT);
-            }
-        }
+        mAppToTerm.readFrom(fd);
+        // Usually the terminal can take the data at once, don't wait for EPOLLOUT.
+        // The output is non-blocking, what doesn't fit waits for onStdOutput.
+        mAppToTerm.writeTo(mOutFD);
     }
 
-    if ((events & EPOLLOUT) == EPOLLOUT && mTermToAppOffset) {
-        const ssize_t written = ::write(fd, mTermToApp, mTermToAppOffset);
-
-        if (written > 0) {
-            ::memmove(mTermToApp, mTermToApp + written, mTermToAppOffset - written);
-            mTermToAppOffset -= written;
-
-            if (mTermToAppOffset == 0) {
-                mEventPoll.modifyFD(fd, EPOLLIN);
-            }
-        }
+    if ((events & EPOLLOUT) == EPOLLOUT) {
+        mTermToApp.writeTo(fd);
     }
 
     checkForError(events);
+    updateEvents();
 }
 
 void Console::onStdInput(int fd, cargo::ipc::epoll::Events events)
 {
     if ((events & EPOLLIN) == EPOLLIN) {
-        const size_t avail = IO_BUFFER_SIZE - mTermToAppOffset;
-        char *buf = mTermToApp + mTermToAppOffset;
+        // Read through a small buffer to catch the special keys,
+        // not more than fits so no input is lost
+        char buf[IO_BUFFER_SIZE];
+        const std::size_t avail = std::min(sizeof(buf), IO_BUFFER_MAX_SIZE - mTermToApp.size());
         const ssize_t read = ::read(fd, buf, avail);
 
         if (read == 1 && handleSpecial(buf[0])) {
@@ -195,33 +242,61 @@ void Console::onStdInput(int fd, cargo::ipc::epoll::Events events)
         }
 
         if (read > 0) {
-            mTermToAppOffset += read;
-
-            if (mTermToAppOffset) {
-                mEventPoll.modifyFD(getCurrentFD(), EPOLLIN | EPOLLOUT);
-            }
+            mTermToApp.push(buf, read);
+            mTermToApp.writeTo(getCurrentFD());
         }
     }
 
     checkForError(events);
+    updateEvents();
 }
 
 void Console::onStdOutput(int fd, cargo::ipc::epoll::Events events)
 {
-    if ((events & EPOLLOUT) == EPOLLOUT && mAppToTermOffset) {
-        const ssize_t written = ::write(fd, mAppToTerm, mAppToTermOffset);
+    if ((events & EPOLLOUT) == EPOLLOUT) {
+        mAppToTerm.writeTo(fd);
+    }
 
-        if (written > 0) {
-            ::memmove(mAppToTerm, mAppToTerm + written, mAppToTermOffset - written);
-            mAppToTermOffset -= written;
+    checkForError(events);
+    updateEvents();
+}
 
-            if (mAppToTermOffset == 0) {
-                mEventPoll.modifyFD(fd, 0);
-            }
-        }
+void Console::updateEvents()
+{
+    const cargo::ipc::epoll::Events ptyEvents = getPTYEvents();
+    cargo::ipc::epoll::Events inEvents = 0;
+    cargo::ipc::epoll::Events outEvents = 0;
+    if (!mTermToApp.full()) {
+        inEvents |= EPOLLIN;
+    }
+    if (!mAppToTerm.empty()) {
+        outEvents |= EPOLLOUT;
     }
 
-    checkForError(events);
+    if (ptyEvents != mPTYEvents) {
+        mEventPoll.modifyFD(getCurrentFD(), ptyEvents);
+        mPTYEvents = ptyEvents;
+    }
+    if (inEvents != mInEvents) {
+        mEventPoll.modifyFD(mInFD, inEvents);
+        mInEvents = inEvents;
+    }
+    if (outEvents != mOutEvents) {
+        mEventPoll.modifyFD(mOutFD, outEvents);
+        mOutEvents = outEvents;
+    }
+}
+
+cargo::ipc::epoll::Events Console::getPTYEvents() const
+{
+    cargo::ipc::epoll::Events events = 0;
+    if (!mAppToTerm.full()) {
+        events |= EPOLLIN;
+    }
+    if (!mTermToApp.empty()) {
+        events |= EPOLLOUT;
+    }
+    return events;
 }
 
 void Console::checkForError(cargo::ipc::epoll::Events events)
@@ -269,6 +344,7 @@ bool Console::handleSpecial(const char key)
 void Console::consoleChange(ConsoleChange direction)
 {
     mEventPoll.removeFD(getCurrentFD());
+    detachLog();
 
     switch(direction) {
     case ConsoleChange::NEXT:
@@ -284,18 +360,15 @@ void Console::consoleChange(ConsoleChange direction)
 
     mTerminalNum = (mTerminalNum + mTerminals.mCount) % mTerminals.mCount;
 
-    int mode = EPOLLIN;
-    if (mTermToAppOffset) {
-        mode |= EPOLLOUT;
-    }
-
     restoreTTY();
     std::cout << "Terminal number: " << mTerminalNum << std::endl;
     setupTTY();
     resizePTY();
+    replayLog();
 
     using namespace std::placeholders;
-    mEventPoll.addFD(getCurrentFD(), mode, std::bind(&Console::onPTY, this, _1, _2));
+    mPTYEvents = getPTYEvents();
+    mEventPoll.addFD(getCurrentFD(), mPTYEvents, std::bind(&Console::onPTY, this, _1, _2));
 }
 
 int Console::getCurrentFD() const
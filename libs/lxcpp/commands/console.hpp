@@ -26,6 +26,7 @@
 
 #include "lxcpp/commands/command.hpp"
 #include "lxcpp/pty-config.hpp"
+#include "lxcpp/ring-buffer.hpp"
 #include "lxcpp/terminal.hpp"
 
 #include "cargo-ipc/client.hpp"
@@ -33,6 +34,7 @@
 #include "utils/signalfd.hpp"
 
 #include <signal.h>
+#include <unistd.h>
 #include <array>
 
 
@@ -47,8 +49,14 @@ public:
      * @param terminals    container's terminals config
      * @param client       container's IPC client
      * @param terminalNum  initial terminal to attach to
+     * @param inFD         user's terminal input
+     * @param outFD        user's terminal output
      */
-    Console(PTYsConfig &terminals, cargo::ipc::Client &client, unsigned int terminalNum = 0);
+    Console(PTYsConfig &terminals,
+            cargo::ipc::Client &client,
+            unsigned int terminalNum = 0,
+            int inFD = STDIN_FILENO,
+            int outFD = STDOUT_FILENO);
     ~Console();
 
     void execute();
@@ -64,11 +72,14 @@ private:
         NEXT = 0,
         PREV = 1
     };
-    static const int IO_BUFFER_SIZE = 1024;
+    static const std::size_t IO_BUFFER_SIZE = 4096;
+    static const std::size_t IO_BUFFER_MAX_SIZE = 65536;
 
     PTYsConfig &mTerminals;
     int mTerminalNum;
     cargo::ipc::Client &mClient;
+    int mInFD;
+    int mOutFD;
 
     bool mServiceMode;
     ConsoleQuitReason mQuitReason;
@@ -77,18 +88,34 @@ private:
     std::vector<std::pair<int, struct ::sigaction>> mSignalStates;
     struct termios mTTYState;
 
-    char mAppToTerm[IO_BUFFER_SIZE];
-    int mAppToTermOffset;
-    char mTermToApp[IO_BUFFER_SIZE];
-    int mTermToAppOffset;
+    RingBuffer mAppToTerm;
+    RingBuffer mTermToApp;
+    cargo::ipc::epoll::Events mPTYEvents;
+    cargo::ipc::epoll::Events mInEvents;
+    cargo::ipc::epoll::Events mOutEvents;
 
     void setupTTY();
     void restoreTTY();
     void resizePTY();
+    /**
+     * Print the terminal's output from before the console was attached.
+     * Output left in the PTY is in the log, so it's dropped and shown once.
+     */
+    void replayLog();
+    /**
+     * Let the guard keep the output only in the log when the host doesn't take it
+     */
+    void detachLog();
     void onPTY(int fd, cargo::ipc::epoll::Events events);
     void onStdInput(int fd, cargo::ipc::epoll::Events events);
     void onStdOutput(int fd, cargo::ipc::epoll::Events events);
     void checkForError(cargo::ipc::epoll::Events events);
+    /**
+     * Watch the descriptors only for the events the buffers can handle,
+     * a reader stops when its buffer is full until the writer catches up
+     */
+    void updateEvents();
+    cargo::ipc::epoll::Events getPTYEvents() const;
     bool handleSpecial(char key);
     void consoleChange(ConsoleChange direction);
     int getCurrentFD() const;
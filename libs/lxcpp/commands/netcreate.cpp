@@ -25,68 +25,138 @@
 
 #include "lxcpp/commands/netcreate.hpp"
 #include "lxcpp/network.hpp"
+#include "logger/logger.hpp"
+
+#include <algorithm>
+#include <net/if.h>
 
 namespace lxcpp {
 
 namespace {
-void createBridgeIfNeeded(const NetworkInterfaceConfig& interface) {
-    NetworkInterface bridge(interface.getHostIf(), 0);
 
-    if (!bridge.exists()) {
-        bridge.create(InterfaceType::BRIDGE);
-    }
-    else {
-        LOGD("bridge already exists, reusing it");
-    }
+Attrs upAttrs()
+{
+    Attrs attrs;
+    attrs.push_back(Attr{AttrName::CHANGE, std::to_string(IFF_UP)});
+    attrs.push_back(Attr{AttrName::FLAGS, std::to_string(IFF_UP)});
+    return attrs;
+}
+
+void addBridge(NetworkBatch& batch, const NetworkInterfaceConfig& interface) {
+    NetworkInterface bridge(interface.getHostIf(), 0);
 
-    bridge.up();
-    LOGI("adding IPs");
+    batch.setAttrs(bridge.getName(), upAttrs());
     std::vector<InetAddr> bra = bridge.getInetAddressList();
+    std::vector<InetAddr> missing;
     for (const auto& addr : interface.getAddrList()) {
         InetAddr a(addr);
         if (std::find(bra.begin(), bra.end(), a) == bra.end()) {
-            bridge.addInetAddr(addr);
+            missing.push_back(a);
         }
     }
+    batch.addInetAddrs(bridge.getName(), missing);
 }
 
-void createBridgedVeth(const NetworkInterfaceConfig& interface, pid_t pid) {
-    NetworkInterface veth1(interface.getZoneIf() + "-br" + std::to_string(pid), 0);
-    NetworkInterface veth2(interface.getZoneIf(), 0);
-
-    veth1.create(InterfaceType::VETH, veth2.getName());
-    veth1.addToBridge(interface.getHostIf());
-    veth1.up();
+// missing bridges have to exist before anything refers to them
+void createMissingBridges(const NetworkConfig& network) {
+    NetworkBatch bridges;
+    for (const auto& interface : network.getInterfaces()) {
+        if (interface.getType() == InterfaceConfigType::BRIDGE) {
+            if (!NetworkInterface(interface.getHostIf(), 0).exists()) {
+                LOGI("Creating bridge " + interface.getHostIf());
+                bridges.createBridge(interface.getHostIf());
+            } else {
+                LOGD("bridge " << interface.getHostIf() << " already exists, reusing it");
+            }
+        }
+    }
+    bridges.commit();
+}
 
-    veth2.moveToContainer(pid);
+bool isZoneInterface(const NetworkInterfaceConfig& interface) {
+    return interface.getType() == InterfaceConfigType::VETH_BRIDGED ||
+           interface.getType() == InterfaceConfigType::IPVLAN_L2 ||
+           interface.getType() == InterfaceConfigType::IPVLAN_L3;
 }
 } // namespace
 
+void NetCreateAll::addZoneInterface(NetworkBatch& batch, const NetworkInterfaceConfig& interface)
+{
+    const IPVLanMode mode = interface.getType() == InterfaceConfigType::IPVLAN_L3 ? IPVLanMode::L3 : IPVLanMode::L2;
+    // zone end is created directly in the container, no move is needed
+    switch (interface.getType()) {
+    case InterfaceConfigType::VETH_BRIDGED:
+        if (mNetnsFD >= 0) {
+            batch.createBridgedVethInNetns(interface.getZoneIf() + mHostIfSuffix,
+                                           interface.getHostIf(),
+                                           interface.getZoneIf(),
+                                           mNetnsFD,
+                                           interface.getLinkOptions());
+        } else {
+            batch.createBridgedVeth(interface.getZoneIf() + mHostIfSuffix,
+                                    interface.getHostIf(),
+                                    interface.getZoneIf(),
+                                    mPid,
+                                    interface.getLinkOptions());
+        }
+        break;
+    case InterfaceConfigType::IPVLAN_L2:
+    case InterfaceConfigType::IPVLAN_L3:
+        if (mNetnsFD >= 0) {
+            batch.createIPVLanInNetns(interface.getZoneIf(), interface.getHostIf(), mode,
+                                      mNetnsFD, interface.getLinkOptions());
+        } else {
+            batch.createIPVLan(interface.getZoneIf(), interface.getHostIf(), mode,
+                               mPid, interface.getLinkOptions());
+        }
+        break;
+    default:
+        break;
+    }
+}
+
 void NetCreateAll::execute()
 {
+    createMissingBridges(mNetwork);
+
+    // then all interfaces are set up at once
+    NetworkBatch batch;
     for (const auto& interface : mNetwork.getInterfaces()) {
-        LOGI("Creating interface " + interface.getHostIf());
-        if (interface.getType() == InterfaceConfigType::LOOPBACK) {
-        } else if (interface.getType() == InterfaceConfigType::BRIDGE) {
-            createBridgeIfNeeded(interface);
-        } else if (interface.getType() == InterfaceConfigType::VETH_BRIDGED) {
-            createBridgedVeth(interface, mPid);
-        } else {
+        if (interface.getType() == InterfaceConfigType::BRIDGE) {
+            addBridge(batch, interface);
+        } else if (isZoneInterface(interface)) {
+            LOGI("Creating interface " + interface.getZoneIf() + " on " + interface.getHostIf());
+            addZoneInterface(batch, interface);
         }
     }
+    batch.commit();
+}
+
+void NetCreateBridges::execute()
+{
+    createMissingBridges(mNetwork);
+
+    NetworkBatch batch;
+    for (const auto& interface : mNetwork.getInterfaces()) {
+        if (interface.getType() == InterfaceConfigType::BRIDGE) {
+            addBridge(batch, interface);
+        }
+    }
+    batch.commit();
 }
 
 void NetConfigureAll::execute()
 {
     bool needDefaultRoute = true;
 
+    NetworkBatch batch;
     for (const auto& interface : mNetwork.getInterfaces()) {
         if (interface.getType() == InterfaceConfigType::LOOPBACK) {
 
-            NetworkInterface(interface.getHostIf(), 0).up();
+            batch.setAttrs(interface.getHostIf(), upAttrs());
 
-        } else if (interface.getType() == InterfaceConfigType::VETH_BRIDGED) {
-            NetworkInterface networkInterface(interface.getZoneIf(), 0);
+        } else if (isZoneInterface(interface)) {
+            const std::string& ifname = interface.getZoneIf();
 
             Attrs attrs;
             if (interface.getMTU() > 0) {
@@ -98,14 +168,17 @@ void NetConfigureAll::execute()
             if (interface.getTxLength() > 0) {
                 attrs.push_back(Attr{AttrName::TXQLEN, std::to_string(interface.getTxLength())});
             }
-            networkInterface.setAttrs(attrs);
-            networkInterface.up();
+            // set the attributes and bring the interface up in one request
+            for (const Attr& attr : upAttrs()) {
+                attrs.push_back(attr);
+            }
+            batch.setAttrs(ifname, attrs);
+            batch.addInetAddrs(ifname, interface.getAddrList());
 
             // TODO: add container routing config to network configration
             // NOTE: temporary - calc gw as a first IP in the network
             InetAddr gw;
             for (const auto& addr : interface.getAddrList()) {
-                networkInterface.addInetAddr(addr);
                 // NOTE: prefix 31 is used only for p2p (RFC3021)
                 if (gw.prefix == 0 && addr.type == InetAddrType::IPV4 && addr.prefix < 31) {
                     gw = addr;
@@ -118,7 +191,8 @@ void NetConfigureAll::execute()
             if (needDefaultRoute && gw.prefix > 0) {
                 needDefaultRoute = false;
                 gw.prefix = 0;
-                networkInterface.addRoute(Route{
+                // the kernel handles it after the address, so the gateway is reachable
+                batch.addRoute(ifname, Route{
                     gw,             //dst - gateway
                     InetAddr(),     //src - not specified (prefix=0)
                     0,
@@ -128,7 +202,7 @@ void NetConfigureAll::execute()
             }
         }
     }
-
+    batch.commit();
 }
 
 void NetInteraceCreate::execute()
@@ -146,9 +220,7 @@ void NetInterfaceSetAttrs::execute()
 void NetInterfaceAddInetAddr::execute()
 {
     NetworkInterface networkInterface(mIfname);
-    for (const auto& a : mAddrList) {
-        networkInterface.addInetAddr(a);
-    }
+    networkInterface.addInetAddrs(mAddrList);
 }
 
 } // namespace lxcpp
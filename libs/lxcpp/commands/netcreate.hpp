@@ -26,8 +26,10 @@
 
 #include "lxcpp/commands/command.hpp"
 #include "lxcpp/network-config.hpp"
+#include "lxcpp/network.hpp"
 #include "lxcpp/container.hpp"
 
+#include <string>
 #include <sys/types.h>
 
 namespace lxcpp {
@@ -39,7 +41,21 @@ public:
     */
     NetCreateAll(const NetworkConfig& network, pid_t pid) :
         mNetwork(network),
-        mPid(pid)
+        mPid(pid),
+        mNetnsFD(-1),
+        mHostIfSuffix("-br" + std::to_string(pid))
+    {
+    }
+
+   /**
+    * Creates network interfaces in network namespace referred to by @b netnsFD,
+    * @b hostIfSuffix makes the host side interface names unique (exec in host context)
+    */
+    NetCreateAll(const NetworkConfig& network, int netnsFD, const std::string& hostIfSuffix) :
+        mNetwork(network),
+        mPid(0),
+        mNetnsFD(netnsFD),
+        mHostIfSuffix(hostIfSuffix)
     {
     }
 
@@ -48,6 +64,27 @@ public:
 private:
     const NetworkConfig& mNetwork;
     pid_t mPid;
+    int mNetnsFD;
+    std::string mHostIfSuffix;
+
+    void addZoneInterface(NetworkBatch& batch, const NetworkInterfaceConfig& interface);
+};
+
+class NetCreateBridges final: Command {
+public:
+   /**
+    * Creates missing bridges, brings them up and adds their addresses (exec in host context).
+    * Used when zone interfaces come from a prepared network namespace.
+    */
+    NetCreateBridges(const NetworkConfig& network) :
+        mNetwork(network)
+    {
+    }
+
+    void execute();
+
+private:
+    const NetworkConfig& mNetwork;
 };
 
 class NetConfigureAll final: Command {
@@ -27,9 +27,9 @@
 #include "lxcpp/exception.hpp"
 #include "lxcpp/process.hpp"
 #include "lxcpp/utils.hpp"
-#include "lxcpp/terminal.hpp"
 #include "lxcpp/guard/api.hpp"
 
+#include "cargo-fd/cargo-fd.hpp"
 #include "logger/logger.hpp"
 #include "utils/file-wait.hpp"
 #include "cargo-ipc/epoll/thread-dispatcher.hpp"
@@ -42,10 +42,15 @@
 namespace lxcpp {
 
 
-Start::Start(std::shared_ptr<ContainerConfig>& config)
+Start::Start(std::shared_ptr<ContainerConfig>& config, const bool passConfig)
     : mConfig(config),
       mGuardPath(GUARD_PATH)
 {
+    if (passConfig) {
+        // The guard gets the right end as an argument
+        mConfigChannel.reset(new utils::Channel(false));
+        mConfigChannelFDStr = std::to_string(mConfigChannel->getRightFD());
+    }
 }
 
 Start::~Start()
@@ -61,6 +66,9 @@ void Start::execute()
         parent(pid);
     } else {
         // Below this point only safe functions mentioned in signal(7) are allowed.
+        if (mConfigChannel) {
+            mConfigChannel->setRight();
+        }
         daemonize();
         ::_exit(EXIT_FAILURE);
     }
@@ -68,6 +76,10 @@ void Start::execute()
 
 void Start::parent(const pid_t pid)
 {
+    if (mConfigChannel) {
+        mConfigChannel->setLeft();
+    }
+
     // Collect a helper process
     int status = lxcpp::waitpid(pid);
     if (status != EXIT_SUCCESS) {
@@ -75,35 +87,24 @@ void Start::parent(const pid_t pid)
         LOGE(msg);
         throw ProcessSetupException(msg);
     }
+
+    if (mConfigChannel) {
+        // Guard reads it before creating its socket
+        try {
+            cargo::saveToFD(mConfigChannel->getFD(), *mConfig);
+        } catch (const std::exception& e) {
+            const std::string msg = std::string("Failed to pass the config to the guard: ") + e.what();
+            LOGE(msg);
+            throw ProcessSetupException(msg);
+        }
+        mConfigChannel->shutdown();
+    }
 }
 
 void Start::daemonize()
 {
-    // Prepare a clean daemonized environment for a guard process:
-
-    // Set a new session so the process looses its control terminal
-    if (::setsid() < 0) {
-        ::_exit(EXIT_FAILURE);
-    }
-
-    // Double fork() with exit() to reattach the process under the host's init
-    // and to make sure that the child (guard) is not a process group leader
-    // and cannot reacquire its control terminal
-    pid_t pid = ::fork();
-    if (pid < 0) { // fork failed
-        ::_exit(EXIT_FAILURE);
-    }
-    if (pid > 0) { // exit in parent process
-        ::_exit(EXIT_SUCCESS);
-    }
-
-    // Chdir to / so it's independent on other directories
-    if (::chdir("/") < 0) {
-        ::_exit(EXIT_FAILURE);
-    }
-
-    // Null std* fds so it's properly dettached from the terminal
-    if (nullStdFDs() < 0) {
+    // Prepare a clean daemonized environment for a guard process
+    if (lxcpp::daemonize() < 0) {
         ::_exit(EXIT_FAILURE);
     }
 
@@ -114,6 +115,7 @@ void Start::daemonize()
                           mConfig->mSocketPath.c_str(),
                           mConfig->mName.c_str(),
                           mConfig->mRootPath.c_str(),
+                          mConfigChannel ? mConfigChannelFDStr.c_str() : NULL,
                           NULL
                          };
     ::execve(argv[0], const_cast<char *const*>(argv), NULL);
@@ -50,8 +50,10 @@ public:
 
     /**
      * @param config container's config
+     * @param passConfig write the config to the guard at exec,
+     *                   otherwise the host sends it once the guard is ready
      */
-    Start(std::shared_ptr<ContainerConfig>& config);
+    Start(std::shared_ptr<ContainerConfig>& config, const bool passConfig = false);
     ~Start();
 
     void execute();
@@ -59,6 +61,8 @@ public:
 private:
     std::shared_ptr<ContainerConfig> mConfig;
     std::string mGuardPath;
+    std::unique_ptr<utils::Channel> mConfigChannel;
+    std::string mConfigChannelFDStr;
 
     void parent(const pid_t pid);
     void daemonize();
@@ -31,6 +31,7 @@
 #include "lxcpp/provision-config.hpp"
 #include "lxcpp/userns-config.hpp"
 #include "lxcpp/smackns-config.hpp"
+#include "lxcpp/start-profile.hpp"
 #include "lxcpp/cgroups/cgroup-config.hpp"
 
 #include <cargo/fields.hpp>
@@ -234,6 +235,14 @@ struct ContainerConfig {
      */
     std::map<std::string, std::string> mKernelParameters;
 
+    /**
+     * Timing of the last start, recorded by the host, the guard and the init
+     *
+     * Set: automatically during start()
+     * Get: getStartProfile()
+     */
+    StartProfile mStartProfile;
+
     ContainerConfig():
         mOldRoot("/.oldroot"),
         mGuardPid(-1),
@@ -267,7 +276,8 @@ struct ContainerConfig {
         mCapsToKeep,
         mEnvToSet,
         mRlimits,
-        mKernelParameters
+        mKernelParameters,
+        mStartProfile
     )
 };
 
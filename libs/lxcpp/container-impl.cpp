@@ -27,6 +27,8 @@
 #include "lxcpp/exception.hpp"
 #include "lxcpp/process.hpp"
 #include "lxcpp/capability.hpp"
+#include "lxcpp/guard-zygote.hpp"
+#include "lxcpp/netns-pool.hpp"
 #include "lxcpp/commands/attach.hpp"
 #include "lxcpp/commands/console.hpp"
 #include "lxcpp/commands/start.hpp"
@@ -36,6 +38,7 @@
 
 #include "logger/logger.hpp"
 #include "utils/fs.hpp"
+#include "utils/fd-utils.hpp"
 #include "utils/paths.hpp"
 #include "utils/exception.hpp"
 
@@ -55,7 +58,10 @@ ContainerImpl::ContainerImpl(const std::string &name,
                              const std::string &rootPath,
                              const std::string &workPath)
     : mConfig(new ContainerConfig()),
-      mInotify(mDispatcher.getPoll())
+      mInotify(mDispatcher.getPoll()),
+      mNetnsFD(-1),
+      mConfigAtGuardExec(false),
+      mConfigPassed(false)
 {
     // Validate arguments
     if (name.empty()) {
@@ -104,6 +110,10 @@ ContainerImpl::ContainerImpl(const std::string &name,
 ContainerImpl::~ContainerImpl()
 {
     mClient->stop(true);
+
+    if (mNetnsFD >= 0) {
+        utils::close(mNetnsFD);
+    }
 }
 
 void ContainerImpl::containerPrep()
@@ -151,6 +161,8 @@ cargo::ipc::HandlerExitCode ContainerImpl::onGuardConnected(const cargo::ipc::Pe
 
     // Init's PID and Status are saved.
     mConfig = data;
+    // The host's part of the start profile was kept by the host which started the container
+    mConfig->mStartProfile.clear();
 
     if (mConnectedCallback) {
         mConnectedCallback();
@@ -273,6 +285,14 @@ void ContainerImpl::setTerminalCount(const unsigned int count)
     mConfig->mTerminals.mCount = count;
 }
 
+void ContainerImpl::setTerminalLog(const unsigned int size, const bool fileBacked)
+{
+    Lock lock(mStateMutex);
+
+    mConfig->mTerminals.mLogSize = size;
+    mConfig->mTerminals.mLogFile = fileBacked;
+}
+
 void ContainerImpl::addUIDMap(uid_t contID, uid_t hostID, unsigned num)
 {
     Lock lock(mStateMutex);
@@ -337,19 +357,39 @@ void ContainerImpl::start(const unsigned int timeoutMS)
         throw ConfigureException(msg);
     }
 
+    StartProfile& profile = mConfig->mStartProfile;
+    profile.clear();
+
+    profile.begin("container-prep");
     containerPrep();
+    profile.end();
 
-    Start start(mConfig);
-    start.execute();
+    profile.begin("start");
+    if (mGuardZygote) {
+        mConfig->mGuardPid = mGuardZygote->spawnGuard(*mConfig);
+        mConfigPassed = false;
+    } else {
+        Start start(mConfig, mConfigAtGuardExec);
+        start.execute();
+        mConfigPassed = mConfigAtGuardExec;
+    }
+    profile.end();
+
+    // Ends when the guard connects back
+    profile.begin("guard-exec");
 }
 
 
-void ContainerImpl::onConfigSet(cargo::ipc::Result<api::Void>&& result)
+void ContainerImpl::onNetnsSet(cargo::ipc::Result<api::Void>&& result)
 {
+    Lock lock(mStateMutex);
+
+    // Guard has its own descriptor now or creates the namespace by itself
     if (!result.isValid()) {
-        LOGE("Failed to set container configuration");
-        result.rethrow();
+        LOGW("Failed to pass the prepared network namespace");
     }
+    utils::close(mNetnsFD);
+    mNetnsFD = -1;
 }
 
 void ContainerImpl::onInitStarted(cargo::ipc::Result<api::Pid>&& result)
@@ -357,7 +397,7 @@ void ContainerImpl::onInitStarted(cargo::ipc::Result<api::Pid>&& result)
     Lock lock(mStateMutex);
 
     if (!result.isValid()) {
-        LOGE("Failed to get init's PID");
+        LOGE("Failed to start init");
         result.rethrow();
     }
 
@@ -382,14 +422,34 @@ cargo::ipc::HandlerExitCode ContainerImpl::onGuardReady(const cargo::ipc::PeerID
 {
     Lock lock(mStateMutex);
 
+    mConfig->mStartProfile.end();
+
     // Guard is up and Init needs to be started
     using namespace std::placeholders;
-    mClient->callAsyncFromCallback<ContainerConfig, api::Void>(api::METHOD_SET_CONFIG,
-            mConfig,
-            std::bind(&ContainerImpl::onConfigSet, this, _1));
-    mClient->callAsyncFromCallback<api::Void, api::Pid>(api::METHOD_START,
-            std::shared_ptr<api::Void>(),
-            std::bind(&ContainerImpl::onInitStarted, this, _1));
+    // Network namespace from the pool can't be owned by a new user namespace
+    if (mNetnsPool &&
+        (mConfig->mNamespaces & CLONE_NEWNET) &&
+        !(mConfig->mNamespaces & CLONE_NEWUSER) &&
+        mNetnsPool->isCompatible(mConfig->mNetwork)) {
+        mNetnsFD = mNetnsPool->acquire();
+        if (mNetnsFD >= 0) {
+            auto netns = std::make_shared<api::Netns>();
+            netns->fd = mNetnsFD;
+            mClient->callAsyncFromCallback<api::Netns, api::Void>(api::METHOD_SET_NETNS,
+                    netns,
+                    std::bind(&ContainerImpl::onNetnsSet, this, _1));
+        }
+    }
+    if (mConfigPassed) {
+        // Guard got the config at exec
+        mClient->callAsyncFromCallback<api::Void, api::Pid>(api::METHOD_START,
+                std::shared_ptr<api::Void>(),
+                std::bind(&ContainerImpl::onInitStarted, this, _1));
+    } else {
+        mClient->callAsyncFromCallback<ContainerConfig, api::Pid>(api::METHOD_CONFIG_AND_START,
+                mConfig,
+                std::bind(&ContainerImpl::onInitStarted, this, _1));
+    }
 
     methodResult->setVoid();
     return cargo::ipc::HandlerExitCode::SUCCESS;
@@ -533,6 +593,50 @@ void ContainerImpl::console(unsigned int terminalNum)
     console.execute();
 }
 
+StartProfile ContainerImpl::getStartProfile()
+{
+    {
+        Lock lock(mStateMutex);
+
+        // Only the host's part is known before the guard finishes the start
+        if (mConfig->mState != Container::State::RUNNING) {
+            return mConfig->mStartProfile;
+        }
+    }
+
+    auto guardProfile = mClient->callSync<api::Void, StartProfile>(api::METHOD_GET_START_PROFILE,
+                                                                   std::make_shared<api::Void>());
+
+    // Guard times only its own and the init's phases
+    Lock lock(mStateMutex);
+    StartProfile profile = mConfig->mStartProfile;
+    profile.append(*guardProfile);
+    return profile;
+}
+
+std::string ContainerImpl::getTerminalLog(unsigned int terminalNum, unsigned int size)
+{
+    {
+        Lock lock(mStateMutex);
+
+        if (mConfig->mState != Container::State::RUNNING) {
+            const std::string msg = "Container isn't running, can't get the terminal log";
+            LOGE(msg);
+            throw ForbiddenActionException(msg);
+        }
+    }
+
+    auto request = std::make_shared<api::TerminalLogRequest>(terminalNum, size);
+    try {
+        return mClient->callSync<api::TerminalLogRequest, api::String>(api::METHOD_GET_TERMINAL_LOG,
+                                                                       request)->value;
+    } catch (const std::exception& e) {
+        const std::string msg = std::string("Failed to get the terminal log: ") + e.what();
+        LOGE(msg);
+        throw TerminalException(msg);
+    }
+}
+
 void ContainerImpl::addInterfaceConfig(InterfaceConfigType type,
                                        const std::string& hostif,
                                        const std::string& zoneif,
@@ -552,6 +656,34 @@ void ContainerImpl::addInetConfig(const std::string& ifname, const InetAddr& add
     mConfig->mNetwork.addInetConfig(ifname, addr);
 }
 
+void ContainerImpl::setLinkOptionsConfig(const std::string& ifname, const LinkOptions& options)
+{
+    Lock lock(mStateMutex);
+
+    mConfig->mNetwork.setLinkOptionsConfig(ifname, options);
+}
+
+void ContainerImpl::setNetnsPool(const std::shared_ptr<NetnsPool>& pool)
+{
+    Lock lock(mStateMutex);
+
+    mNetnsPool = pool;
+}
+
+void ContainerImpl::setGuardZygote(const std::shared_ptr<GuardZygote>& zygote)
+{
+    Lock lock(mStateMutex);
+
+    mGuardZygote = zygote;
+}
+
+void ContainerImpl::setConfigAtGuardExec(const bool enabled)
+{
+    Lock lock(mStateMutex);
+
+    mConfigAtGuardExec = enabled;
+}
+
 std::vector<std::string> ContainerImpl::getInterfaces() const
 {
     Lock lock(mStateMutex);
@@ -25,7 +25,9 @@
 #define LXCPP_CONTAINER_IMPL_HPP
 
 #include <sys/types.h>
+#include <condition_variable>
 #include <memory>
+#include <mutex>
 
 #include "lxcpp/container-config.hpp"
 #include "lxcpp/container.hpp"
@@ -72,6 +74,7 @@ public:
                    const std::string &arg);
 
     void setTerminalCount(const unsigned int count);
+    void setTerminalLog(const unsigned int size, const bool fileBacked);
 
     void addUIDMap(uid_t contID, uid_t hostID, unsigned num);
     void addGIDMap(gid_t contID, gid_t hostID, unsigned num);
@@ -88,6 +91,7 @@ public:
 
     // State
     Container::State getState();
+    StartProfile getStartProfile();
     void setStartedCallback(const Container::Callback& callback);
     void setStoppedCallback(const Container::Callback& callback);
     void setConnectedCallback(const Container::Callback& callback);
@@ -103,6 +107,7 @@ public:
                const std::vector<std::string>& envToKeep,
                const std::vector<std::pair<std::string, std::string>>& envToSet);
     void console(unsigned int terminalNum = 0);
+    std::string getTerminalLog(unsigned int terminalNum = 0, unsigned int size = 0);
 
     // Network interfaces setup/config
     /**
@@ -115,6 +120,10 @@ public:
                             const std::vector<InetAddr>& addrs,
                             MacVLanMode mode);
     void addInetConfig(const std::string& ifname, const InetAddr& addr);
+    void setLinkOptionsConfig(const std::string& ifname, const LinkOptions& options);
+    void setNetnsPool(const std::shared_ptr<NetnsPool>& pool);
+    void setGuardZygote(const std::shared_ptr<GuardZygote>& zygote);
+    void setConfigAtGuardExec(const bool enabled);
 
     // Network interfaces (runtime)
     std::vector<std::string> getInterfaces() const;
@@ -204,6 +213,17 @@ private:
     std::shared_ptr<cargo::ipc::Client> mClient;
     utils::Inotify mInotify;
 
+    // Prepared network namespaces and the one being passed to the Guard
+    std::shared_ptr<NetnsPool> mNetnsPool;
+    int mNetnsFD;
+
+    // Forks the Guard on start if set
+    std::shared_ptr<GuardZygote> mGuardZygote;
+
+    // Config written to the Guard at exec instead of sent when it's ready
+    bool mConfigAtGuardExec;
+    bool mConfigPassed;
+
     // Callbacks
     Container::Callback mStartedCallback;
     Container::Callback mStoppedCallback;
@@ -252,9 +272,9 @@ private:
                                                  cargo::ipc::MethodResult::Pointer);
 
     /**
-     * Configuration has been set in guard
+     * Prepared network namespace has been passed to guard
      */
-    void onConfigSet(cargo::ipc::Result<api::Void>&& result);
+    void onNetnsSet(cargo::ipc::Result<api::Void>&& result);
 
     /**
      * Guards just started Init and passes its PID
@@ -25,14 +25,18 @@
 #define LXCPP_CONTAINER_HPP
 
 #include "lxcpp/network-config.hpp"
+#include "lxcpp/guard-zygote.hpp"
+#include "lxcpp/netns-pool.hpp"
 #include "lxcpp/provision-config.hpp"
 #include "lxcpp/cgroups/cgroup-config.hpp"
 #include "lxcpp/logger-config.hpp"
+#include "lxcpp/start-profile.hpp"
 
 #include <sys/types.h>
 
 #include <string>
 #include <functional>
+#include <memory>
 #include <vector>
 
 namespace lxcpp {
@@ -80,6 +84,11 @@ public:
                            const std::string &arg = "") = 0;
 
     virtual void setTerminalCount(const unsigned int count) = 0;
+    /**
+     * Keep the last @b size bytes of each terminal's output, 0 disables.
+     * A file backed log is kept in the work path after the container stops.
+     */
+    virtual void setTerminalLog(const unsigned int size, const bool fileBacked = false) = 0;
 
     virtual void addUIDMap(uid_t contID, uid_t hostID, unsigned num) = 0;
     virtual void addGIDMap(gid_t contID, gid_t hostID, unsigned num) = 0;
@@ -101,6 +110,10 @@ public:
      * States
      */
     virtual State getState() = 0;
+    /**
+     * Timing of the phases of the last start
+     */
+    virtual StartProfile getStartProfile() = 0;
     virtual void setStartedCallback(const Callback& callback) = 0;
     virtual void setStoppedCallback(const Callback& callback) = 0;
     virtual void setConnectedCallback(const Callback& callback) = 0;
@@ -118,6 +131,10 @@ public:
                        const std::vector<std::string>& envToKeep,
                        const std::vector<std::pair<std::string, std::string>>& envToSet) = 0;
     virtual void console(unsigned int terminalNum = 0) = 0;
+    /**
+     * Get the last @b size bytes of the terminal's output, the whole log if 0
+     */
+    virtual std::string getTerminalLog(unsigned int terminalNum = 0, unsigned int size = 0) = 0;
 
     // Network interfaces setup/config
     virtual void addInterfaceConfig(InterfaceConfigType type,
@@ -126,6 +143,19 @@ public:
                                     const std::vector<InetAddr>& addrs = std::vector<InetAddr>(),
                                     MacVLanMode mode = MacVLanMode::PRIVATE) = 0;
     virtual void addInetConfig(const std::string& ifname, const InetAddr& addr) = 0;
+    virtual void setLinkOptionsConfig(const std::string& ifname, const LinkOptions& options) = 0;
+    virtual void setNetnsPool(const std::shared_ptr<NetnsPool>& pool) = 0;
+
+    /**
+     * Start the container's guard with the zygote instead of executing it
+     */
+    virtual void setGuardZygote(const std::shared_ptr<GuardZygote>& zygote) = 0;
+
+    /**
+     * Pass the config to the guard when it's executed, so the host only has
+     * to start the container once the guard is ready. Not used with the zygote.
+     */
+    virtual void setConfigAtGuardExec(const bool enabled) = 0;
 
     /**
      * Network interfaces (runtime)
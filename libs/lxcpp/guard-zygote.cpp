@@ -0,0 +1,146 @@
+/*
+ *  Copyright (C) 2015 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License version 2.1 as published by the Free Software Foundation.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+/**
+ * @file
+ * @author  agent (agent@local)
+ * @brief   Host side of the guard zygote
+ */
+
+#include "config.hpp"
+
+#include "lxcpp/guard-zygote.hpp"
+#include "lxcpp/container-config.hpp"
+#include "lxcpp/exception.hpp"
+#include "lxcpp/process.hpp"
+#include "lxcpp/terminal.hpp"
+#include "lxcpp/guard/api.hpp"
+
+#include "cargo-fd/cargo-fd.hpp"
+#include "logger/logger.hpp"
+#include "utils/c-args.hpp"
+#include "utils/channel.hpp"
+#include "utils/exception.hpp"
+#include "utils/fd-utils.hpp"
+#include "utils/signal.hpp"
+
+#include <cstring>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+namespace lxcpp {
+
+GuardZygote::GuardZygote(const std::string& socketPath)
+    : mSocketPath(socketPath)
+{
+    utils::Channel channel(false);
+    const std::string channelFDStr = std::to_string(channel.getRightFD());
+    utils::CArgsBuilder argv;
+    argv.add(GUARD_PATH)
+        .add(api::GUARD_ZYGOTE_OPTION.c_str())
+        .add(mSocketPath.c_str())
+        .add(channelFDStr.c_str());
+
+    mPid = lxcpp::fork();
+    if (mPid == 0) {
+        channel.setRight();
+
+        // Detached from the terminal like guards started without the zygote
+        if (::setsid() < 0 || nullStdFDs() < 0) {
+            ::_exit(EXIT_FAILURE);
+        }
+        lxcpp::execve(argv);
+        ::_exit(EXIT_FAILURE);
+    }
+
+    channel.setLeft();
+    try {
+        channel.read<bool>();
+    } catch (const std::exception& e) {
+        lxcpp::waitpid(mPid);
+        const std::string msg = std::string("Guard zygote failed to start: ") + e.what();
+        LOGE(msg);
+        throw ProcessSetupException(msg);
+    }
+    channel.shutdown();
+
+    LOGD("Guard zygote started: " << mPid);
+}
+
+GuardZygote::~GuardZygote()
+{
+    try {
+        utils::sendSignal(mPid, SIGTERM);
+        lxcpp::waitpid(mPid);
+    } catch (const std::exception& e) {
+        LOGW("Failed to stop the guard zygote: " << e.what());
+    }
+    ::unlink(mSocketPath.c_str());
+}
+
+pid_t GuardZygote::spawnGuard(const ContainerConfig& config)
+{
+    ::sockaddr_un addr;
+    ::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    ::strncpy(addr.sun_path, mSocketPath.c_str(), sizeof(addr.sun_path) - 1);
+
+    const int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0 || ::connect(fd, reinterpret_cast<::sockaddr*>(&addr), sizeof(addr)) < 0) {
+        const std::string msg = "Can't connect to the guard zygote: " + utils::getSystemErrorMessage();
+        if (fd >= 0) {
+            utils::close(fd);
+        }
+        LOGE(msg);
+        throw ProcessSetupException(msg);
+    }
+
+    // The socket's path could have been taken over, the config goes only to our zygote
+    ::ucred cred;
+    ::socklen_t len = sizeof(cred);
+    if (::getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &cred, &len) < 0 || cred.pid != mPid) {
+        utils::close(fd);
+        const std::string msg = "Guard zygote's socket isn't served by the zygote";
+        LOGE(msg);
+        throw ProcessSetupException(msg);
+    }
+
+    pid_t pid;
+    try {
+        cargo::saveToFD(fd, api::ZygoteRequest(config.mSocketPath, config.mName, config.mRootPath));
+        // Sent by the guard when its socket is ready
+        utils::read(fd, &pid, sizeof(pid));
+    } catch (const std::exception& e) {
+        utils::close(fd);
+        const std::string msg = std::string("Guard zygote failed to fork a guard: ") + e.what();
+        LOGE(msg);
+        throw ProcessSetupException(msg);
+    }
+    utils::close(fd);
+
+    LOGD("Guard forked by the zygote: " << pid);
+    return pid;
+}
+
+pid_t GuardZygote::getPid() const
+{
+    return mPid;
+}
+
+} // namespace lxcpp
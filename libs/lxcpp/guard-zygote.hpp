@@ -0,0 +1,72 @@
+/*
+ *  Copyright (C) 2015 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License version 2.1 as published by the Free Software Foundation.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+/**
+ * @file
+ * @author  agent (agent@local)
+ * @brief   Host side of the guard zygote
+ */
+
+#ifndef LXCPP_GUARD_ZYGOTE_HPP
+#define LXCPP_GUARD_ZYGOTE_HPP
+
+#include <string>
+#include <sys/types.h>
+
+namespace lxcpp {
+
+struct ContainerConfig;
+
+/**
+ * GuardZygote runs a pre-initialized guard process which forks guards
+ * for starting containers, instead of the fork, daemonize and exec
+ * done for each start. It pays off when containers are started in bursts.
+ *
+ * The zygote is stopped with the object, already forked guards keep running.
+ * It can be shared by many containers, requests are independent.
+ */
+class GuardZygote {
+public:
+    /**
+     * Start the zygote and wait until it's ready
+     *
+     * @param socketPath path of the socket the zygote listens on
+     */
+    explicit GuardZygote(const std::string& socketPath);
+    ~GuardZygote();
+
+    GuardZygote(const GuardZygote&) = delete;
+    GuardZygote& operator=(const GuardZygote&) = delete;
+
+    /**
+     * Fork a guard for the container
+     *
+     * @return PID of the guard, its socket is already listening
+     */
+    pid_t spawnGuard(const ContainerConfig& config);
+
+    pid_t getPid() const;
+
+private:
+    const std::string mSocketPath;
+    pid_t mPid;
+};
+
+} // namespace lxcpp
+
+#endif // LXCPP_GUARD_ZYGOTE_HPP
@@ -43,9 +43,20 @@ const ::cargo::ipc::MethodID METHOD_GUARD_READY     = 5;
 const ::cargo::ipc::MethodID METHOD_INIT_STOPPED    = 6;
 const ::cargo::ipc::MethodID METHOD_GUARD_CONNECTED = 7;
 const ::cargo::ipc::MethodID METHOD_RESIZE_TERM     = 8;
+const ::cargo::ipc::MethodID METHOD_SET_NETNS       = 9;
+const ::cargo::ipc::MethodID METHOD_GET_TERMINAL_LOG = 10;
+const ::cargo::ipc::MethodID METHOD_GET_START_PROFILE = 11;
+const ::cargo::ipc::MethodID METHOD_CONFIG_AND_START = 12;
+const ::cargo::ipc::MethodID METHOD_DETACH_TERMINAL = 13;
 
 
 const int GUARD_SET_CONFIG_ERROR                    = -1;
+const int GUARD_TERMINAL_ERROR                      = -2;
+
+// Guard's arguments: <socket path> <name> <root path> [<config channel FD>]
+// If the channel is passed the config is read from it before the socket is created.
+// Guard's argument to run as a zygote: --zygote <socket path> <channel FD>
+const std::string GUARD_ZYGOTE_OPTION = "--zygote";
 
 
 struct Void {
@@ -66,6 +77,63 @@ struct Int {
 typedef Int Pid;
 typedef Int ExitStatus;
 
+struct String {
+    std::string value;
+
+    String(const std::string& v = std::string()): value(v) {}
+
+    CARGO_REGISTER
+    (
+        value
+    )
+};
+
+struct Netns {
+    ::cargo::FileDescriptor fd;
+
+    CARGO_REGISTER
+    (
+        fd
+    )
+};
+
+struct TerminalLogRequest {
+    int terminal;
+    // number of the last bytes to get, 0 for the whole log
+    unsigned int size;
+    // a console attaches: the output not yet passed to the host is dropped,
+    // it's in the returned log, and the later output is passed again
+    bool replay;
+
+    TerminalLogRequest(int t = 0, unsigned int s = 0, bool r = false)
+        : terminal(t), size(s), replay(r) {}
+
+    CARGO_REGISTER
+    (
+        terminal,
+        size,
+        replay
+    )
+};
+
+// Guard's arguments, sent to the zygote to fork a guard
+struct ZygoteRequest {
+    std::string socketPath;
+    std::string name;
+    std::string rootPath;
+
+    ZygoteRequest() = default;
+    ZygoteRequest(const std::string& s, const std::string& n, const std::string& r)
+        : socketPath(s), name(n), rootPath(r) {}
+
+    CARGO_REGISTER
+    (
+        socketPath,
+        name,
+        rootPath
+    )
+};
+
 } // namespace api
 } // namespace lxcpp
 
@@ -43,12 +43,16 @@
 #include "lxcpp/commands/prep-dev-fs.hpp"
 #include "lxcpp/commands/pivot-and-prep-root.hpp"
 
+#include "cargo-fd/cargo-fd.hpp"
 #include "logger/logger.hpp"
 #include "utils/fs.hpp"
+#include "utils/fd-utils.hpp"
 #include "utils/signal.hpp"
 #include "utils/paths.hpp"
 #include "utils/credentials.hpp"
 
+#include <algorithm>
+
 #include <unistd.h>
 #include <sys/ioctl.h>
 #include <sys/wait.h>
@@ -57,22 +61,46 @@ namespace lxcpp {
 
 void Guard::containerPrepPreClone()
 {
+    StartProfile& profile = mConfig->mStartProfile;
+
+    profile.begin("prep-dev-fs");
     PrepDevFS devFS(*mConfig);
     devFS.execute();
+    profile.end();
 
+    profile.begin("prep-pty-terminal");
     PrepPTYTerminal ptys(mGuardPTYs);
     ptys.execute();
+    profile.end();
 
+    profile.begin("provisions");
     Provisions provisions(*mConfig);
     provisions.execute();
+    profile.end();
 
+    profile.begin("cgroup-make-all");
     CGroupMakeAll cgroups(mConfig->mCgroups, mConfig->mUserNSConfig);
     cgroups.execute();
-
-    mContToImpl.resize(mGuardPTYs.mCount);
-    mImplToCont.resize(mGuardPTYs.mCount);
-    mContToImplOffset.resize(mGuardPTYs.mCount);
-    mImplToContOffset.resize(mGuardPTYs.mCount);
+    profile.end();
+
+    mContToImpl.assign(mGuardPTYs.mCount, RingBuffer(IO_BUFFER_SIZE, IO_BUFFER_MAX_SIZE));
+    mImplToCont.assign(mGuardPTYs.mCount, RingBuffer(IO_BUFFER_SIZE, IO_BUFFER_MAX_SIZE));
+    mContEvents.assign(mGuardPTYs.mCount, EPOLLIN);
+    mImplEvents.assign(mGuardPTYs.mCount, EPOLLIN);
+
+    mTerminalLogs.clear();
+    mConsoleAttached.assign(mGuardPTYs.mCount, false);
+    mDroppedOutput.assign(mGuardPTYs.mCount, 0);
+    if (mConfig->mTerminals.mLogSize > 0) {
+        for (unsigned i = 0; i < mGuardPTYs.mCount; ++i) {
+            std::string path;
+            if (mConfig->mTerminals.mLogFile) {
+                path = utils::createFilePath(mConfig->mWorkPath,
+                                             mConfig->mName + ".terminal" + std::to_string(i) + ".log");
+            }
+            mTerminalLogs.emplace_back(new TerminalLog(mConfig->mTerminals.mLogSize, path));
+        }
+    }
 
     using namespace std::placeholders;
     for (unsigned i = 0; i < mGuardPTYs.mPTYs.size(); ++i) {
@@ -80,9 +108,6 @@ void Guard::containerPrepPreClone()
         int implFD = utils::open(mConfig->mTerminals.mPTYs[i].mPtsName, O_RDWR|O_NOCTTY|O_NONBLOCK|O_CLOEXEC);
         mImplSlaveFDs.push_back(implFD);
 
-        mContToImplOffset[i] = 0;
-        mImplToContOffset[i] = 0;
-
         mEventPoll.addFD(contFD, EPOLLIN, std::bind(&Guard::onContTerminal, this, i, _1, _2));
         mEventPoll.addFD(implFD, EPOLLIN, std::bind(&Guard::onImplTerminal, this, i, _1, _2));
     }
@@ -90,33 +115,59 @@ void Guard::containerPrepPreClone()
 
 void Guard::containerPrepPostClone()
 {
+    StartProfile& profile = mConfig->mStartProfile;
+
+    profile.begin("setup-userns");
     SetupUserNS userNS(mConfig->mUserNSConfig, mConfig->mInitPid);
     userNS.execute();
+    profile.end();
 
-    NetCreateAll network(mConfig->mNetwork, mConfig->mInitPid);
-    network.execute();
+    if (mNetnsFD < 0) {
+        profile.begin("net-create-all");
+        NetCreateAll network(mConfig->mNetwork, mConfig->mInitPid);
+        network.execute();
+        profile.end();
+    } else {
+        // the pool set up bridges of its own configuration, zone addresses
+        // are added by NetConfigureAll in the container
+        profile.begin("net-create-bridges");
+        NetCreateBridges bridges(mConfig->mNetwork);
+        bridges.execute();
+        profile.end();
+    }
 
+    profile.begin("setup-smackns");
     SetupSmackNS smackNS(mConfig->mSmackNSConfig, mConfig->mInitPid);
     smackNS.execute();
+    profile.end();
 
+    profile.begin("cgroup-assign-pid-all");
     CGroupAssignPidAll cgroupAssignPid(mConfig->mCgroups, mConfig->mInitPid);
     cgroupAssignPid.execute();
+    profile.end();
 }
 
-void Guard::containerPrepInClone(ContainerConfig &config)
+void Guard::containerPrepInClone(ContainerConfig &config, StartProfile &profile)
 {
     lxcpp::setHostName(config.mHostName);
 
     // After this command the previous root FS is still mounted in /.oldroot
+    profile.begin("pivot-and-prep-root");
     PivotAndPrepRoot root(config);
     root.execute();
+    profile.end();
 
+    profile.begin("prep-guest-terminal");
     PrepGuestTerminal terminals(config.mTerminals);
     terminals.execute();
+    profile.end();
 
+    profile.begin("net-configure-all");
     NetConfigureAll network(config.mNetwork);
     network.execute();
+    profile.end();
 
+    profile.begin("init-environment");
     PrepCGroupSysFs cgroups(config);
     cgroups.execute();
 
@@ -140,6 +191,7 @@ void Guard::containerPrepInClone(ContainerConfig &config)
     // Remove /.oldroot only after all the commands have finished, they might've needed it
     lxcpp::umountSubtree(config.mOldRoot);
     utils::rmdir(config.mOldRoot);
+    profile.end();
 }
 
 void Guard::containerCleanup()
@@ -150,7 +202,12 @@ void Guard::containerCleanup()
 
         mEventPoll.removeFD(contFD);
         mEventPoll.removeFD(implFD);
+
+        if (!mTerminalLogs.empty()) {
+            reportDroppedOutput(i);
+        }
     }
+    mConsoleAttached.assign(mConsoleAttached.size(), false);
 
     Provisions provisions(*mConfig);
     provisions.revert();
@@ -166,6 +223,7 @@ int Guard::startContainer(void* data)
 {
     ContainerConfig& config = static_cast<ContainerData*>(data)->mConfig;
     utils::Channel& channel = static_cast<ContainerData*>(data)->mChannel;
+    const int netnsFD = static_cast<ContainerData*>(data)->mNetnsFD;
 
     // Brackets are here to call destructors before execv.
     {
@@ -177,9 +235,17 @@ int Guard::startContainer(void* data)
         utils::setgroups(std::vector<gid_t>());
         utils::setreuid(0, 0);
 
-        containerPrepInClone(config);
+        if (netnsFD >= 0) {
+            // Interfaces are already there, only their configuration is left
+            lxcpp::setnsFD(netnsFD, CLONE_NEWNET);
+            utils::close(netnsFD);
+        }
+
+        StartProfile profile;
+        containerPrepInClone(config, profile);
 
-        // Notify that Init's preparation is done
+        // Notify that Init's preparation is done, pass how long it took
+        cargo::saveToFD(channel.getFD(), profile);
         channel.write(true);
         channel.shutdown();
     }
@@ -190,9 +256,18 @@ int Guard::startContainer(void* data)
     return EXIT_FAILURE;
 }
 
-Guard::Guard(const std::string& socketPath)
-    : mSignalFD(mEventPoll)
+Guard::Guard(const std::string& socketPath, const int configFD)
+    : mSignalFD(mEventPoll),
+      mNetnsFD(-1)
 {
+    if (configFD >= 0) {
+        // The host passed the config at exec, it only has to start the container
+        utils::Channel channel(configFD);
+        auto config = std::make_shared<ContainerConfig>();
+        cargo::loadFromFD(channel.getFD(), *config);
+        setConfig(config);
+    }
+
     using namespace std::placeholders;
     mSignalFD.setHandler(SIGCHLD, std::bind(&Guard::onInitExit, this, _1));
 
@@ -212,12 +287,25 @@ Guard::Guard(const std::string& socketPath)
             std::bind(&Guard::onGetConfig, this, _1, _2, _3));
     mService->setMethodHandler<api::Void, api::Int>(api::METHOD_RESIZE_TERM,
             std::bind(&Guard::onResizeTerm, this, _1, _2, _3));
+    mService->setMethodHandler<api::Void, api::Netns>(api::METHOD_SET_NETNS,
+            std::bind(&Guard::onSetNetns, this, _1, _2, _3));
+    mService->setMethodHandler<api::String, api::TerminalLogRequest>(api::METHOD_GET_TERMINAL_LOG,
+            std::bind(&Guard::onGetTerminalLog, this, _1, _2, _3));
+    mService->setMethodHandler<StartProfile, api::Void>(api::METHOD_GET_START_PROFILE,
+            std::bind(&Guard::onGetStartProfile, this, _1, _2, _3));
+    mService->setMethodHandler<api::Pid, ContainerConfig>(api::METHOD_CONFIG_AND_START,
+            std::bind(&Guard::onConfigAndStart, this, _1, _2, _3));
+    mService->setMethodHandler<api::Void, api::Int>(api::METHOD_DETACH_TERMINAL,
+            std::bind(&Guard::onDetachTerminal, this, _1, _2, _3));
 
     mService->start();
 }
 
 Guard::~Guard()
 {
+    if (mNetnsFD >= 0) {
+        utils::close(mNetnsFD);
+    }
 }
 
 void Guard::onConnection(const cargo::ipc::PeerID& peerID, const cargo::ipc::FileDescriptor)
@@ -230,9 +318,9 @@ void Guard::onConnection(const cargo::ipc::PeerID& peerID, const cargo::ipc::Fil
     }
     mPeerID = peerID;
 
-    if (!mConfig) {
+    if (!mConfig || mConfig->mState == Container::State::STARTING) {
         // Host is connecting to a STOPPED container,
-        // it needs to s setup and start it
+        // it needs to s setup (unless the config came at exec) and start it
         mService->callAsyncFromCallback<api::Void, api::Void>(api::METHOD_GUARD_READY, mPeerID, std::shared_ptr<api::Void>());
     } else {
         // Host is connecting to a RUNNING container
@@ -249,6 +337,15 @@ void Guard::onDisconnection(const cargo::ipc::PeerID& peerID, const cargo::ipc::
         LOGE("Unknown peerID: " << cargo::ipc::shortenPeerID(peerID));
     }
     mPeerID.clear();
+
+    // Consoles of the host are gone with it
+    for (unsigned int i = 0; i < mConsoleAttached.size(); ++i) {
+        if (mConsoleAttached[i]) {
+            mConsoleAttached[i] = false;
+            mContToImpl[i].clear();
+            updateTerminalEvents(i);
+        }
+    }
 }
 
 void Guard::onInitExit(struct ::signalfd_siginfo& sigInfo)
@@ -270,23 +367,28 @@ void Guard::onInitExit(struct ::signalfd_siginfo& sigInfo)
     mService->stop(false);
 }
 
-cargo::ipc::HandlerExitCode Guard::onSetConfig(const cargo::ipc::PeerID,
-                                               std::shared_ptr<ContainerConfig>& data,
-                                               cargo::ipc::MethodResult::Pointer result)
+void Guard::setConfig(const std::shared_ptr<ContainerConfig>& config)
 {
-    LOGT("onSetConfig");
-
-    mConfig = data;
+    mConfig = config;
     mGuardPTYs.mCount = mConfig->mTerminals.mCount;
     mGuardPTYs.mUID = mConfig->mUserNSConfig.convContToHostUID(0);
     mGuardPTYs.mDevptsPath = utils::createFilePath(mConfig->mWorkPath,
                                                    mConfig->mName + ".devpts");
 
+    logger::setupLogger(mConfig->mLogger.mType,
+                        mConfig->mLogger.mLevel,
+                        mConfig->mLogger.mArg);
+    LOGD("Config & logging restored");
+}
+
+cargo::ipc::HandlerExitCode Guard::onSetConfig(const cargo::ipc::PeerID,
+                                               std::shared_ptr<ContainerConfig>& data,
+                                               cargo::ipc::MethodResult::Pointer result)
+{
+    LOGT("onSetConfig");
+
     try {
-        logger::setupLogger(mConfig->mLogger.mType,
-                            mConfig->mLogger.mLevel,
-                            mConfig->mLogger.mArg);
-        LOGD("Config & logging restored");
+        setConfig(data);
     }
     catch(const std::exception& e) {
         result->setError(api::GUARD_SET_CONFIG_ERROR, e.what());
@@ -307,17 +409,60 @@ cargo::ipc::HandlerExitCode Guard::onGetConfig(const cargo::ipc::PeerID,
     return cargo::ipc::HandlerExitCode::SUCCESS;
 }
 
+cargo::ipc::HandlerExitCode Guard::onSetNetns(const cargo::ipc::PeerID,
+                                               std::shared_ptr<api::Netns>& data,
+                                               cargo::ipc::MethodResult::Pointer result)
+{
+    LOGT("onSetNetns");
+
+    if (mNetnsFD >= 0) {
+        utils::close(mNetnsFD);
+    }
+    mNetnsFD = data->fd.value;
+
+    result->setVoid();
+    return cargo::ipc::HandlerExitCode::SUCCESS;
+}
+
 cargo::ipc::HandlerExitCode Guard::onStart(const cargo::ipc::PeerID,
                                            std::shared_ptr<api::Void>&,
                                            cargo::ipc::MethodResult::Pointer result)
 {
     LOGT("onStart");
 
+    // Configuration succeed, return the init's PID
+    result->set(std::make_shared<api::Pid>(startInit()));
+    return cargo::ipc::HandlerExitCode::SUCCESS;
+}
+
+cargo::ipc::HandlerExitCode Guard::onConfigAndStart(const cargo::ipc::PeerID,
+                                                    std::shared_ptr<ContainerConfig>& data,
+                                                    cargo::ipc::MethodResult::Pointer result)
+{
+    LOGT("onConfigAndStart");
+
+    try {
+        setConfig(data);
+    }
+    catch(const std::exception& e) {
+        result->setError(api::GUARD_SET_CONFIG_ERROR, e.what());
+        return cargo::ipc::HandlerExitCode::SUCCESS;
+    }
+
+    result->set(std::make_shared<api::Pid>(startInit()));
+    return cargo::ipc::HandlerExitCode::SUCCESS;
+}
+
+pid_t Guard::startInit()
+{
     utils::Channel channel;
-    ContainerData data(*mConfig, channel);
+    ContainerData data(*mConfig, channel, mNetnsFD);
 
     mConfig->mState = Container::State::STARTING;
 
+    // The host keeps its part of the profile, the config might carry a stale copy of it
+    mConfig->mStartProfile.clear();
+
     try {
         LOGD("Setting the guard process title");
         const std::string title = "[LXCPP] " + mConfig->mName + " " + mConfig->mRootPath;
@@ -329,26 +474,51 @@ cargo::ipc::HandlerExitCode Guard::onStart(const cargo::ipc::PeerID,
 
     containerPrepPreClone();
 
+    // Init joins the prepared network namespace instead of creating one
+    int namespaces = mConfig->mNamespaces;
+    if (mNetnsFD >= 0) {
+        namespaces &= ~CLONE_NEWNET;
+    }
+
+    mConfig->mStartProfile.begin("clone");
     mConfig->mInitPid = lxcpp::clone(startContainer,
                                      &data,
-                                     mConfig->mNamespaces);
+                                     namespaces);
+    mConfig->mStartProfile.end();
 
     containerPrepPostClone();
 
+    if (mNetnsFD >= 0) {
+        utils::close(mNetnsFD);
+        mNetnsFD = -1;
+    }
+
     // send continue sync to container once userns, netns, cgroups, etc, are configured
     channel.setLeft();
+    mConfig->mStartProfile.begin("init-prep");
     channel.write(true);
 
     // wait for continue sync from the container
+    StartProfile initProfile;
+    cargo::loadFromFD(channel.getFD(), initProfile);
     channel.read<bool>();
+    mConfig->mStartProfile.end();
+    mConfig->mStartProfile.append(initProfile);
     channel.shutdown();
 
     // Init started, change state
     mConfig->mState = Container::State::RUNNING;
 
-    // Configuration succeed, return the init's PID
-    auto ret = std::make_shared<api::Pid>(mConfig->mInitPid);
-    result->set(ret);
+    return mConfig->mInitPid;
+}
+
+cargo::ipc::HandlerExitCode Guard::onGetStartProfile(const cargo::ipc::PeerID,
+                                                     std::shared_ptr<api::Void>&,
+                                                     cargo::ipc::MethodResult::Pointer result)
+{
+    LOGT("onGetStartProfile");
+
+    result->set(std::make_shared<StartProfile>(mConfig->mStartProfile));
     return cargo::ipc::HandlerExitCode::SUCCESS;
 }
 
@@ -376,8 +546,8 @@ int Guard::execute()
         mEventPoll.dispatchIteration(-1);
     }
 
-    if (!mConfig) {
-        // Config wasn't set, nothing started, fail
+    if (!mConfig || mConfig->mState == Container::State::STARTING) {
+        // Init wasn't started, fail
         return EXIT_FAILURE;
     }
 
@@ -390,64 +560,87 @@ int Guard::execute()
 void Guard::onContTerminal(unsigned int i, int fd, cargo::ipc::epoll::Events events)
 {
     if ((events & EPOLLIN) == EPOLLIN) {
-        const size_t avail = IO_BUFFER_SIZE - mContToImplOffset[i];
-        char *buf = mContToImpl[i].data() + mContToImplOffset[i];
-
-        const ssize_t read = ::read(fd, buf, avail);
-
-        if (read > 0) {
-            mContToImplOffset[i] += read;
-
-            if (mContToImplOffset[i]) {
-                int oppositeFD = mImplSlaveFDs[i];
-                mEventPoll.modifyFD(oppositeFD, EPOLLOUT);
+        if (mTerminalLogs.empty()) {
+            mContToImpl[i].readFrom(fd);
+        } else {
+            char buffer[IO_BUFFER_SIZE];
+            std::size_t avail = sizeof(buffer);
+            if (mConsoleAttached[i]) {
+                // Don't take more than the console will get
+                avail = std::min(avail, IO_BUFFER_MAX_SIZE - mContToImpl[i].size());
+            }
+            const ssize_t len = avail ? TEMP_FAILURE_RETRY(::read(fd, buffer, avail)) : 0;
+            if (len > 0) {
+                mTerminalLogs[i]->append(buffer, len);
+            }
+            // Only a console gets the output, it replays the log when it attaches
+            if (len > 0 && mConsoleAttached[i]) {
+                const std::size_t stored = mContToImpl[i].push(buffer, len);
+                if (stored < static_cast<std::size_t>(len)) {
+                    mDroppedOutput[i] += len - stored;
+                } else if (mDroppedOutput[i] > 0) {
+                    reportDroppedOutput(i);
+                }
             }
         }
+        // Usually the other side can take the data at once, don't wait for EPOLLOUT
+        mContToImpl[i].writeTo(mImplSlaveFDs[i]);
     }
 
-    if ((events & EPOLLOUT) == EPOLLOUT && mImplToContOffset[i]) {
-        const ssize_t written = ::write(fd, mImplToCont[i].data(), mImplToContOffset[i]);
-
-        if (written > 0) {
-            ::memmove(mImplToCont[i].data(), mImplToCont[i].data() + written, mImplToContOffset[i] - written);
-            mImplToContOffset[i] -= written;
-
-            if (mImplToContOffset[i] == 0) {
-                mEventPoll.modifyFD(fd, EPOLLIN);
-            }
-        }
+    if ((events & EPOLLOUT) == EPOLLOUT) {
+        mImplToCont[i].writeTo(fd);
     }
+
+    updateTerminalEvents(i);
 }
 
 void Guard::onImplTerminal(unsigned int i, int fd, cargo::ipc::epoll::Events events)
 {
     if ((events & EPOLLIN) == EPOLLIN) {
-        const size_t avail = IO_BUFFER_SIZE - mImplToContOffset[i];
-        char *buf = mImplToCont[i].data() + mImplToContOffset[i];
+        mImplToCont[i].readFrom(fd);
+        mImplToCont[i].writeTo(mGuardPTYs.mPTYs[i].mMasterFD.value);
+    }
 
-        const ssize_t read = ::read(fd, buf, avail);
+    if ((events & EPOLLOUT) == EPOLLOUT) {
+        mContToImpl[i].writeTo(fd);
+    }
 
-        if (read > 0) {
-            mImplToContOffset[i] += read;
+    updateTerminalEvents(i);
+}
 
-            if (mImplToContOffset[i]) {
-                int oppositeFD = mGuardPTYs.mPTYs[i].mMasterFD.value;
-                mEventPoll.modifyFD(oppositeFD, EPOLLOUT);
-            }
-        }
+void Guard::updateTerminalEvents(unsigned int i)
+{
+    cargo::ipc::epoll::Events contEvents = 0;
+    cargo::ipc::epoll::Events implEvents = 0;
+    if ((!mTerminalLogs.empty() && !mConsoleAttached[i]) || !mContToImpl[i].full()) {
+        contEvents |= EPOLLIN;
+    }
+    if (!mImplToCont[i].empty()) {
+        contEvents |= EPOLLOUT;
+    }
+    if (!mImplToCont[i].full()) {
+        implEvents |= EPOLLIN;
+    }
+    if (!mContToImpl[i].empty()) {
+        implEvents |= EPOLLOUT;
     }
 
-    if ((events & EPOLLOUT) == EPOLLOUT && mContToImplOffset[i]) {
-        const ssize_t written = ::write(fd, mContToImpl[i].data(), mContToImplOffset[i]);
-
-        if (written > 0) {
-            ::memmove(mContToImpl[i].data(), mContToImpl[i].data() + written, mContToImplOffset[i] - written);
-            mContToImplOffset[i] -= written;
+    if (contEvents != mContEvents[i]) {
+        mEventPoll.modifyFD(mGuardPTYs.mPTYs[i].mMasterFD.value, contEvents);
+        mContEvents[i] = contEvents;
+    }
+    if (implEvents != mImplEvents[i]) {
+        mEventPoll.modifyFD(mImplSlaveFDs[i], implEvents);
+        mImplEvents[i] = implEvents;
+    }
+}
 
-            if (mContToImplOffset[i] == 0) {
-                mEventPoll.modifyFD(fd, EPOLLIN);
-            }
-        }
+void Guard::reportDroppedOutput(unsigned int i)
+{
+    if (mDroppedOutput[i] > 0) {
+        LOGW("Dropped " << mDroppedOutput[i] << " bytes of terminal " << i
+             << " output not taken by the host, it's in the terminal log");
+        mDroppedOutput[i] = 0;
     }
 }
 
@@ -466,5 +659,50 @@ cargo::ipc::HandlerExitCode Guard::onResizeTerm(const cargo::ipc::PeerID,
     return cargo::ipc::HandlerExitCode::SUCCESS;
 }
 
+cargo::ipc::HandlerExitCode Guard::onGetTerminalLog(const cargo::ipc::PeerID,
+                                                    std::shared_ptr<api::TerminalLogRequest> &data,
+                                                    cargo::ipc::MethodResult::Pointer result)
+{
+    LOGT("onGetTerminalLog");
+
+    const int i = data->terminal;
+    if (i < 0 || static_cast<unsigned>(i) >= mTerminalLogs.size()) {
+        const std::string msg = "No log for terminal: " + std::to_string(i);
+        LOGE(msg);
+        result->setError(api::GUARD_TERMINAL_ERROR, msg);
+        return cargo::ipc::HandlerExitCode::SUCCESS;
+    }
+
+    if (data->replay) {
+        // A console attaches, what the host didn't take is in the log
+        reportDroppedOutput(i);
+        mContToImpl[i].clear();
+        mConsoleAttached[i] = true;
+        updateTerminalEvents(i);
+    }
+
+    result->set(std::make_shared<api::String>(mTerminalLogs[i]->tail(data->size)));
+    return cargo::ipc::HandlerExitCode::SUCCESS;
+}
+
+cargo::ipc::HandlerExitCode Guard::onDetachTerminal(const cargo::ipc::PeerID,
+                                                    std::shared_ptr<api::Int> &data,
+                                                    cargo::ipc::MethodResult::Pointer result)
+{
+    LOGT("onDetachTerminal");
+
+    // Nothing is written to the PTY after the reply, so the console can drop
+    // what's left there, it's in the log
+    const int i = data->value;
+    if (i >= 0 && static_cast<unsigned>(i) < mConsoleAttached.size() && mConsoleAttached[i]) {
+        reportDroppedOutput(i);
+        mConsoleAttached[i] = false;
+        mContToImpl[i].clear();
+        updateTerminalEvents(i);
+    }
+
+    result->setVoid();
+    return cargo::ipc::HandlerExitCode::SUCCESS;
+}
 
 } // namespace lxcpp
@@ -26,6 +26,8 @@
 
 #include "lxcpp/container-config.hpp"
 #include "lxcpp/pty-config.hpp"
+#include "lxcpp/ring-buffer.hpp"
+#include "lxcpp/terminal-log.hpp"
 #include "lxcpp/guard/api.hpp"
 
 #include "utils/channel.hpp"
@@ -34,6 +36,9 @@
 #include "cargo-ipc/service.hpp"
 #include "cargo-ipc/epoll/event-poll.hpp"
 
+#include <memory>
+#include <vector>
+
 
 namespace lxcpp {
 
@@ -47,7 +52,11 @@ namespace lxcpp {
  */
 class Guard {
 public:
-    Guard(const std::string& socketPath);
+    /**
+     * @param socketPath path of the socket the host connects to
+     * @param configFD   channel the host writes the config to, -1 if the host sends it later
+     */
+    Guard(const std::string& socketPath, const int configFD = -1);
     ~Guard();
 
     int execute();
@@ -56,9 +65,10 @@ private:
     struct ContainerData {
         ContainerConfig &mConfig;
         utils::Channel &mChannel;
+        int mNetnsFD;
 
-        ContainerData(ContainerConfig &config, utils::Channel &channel)
-            : mConfig(config), mChannel(channel) {}
+        ContainerData(ContainerConfig &config, utils::Channel &channel, int netnsFD)
+            : mConfig(config), mChannel(channel), mNetnsFD(netnsFD) {}
     };
 
     cargo::ipc::epoll::EventPoll mEventPoll;
@@ -68,14 +78,24 @@ private:
 
     std::shared_ptr<ContainerConfig> mConfig;
 
+    // prepared network namespace joined by init instead of a new one, -1 if none
+    int mNetnsFD;
+
     std::vector<int> mImplSlaveFDs;
     PTYsConfig mGuardPTYs;
 
-    static const int IO_BUFFER_SIZE = 1024;
-    std::vector<std::array<char, IO_BUFFER_SIZE>> mContToImpl;
-    std::vector<std::array<char, IO_BUFFER_SIZE>> mImplToCont;
-    std::vector<int> mContToImplOffset;
-    std::vector<int> mImplToContOffset;
+    static const std::size_t IO_BUFFER_SIZE = 4096;
+    static const std::size_t IO_BUFFER_MAX_SIZE = 65536;
+    std::vector<RingBuffer> mContToImpl;
+    std::vector<RingBuffer> mImplToCont;
+    std::vector<cargo::ipc::epoll::Events> mContEvents;
+    std::vector<cargo::ipc::epoll::Events> mImplEvents;
+    // empty if terminal logs are disabled
+    std::vector<std::unique_ptr<TerminalLog>> mTerminalLogs;
+    // logged output is passed to the host only while a console shows the terminal
+    std::vector<bool> mConsoleAttached;
+    // logged output not passed to the host since the last warning
+    std::vector<std::size_t> mDroppedOutput;
 
     /**
      * Container preparation part 1.
@@ -103,8 +123,9 @@ private:
      * Things to do inside the container's process.
      *
      * @param config  container's config
+     * @param profile timing of the preparation steps
      */
-    static void containerPrepInClone(ContainerConfig &config);
+    static void containerPrepInClone(ContainerConfig &config, StartProfile &profile);
 
     /**
      * Container cleanup.
@@ -115,6 +136,18 @@ private:
      */
     void containerCleanup();
 
+    /**
+     * Use the host's config and restore logging with it.
+     */
+    void setConfig(const std::shared_ptr<ContainerConfig>& config);
+
+    /**
+     * Prepare the container, clone its init and wait until it's set up.
+     *
+     * @return init's PID
+     */
+    pid_t startInit();
+
     /**
      * Setups the init process and executes the init.
      */
@@ -162,6 +195,14 @@ private:
                                             std::shared_ptr<api::Void>&,
                                             cargo::ipc::MethodResult::Pointer result);
 
+    /**
+     * Host -> Guard: Use the prepared network namespace for the container.
+     * Interfaces of the configuration have to exist in it already.
+     */
+    cargo::ipc::HandlerExitCode onSetNetns(const cargo::ipc::PeerID,
+                                           std::shared_ptr<api::Netns>& data,
+                                           cargo::ipc::MethodResult::Pointer result);
+
     /**
      * Host -> Guard: Start init in a container described by the configuration
      */
@@ -169,6 +210,20 @@ private:
                                         std::shared_ptr<api::Void>&,
                                         cargo::ipc::MethodResult::Pointer result);
 
+    /**
+     * Host -> Guard: Set the configuration and start init with one call
+     */
+    cargo::ipc::HandlerExitCode onConfigAndStart(const cargo::ipc::PeerID,
+                                                 std::shared_ptr<ContainerConfig>& data,
+                                                 cargo::ipc::MethodResult::Pointer result);
+
+    /**
+     * Host -> Guard: Return the timing of the last start
+     */
+    cargo::ipc::HandlerExitCode onGetStartProfile(const cargo::ipc::PeerID,
+                                                  std::shared_ptr<api::Void>&,
+                                                  cargo::ipc::MethodResult::Pointer result);
+
     /**
      * Host -> Guard: Stop the init process and return its exit status.
      * Returns the status asynchronously (outside onStop), when init dies.
@@ -181,6 +236,22 @@ private:
                                              std::shared_ptr<api::Int> &data,
                                              cargo::ipc::MethodResult::Pointer result);
 
+    /**
+     * Host -> Guard: Return the end of the terminal's log.
+     * On replay the output waiting for the host is dropped, as the log contains it.
+     */
+    cargo::ipc::HandlerExitCode onGetTerminalLog(const cargo::ipc::PeerID,
+                                                 std::shared_ptr<api::TerminalLogRequest> &data,
+                                                 cargo::ipc::MethodResult::Pointer result);
+
+    /**
+     * Host -> Guard: The console stopped showing the terminal.
+     * It's attached again by the next replay of the terminal's log.
+     */
+    cargo::ipc::HandlerExitCode onDetachTerminal(const cargo::ipc::PeerID,
+                                                 std::shared_ptr<api::Int> &data,
+                                                 cargo::ipc::MethodResult::Pointer result);
+
     /**
      * A callback for container terminal PTY master
      */
@@ -190,6 +261,19 @@ private:
      * A callback for implementation (container-impl.cpp) terminal PTY slave
      */
     void onImplTerminal(unsigned int i, int fd, cargo::ipc::epoll::Events events);
+
+    /**
+     * Watch the terminal's descriptors only for the events the relay can handle:
+     * input while there's space in the buffer, output while there's data to write.
+     * Logged terminal output is always read unless a console is attached,
+     * so the container waits only for a user who watches it.
+     */
+    void updateTerminalEvents(unsigned int i);
+
+    /**
+     * Warn about the logged output the host didn't take
+     */
+    void reportDroppedOutput(unsigned int i);
 };
 
 } // namespace lxcpp
@@ -24,6 +24,7 @@
 #include "config.hpp"
 
 #include "lxcpp/guard/guard.hpp"
+#include "lxcpp/guard/zygote-server.hpp"
 
 #include "utils/fd-utils.hpp"
 #include "utils/typeinfo.hpp"
@@ -51,7 +52,13 @@ int main(int argc, char *argv[])
 #endif
 
     try {
-        lxcpp::Guard guard(argv[1]);
+        if (argc == 4 && argv[1] == lxcpp::api::GUARD_ZYGOTE_OPTION) {
+            lxcpp::ZygoteServer zygote(argv[2], std::stoi(argv[3]));
+            return zygote.execute();
+        }
+
+        const int configFD = argc > 4 ? std::stoi(argv[4]) : -1;
+        lxcpp::Guard guard(argv[1], configFD);
         return guard.execute();
     } catch(std::exception& e) {
         LOGE("Unexpected: " << utils::getTypeName(e) << ": " << e.what());
@@ -0,0 +1,188 @@
+/*
+ *  Copyright (C) 2015 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License version 2.1 as published by the Free Software Foundation.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+/**
+ * @file
+ * @author  agent (agent@local)
+ * @brief   Guard zygote implementation
+ */
+
+#include "config.hpp"
+
+#include "lxcpp/guard/zygote-server.hpp"
+#include "lxcpp/guard/guard.hpp"
+#include "lxcpp/exception.hpp"
+#include "lxcpp/process.hpp"
+#include "lxcpp/utils.hpp"
+
+#include "cargo-fd/cargo-fd.hpp"
+#include "logger/logger.hpp"
+#include "utils/channel.hpp"
+#include "utils/exception.hpp"
+#include "utils/fd-utils.hpp"
+#include "utils/signal.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+namespace lxcpp {
+
+ZygoteServer::ZygoteServer(const std::string& socketPath, const int channelFD)
+    : mSocketPath(socketPath),
+      mSocketFD(-1)
+{
+    // Guards are reaped automatically, they report init's exit to the host by themselves
+    mSignalStates = utils::signalIgnore({SIGCHLD});
+
+    ::sockaddr_un addr;
+    ::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (socketPath.size() >= sizeof(addr.sun_path)) {
+        const std::string msg = "Zygote's socket path is too long: " + socketPath;
+        LOGE(msg);
+        throw ProcessSetupException(msg);
+    }
+    ::strncpy(addr.sun_path, socketPath.c_str(), sizeof(addr.sun_path) - 1);
+
+    mSocketFD = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (mSocketFD < 0) {
+        const std::string msg = "socket() failed: " + utils::getSystemErrorMessage();
+        LOGE(msg);
+        throw ProcessSetupException(msg);
+    }
+
+    ::unlink(socketPath.c_str());
+    // Only the owner can connect, the socket is created with 0600 mode
+    const ::mode_t mask = ::umask(S_IRWXG | S_IRWXO | S_IXUSR);
+    const int ret = ::bind(mSocketFD, reinterpret_cast<::sockaddr*>(&addr), sizeof(addr));
+    ::umask(mask);
+    if (ret < 0 || ::listen(mSocketFD, SOMAXCONN) < 0) {
+        const std::string msg = "Can't listen on the zygote's socket: " + utils::getSystemErrorMessage();
+        utils::close(mSocketFD);
+        LOGE(msg);
+        throw ProcessSetupException(msg);
+    }
+
+    // Notify the host that requests can be sent
+    utils::Channel channel(channelFD);
+    channel.write(true);
+    channel.shutdown();
+}
+
+ZygoteServer::~ZygoteServer()
+{
+    utils::close(mSocketFD);
+    ::unlink(mSocketPath.c_str());
+}
+
+int ZygoteServer::execute()
+{
+    while (true) {
+        const int fd = ::accept4(mSocketFD, nullptr, nullptr, SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+            LOGE("accept() failed: " << utils::getSystemErrorMessage());
+            return EXIT_FAILURE;
+        }
+
+        try {
+            checkPeer(fd);
+            onRequest(fd);
+        } catch (const std::exception& e) {
+            // The host sees the connection closed without an answer
+            LOGE("Failed to fork a guard: " << e.what());
+        }
+        utils::close(fd);
+    }
+}
+
+void ZygoteServer::checkPeer(const int fd)
+{
+    ::ucred cred;
+    ::socklen_t len = sizeof(cred);
+    if (::getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &cred, &len) < 0) {
+        const std::string msg = "Can't get the peer's credentials: " + utils::getSystemErrorMessage();
+        LOGE(msg);
+        throw ProcessSetupException(msg);
+    }
+
+    // Guards run with the zygote's privileges, only its user can request them
+    if (cred.uid != ::geteuid()) {
+        const std::string msg = "Request from an unauthorized user: " + std::to_string(cred.uid);
+        LOGE(msg);
+        throw ProcessSetupException(msg);
+    }
+}
+
+void ZygoteServer::onRequest(const int fd)
+{
+    api::ZygoteRequest request;
+    cargo::loadFromFD(fd, request);
+
+    const pid_t pid = lxcpp::fork();
+    if (pid == 0) {
+        ::_exit(runGuard(request, fd));
+    }
+
+    LOGD("Forking a guard for: " << request.name);
+}
+
+int ZygoteServer::runGuard(const api::ZygoteRequest& request, const int fd)
+{
+    try {
+        utils::close(mSocketFD);
+
+        // From now on it's like a guard started by the host:
+        // default signal handling and daemonized the same way
+        for (const auto& sigInfo : mSignalStates) {
+            utils::signalSet(sigInfo.first, &sigInfo.second);
+        }
+        if (lxcpp::daemonize() < 0) {
+            const std::string msg = "Failed to daemonize the guard: " + utils::getSystemErrorMessage();
+            LOGE(msg);
+            return EXIT_FAILURE;
+        }
+
+        try {
+            setProcTitle("[LXCPP] " + request.name + " " + request.rootPath);
+        } catch (std::exception &e) {
+            // Ignore, this is optional
+            LOGW("Failed to set the guard process title: " << e.what());
+        }
+
+        Guard guard(request.socketPath);
+
+        // Guard's socket is listening, the host can connect
+        const pid_t pid = ::getpid();
+        utils::write(fd, &pid, sizeof(pid));
+        utils::close(fd);
+
+        return guard.execute();
+    } catch (const std::exception& e) {
+        LOGE("Guard failed: " << e.what());
+        return EXIT_FAILURE;
+    }
+}
+
+} // namespace lxcpp
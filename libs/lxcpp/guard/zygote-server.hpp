@@ -0,0 +1,72 @@
+/*
+ *  Copyright (C) 2015 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License version 2.1 as published by the Free Software Foundation.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+/**
+ * @file
+ * @author  agent (agent@local)
+ * @brief   Guard zygote, forks guards without executing the guard binary
+ */
+
+#ifndef LXCPP_GUARD_ZYGOTE_SERVER_HPP
+#define LXCPP_GUARD_ZYGOTE_SERVER_HPP
+
+#include "lxcpp/guard/api.hpp"
+
+#include <signal.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+
+namespace lxcpp {
+
+/**
+ * Long-lived guard process which forks ready guards on request.
+ *
+ * A forked guard skips the fork, daemonize, exec and dynamic linking
+ * of a guard started by the host. Requests come over a unix socket,
+ * one per connection, only from the zygote's user. The guard answers
+ * with its PID when its IPC socket is listening.
+ *
+ * The zygote is one thread process without a polling loop,
+ * so it's safe to fork at any time.
+ */
+class ZygoteServer {
+public:
+    /**
+     * @param socketPath path of the socket the zygote listens on
+     * @param channelFD channel the host waits for the zygote to be ready on
+     */
+    ZygoteServer(const std::string& socketPath, const int channelFD);
+    ~ZygoteServer();
+
+    int execute();
+
+private:
+    std::string mSocketPath;
+    int mSocketFD;
+    std::vector<std::pair<int, struct ::sigaction>> mSignalStates;
+
+    void checkPeer(const int fd);
+    void onRequest(const int fd);
+    int runGuard(const api::ZygoteRequest& request, const int fd);
+};
+
+} // namespace lxcpp
+
+#endif // LXCPP_GUARD_ZYGOTE_SERVER_HPP
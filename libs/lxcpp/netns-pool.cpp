@@ -0,0 +1,190 @@
+/*
+ *  Copyright (C) 2015 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License version 2.1 as published by the Free Software Foundation.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/**
+ * @file
+ * @author  agent (agent@local)
+ * @brief   Pool of prepared network namespaces
+ */
+
+#include "config.hpp"
+
+#include "lxcpp/netns-pool.hpp"
+#include "lxcpp/namespace.hpp"
+#include "lxcpp/process.hpp"
+#include "lxcpp/commands/netcreate.hpp"
+
+#include "logger/logger.hpp"
+#include "utils/fd-utils.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <fcntl.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+namespace lxcpp {
+
+namespace {
+
+// time to wait before the next try when a namespace couldn't be prepared
+const std::chrono::seconds RETRY_DELAY(1);
+
+// host side interfaces of all pools get distinct names
+std::atomic<unsigned int> gNamespaceCounter(0);
+
+std::string getThreadNetnsPath()
+{
+    return getPath(static_cast<pid_t>(::syscall(SYS_gettid)), CLONE_NEWNET);
+}
+
+bool isSameLayout(const NetworkInterfaceConfig& a, const NetworkInterfaceConfig& b)
+{
+    const LinkOptions& ao = a.getLinkOptions();
+    const LinkOptions& bo = b.getLinkOptions();
+    return a.getType() == b.getType() &&
+           a.getHostIf() == b.getHostIf() &&
+           a.getZoneIf() == b.getZoneIf() &&
+           ao.numTxQueues == bo.numTxQueues &&
+           ao.numRxQueues == bo.numRxQueues &&
+           ao.gsoMaxSize == bo.gsoMaxSize &&
+           ao.gsoMaxSegs == bo.gsoMaxSegs &&
+           ao.groMaxSize == bo.groMaxSize &&
+           ao.txQueueLen == bo.txQueueLen;
+}
+
+} // namespace
+
+NetnsPool::NetnsPool(const NetworkConfig& network, unsigned int size)
+    : mNetwork(network),
+      mSize(size),
+      mStop(false)
+{
+    mThread = std::thread(&NetnsPool::run, this);
+}
+
+NetnsPool::~NetnsPool()
+{
+    {
+        Lock lock(mMutex);
+        mStop = true;
+    }
+    mCondition.notify_one();
+    mThread.join();
+
+    // interfaces are removed together with the namespaces
+    for (const int fd : mReady) {
+        utils::close(fd);
+    }
+}
+
+bool NetnsPool::isCompatible(const NetworkConfig& network) const
+{
+    const auto& ours = mNetwork.getInterfaces();
+    const auto& theirs = network.getInterfaces();
+    if (ours.size() != theirs.size()) {
+        return false;
+    }
+    for (std::size_t i = 0; i < ours.size(); ++i) {
+        if (!isSameLayout(ours[i], theirs[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int NetnsPool::acquire()
+{
+    Lock lock(mMutex);
+    if (mReady.empty()) {
+        LOGD("No prepared network namespace");
+        return -1;
+    }
+    const int fd = mReady.front();
+    mReady.pop_front();
+    mCondition.notify_one();
+    return fd;
+}
+
+unsigned int NetnsPool::size() const
+{
+    Lock lock(mMutex);
+    return mReady.size();
+}
+
+void NetnsPool::run()
+{
+    int hostFD;
+    try {
+        hostFD = utils::open(getThreadNetnsPath(), O_RDONLY | O_CLOEXEC);
+    } catch (const std::exception& e) {
+        LOGE("Network namespace pool disabled: " << e.what());
+        return;
+    }
+
+    Lock lock(mMutex);
+    while (!mStop) {
+        if (mReady.size() >= mSize) {
+            mCondition.wait(lock);
+            continue;
+        }
+
+        lock.unlock();
+        int fd = -1;
+        try {
+            fd = prepare(hostFD);
+        } catch (const std::exception& e) {
+            LOGE("Failed to prepare network namespace: " << e.what());
+        }
+        lock.lock();
+
+        if (fd < 0) {
+            mCondition.wait_for(lock, RETRY_DELAY);
+            continue;
+        }
+        mReady.push_back(fd);
+    }
+
+    utils::close(hostFD);
+}
+
+int NetnsPool::prepare(int hostFD)
+{
+    // only this thread changes the namespace, the rest of the process stays in the host one
+    lxcpp::unshare(CLONE_NEWNET);
+    int netnsFD = -1;
+    try {
+        netnsFD = utils::open(getThreadNetnsPath(), O_RDONLY | O_CLOEXEC);
+    } catch (...) {
+        lxcpp::setnsFD(hostFD, CLONE_NEWNET);
+        throw;
+    }
+    lxcpp::setnsFD(hostFD, CLONE_NEWNET);
+
+    try {
+        NetCreateAll network(mNetwork, netnsFD, "-np" + std::to_string(gNamespaceCounter++));
+        network.execute();
+    } catch (...) {
+        utils::close(netnsFD);
+        throw;
+    }
+    LOGD("Network namespace prepared");
+    return netnsFD;
+}
+
+} // namespace lxcpp
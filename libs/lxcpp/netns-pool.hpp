@@ -0,0 +1,98 @@
+/*
+ *  Copyright (C) 2015 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License version 2.1 as published by the Free Software Foundation.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/**
+ * @file
+ * @author  agent (agent@local)
+ * @brief   Pool of prepared network namespaces
+ */
+
+#ifndef LXCPP_NETNS_POOL_HPP
+#define LXCPP_NETNS_POOL_HPP
+
+#include "lxcpp/network-config.hpp"
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace lxcpp {
+
+/**
+ * NetnsPool keeps network namespaces with the interfaces of a network
+ * configuration already created and attached to their bridges.
+ *
+ * A container started with a namespace from the pool joins it instead of
+ * creating a new one, so it doesn't wait for the interfaces. Only the layout
+ * of the configuration is prepared, addresses and attributes of the zone
+ * interfaces are still set when the container starts.
+ *
+ * Namespaces are made by a background thread which refills the pool
+ * after each acquire. The pool lives in the host process, it has to be
+ * run with the privileges needed to create network namespaces.
+ */
+class NetnsPool {
+public:
+    /**
+     * @param network configuration which interfaces are prepared
+     * @param size number of namespaces kept ready
+     */
+    NetnsPool(const NetworkConfig& network, unsigned int size);
+    ~NetnsPool();
+
+    NetnsPool(const NetnsPool&) = delete;
+    NetnsPool& operator=(const NetnsPool&) = delete;
+
+    /**
+     * Check if namespaces of the pool can be used for the configuration,
+     * i.e. it has the same interfaces. Addresses don't matter, they are
+     * added when the container starts.
+     */
+    bool isCompatible(const NetworkConfig& network) const;
+
+    /**
+     * Take a prepared network namespace out of the pool
+     *
+     * @return descriptor of the namespace owned by the caller,
+     *         -1 if no namespace is ready
+     */
+    int acquire();
+
+    /**
+     * Number of namespaces ready to be acquired
+     */
+    unsigned int size() const;
+
+private:
+    typedef std::unique_lock<std::mutex> Lock;
+
+    const NetworkConfig mNetwork;
+    const unsigned int mSize;
+    mutable std::mutex mMutex;
+    std::condition_variable mCondition;
+    std::deque<int> mReady;
+    bool mStop;
+    std::thread mThread;
+
+    void run();
+    int prepare(int hostFD);
+};
+
+} // namespace lxcpp
+
+#endif // LXCPP_NETNS_POOL_HPP
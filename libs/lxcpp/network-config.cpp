@@ -81,6 +81,16 @@ int NetworkInterfaceConfig::getTxLength() const
     return mTxLength;
 }
 
+void NetworkInterfaceConfig::setLinkOptions(const LinkOptions& options)
+{
+    mLinkOptions = options;
+}
+
+const LinkOptions& NetworkInterfaceConfig::getLinkOptions() const
+{
+    return mLinkOptions;
+}
+
 const std::vector<InetAddr>& NetworkInterfaceConfig::getAddrList() const
 {
     return mIpAddrList;
@@ -132,4 +142,20 @@ void NetworkConfig::addInetConfig(const std::string& ifname, const InetAddr& add
     it->addInetAddr(addr);
 }
 
+void NetworkConfig::setLinkOptionsConfig(const std::string& ifname, const LinkOptions& options)
+{
+    auto it = std::find_if(mInterfaces.begin(), mInterfaces.end(),
+        [&ifname](const NetworkInterfaceConfig& entry) {
+            return entry.getZoneIf() == ifname;
+        }
+    );
+
+    if (it == mInterfaces.end()) {
+        const std::string msg = "No such interface";
+        LOGE(msg);
+        throw NetworkException(msg);
+    }
+    it->setLinkOptions(options);
+}
+
 } //namespace lxcpp
@@ -40,7 +40,9 @@ namespace lxcpp {
 enum class InterfaceConfigType : int {
     LOOPBACK,
     BRIDGE,
-    VETH_BRIDGED
+    VETH_BRIDGED,
+    IPVLAN_L2,  // ipvlan on host interface, no bridge between host and zone
+    IPVLAN_L3
 };
 
 /**
@@ -62,6 +64,7 @@ public:
         mMtu(0),
         mMacAddress(),
         mTxLength(0),
+        mLinkOptions(),
         mIpAddrList(addrs)
     {
     }
@@ -83,6 +86,9 @@ public:
     void setTxLength(int txlen);
     int getTxLength() const;
 
+    void setLinkOptions(const LinkOptions& options);
+    const LinkOptions& getLinkOptions() const;
+
     const std::vector<InetAddr>& getAddrList() const;
 
     void addInetAddr(const InetAddr& addr);
@@ -93,6 +99,7 @@ public:
         mZoneIf,
         mType,
         mMode,
+        mLinkOptions,
         mIpAddrList
     )
 
@@ -115,6 +122,9 @@ private:
     std::string mMacAddress;
     int mTxLength;
 
+    // queues and offload limits, set when the interface is created
+    LinkOptions mLinkOptions;
+
     std::vector<InetAddr> mIpAddrList;
 };
 
@@ -133,6 +143,7 @@ public:
                             const std::vector<InetAddr>& addrs = std::vector<InetAddr>(),
                             MacVLanMode mode = MacVLanMode::PRIVATE);
     void addInetConfig(const std::string& ifname, const InetAddr& addr);
+    void setLinkOptionsConfig(const std::string& ifname, const LinkOptions& options);
 
     const std::vector<NetworkInterfaceConfig>& getInterfaces() const { return mInterfaces; }
     const NetworkInterfaceConfig& getInterface(int i) const { return mInterfaces.at(i); }
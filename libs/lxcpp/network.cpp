@@ -26,15 +26,20 @@
 #include "lxcpp/network.hpp"
 #include "lxcpp/container.hpp"
 #include "lxcpp/exception.hpp"
+#include "lxcpp/process.hpp"
 #include "netlink/netlink-message.hpp"
 #include "utils/make-clean.hpp"
 #include "utils/text.hpp"
 #include "utils/exception.hpp"
 #include "logger/logger.hpp"
 
+#include <exception>
 #include <iostream>
+#include <thread>
 
+#include <sched.h>
 #include <unistd.h>
+#include <sys/syscall.h>
 #include <net/if.h>
 #include <sys/ioctl.h>
 #include <linux/rtnetlink.h>
@@ -57,6 +62,15 @@
 #define IFA_FLAGS IFA_UNSPEC
 #endif
 
+//IFLA_GRO_MAX_SIZE should be defined in linux/if_link.h since kernel v5.19
+#ifndef IFLA_GRO_MAX_SIZE
+#define IFLA_GRO_MAX_SIZE 58
+#endif
+//IPVLAN_MODE_L3S should be defined in linux/if_link.h since kernel v4.9
+#ifndef IPVLAN_MODE_L3S
+#define IPVLAN_MODE_L3S 2
+#endif
+
 using namespace vasum::netlink;
 
 namespace lxcpp {
@@ -105,7 +119,145 @@ uint32_t getInterfaceIndex(pid_t pid, const std::string& name)
     return info.ifi_index;
 }
 
-void bridgeModify(pid_t pid, const std::string& ifname, uint32_t masterIndex) {
+void putLinkOptions(NetlinkMessage& nlm, const LinkOptions& options)
+{
+    if (options.numTxQueues > 0) {
+        nlm.put<uint32_t>(IFLA_NUM_TX_QUEUES, options.numTxQueues);
+    }
+    if (options.numRxQueues > 0) {
+        nlm.put<uint32_t>(IFLA_NUM_RX_QUEUES, options.numRxQueues);
+    }
+    if (options.gsoMaxSize > 0) {
+        nlm.put<uint32_t>(IFLA_GSO_MAX_SIZE, options.gsoMaxSize);
+    }
+    if (options.gsoMaxSegs > 0) {
+        nlm.put<uint32_t>(IFLA_GSO_MAX_SEGS, options.gsoMaxSegs);
+    }
+    if (options.groMaxSize > 0) {
+        nlm.put<uint32_t>(IFLA_GRO_MAX_SIZE, options.groMaxSize);
+    }
+    if (options.txQueueLen > 0) {
+        nlm.put<uint32_t>(IFLA_TXQLEN, options.txQueueLen);
+    }
+}
+
+uint16_t toIPVLanMode(IPVLanMode mode)
+{
+    switch (mode) {
+        case IPVLanMode::L2:
+            return IPVLAN_MODE_L2;
+        case IPVLanMode::L3:
+            return IPVLAN_MODE_L3;
+        case IPVLanMode::L3S:
+            return IPVLAN_MODE_L3S;
+        default:
+            throw NetworkException("Unsupported ipvlan mode");
+    }
+}
+
+NetlinkMessage bridgeMessage(const std::string& ifname)
+{
+    NetlinkMessage nlm(RTM_NEWLINK, NLM_F_REQUEST | NLM_F_CREATE | NLM_F_EXCL | NLM_F_ACK);
+    ifinfomsg info = utils::make_clean<ifinfomsg>();
+    info.ifi_family = AF_UNSPEC;
+    info.ifi_change = CHANGE_FLAGS_DEFAULT;
+    nlm.put(info)
+        .beginNested(IFLA_LINKINFO)
+            .put(IFLA_INFO_KIND, "bridge")
+            .beginNested(IFLA_INFO_DATA)
+                .beginNested(IFLA_AF_SPEC)
+                    .put<uint32_t>(IFLA_BRIDGE_FLAGS, BRIDGE_FLAGS_MASTER)
+                .endNested()
+            .endNested()
+        .endNested()
+        .put(IFLA_IFNAME, ifname); //bridge name (will be created)
+    return nlm;
+}
+
+/*
+ * pid     - process in the target network namespace (0 if not given by a process)
+ * netnsFD - descriptor of the target network namespace (-1 if not given by a descriptor)
+ */
+void putNetns(NetlinkMessage& nlm, pid_t pid, int netnsFD)
+{
+    if (pid) {
+        nlm.put(IFLA_NET_NS_PID, pid);
+    } else if (netnsFD >= 0) {
+        nlm.put(IFLA_NET_NS_FD, static_cast<uint32_t>(netnsFD));
+    }
+}
+
+/*
+ * masterIndex - bridge the interface is added to and brought up in (0 for none)
+ * peerPid     - process in network namespace the peer is created in (0 for the same one)
+ * peerNetnsFD - network namespace the peer is created in, used when peerPid is 0
+ */
+NetlinkMessage vethMessage(const std::string& ifname,
+                           const std::string& peerif,
+                           const LinkOptions& options,
+                           uint32_t masterIndex = 0,
+                           pid_t peerPid = 0,
+                           int peerNetnsFD = -1)
+{
+    NetlinkMessage nlm(RTM_NEWLINK, NLM_F_REQUEST | NLM_F_CREATE | NLM_F_EXCL | NLM_F_ACK);
+    ifinfomsg info = utils::make_clean<ifinfomsg>();
+    info.ifi_family = AF_UNSPEC;
+    info.ifi_change = CHANGE_FLAGS_DEFAULT;
+    ifinfomsg peerInfo = info;
+    if (masterIndex) {
+        info.ifi_flags = IFF_UP;
+    }
+    nlm.put(info)
+        .put(IFLA_IFNAME, ifname);
+    if (masterIndex) {
+        nlm.put(IFLA_MASTER, masterIndex);
+    }
+    putLinkOptions(nlm, options);
+    nlm.beginNested(IFLA_LINKINFO)
+        .put(IFLA_INFO_KIND, "veth")
+        .beginNested(IFLA_INFO_DATA)
+            .beginNested(VETH_INFO_PEER)
+                .put(peerInfo)
+                .put(IFLA_IFNAME, peerif);
+    putNetns(nlm, peerPid, peerNetnsFD);
+    // the peer doesn't inherit the options, it would be single-queue
+    putLinkOptions(nlm, options);
+    nlm.endNested()   // VETH_INFO_PEER
+        .endNested()  // IFLA_INFO_DATA
+        .endNested(); // IFLA_LINKINFO
+    return nlm;
+}
+
+/*
+ * nsPid   - process in network namespace the interface is created in (0 for the master's one)
+ * netnsFD - network namespace the interface is created in, used when nsPid is 0
+ */
+NetlinkMessage ipvlanMessage(const std::string& ifname,
+                             uint32_t masterIndex,
+                             IPVLanMode mode,
+                             const LinkOptions& options,
+                             pid_t nsPid = 0,
+                             int netnsFD = -1)
+{
+    NetlinkMessage nlm(RTM_NEWLINK, NLM_F_REQUEST | NLM_F_CREATE | NLM_F_EXCL | NLM_F_ACK);
+    ifinfomsg info = utils::make_clean<ifinfomsg>();
+    info.ifi_family = AF_UNSPEC;
+    info.ifi_change = CHANGE_FLAGS_DEFAULT;
+    nlm.put(info)
+        .beginNested(IFLA_LINKINFO)
+            .put(IFLA_INFO_KIND, "ipvlan")
+            .beginNested(IFLA_INFO_DATA)
+                .put(IFLA_IPVLAN_MODE, toIPVLanMode(mode))
+            .endNested()
+        .endNested()
+        .put(IFLA_LINK, masterIndex) //master index
+        .put(IFLA_IFNAME, ifname);   //slave name (will be created)
+    putNetns(nlm, nsPid, netnsFD);
+    putLinkOptions(nlm, options);
+    return nlm;
+}
+
+NetlinkMessage bridgeModifyMessage(const std::string& ifname, uint32_t masterIndex) {
     NetlinkMessage nlm(RTM_SETLINK, NLM_F_REQUEST | NLM_F_ACK);
     ifinfomsg info = utils::make_clean<ifinfomsg>();
     info.ifi_family = AF_UNSPEC;
@@ -113,7 +265,31 @@ void bridgeModify(pid_t pid, const std::string& ifname, uint32_t masterIndex) {
     info.ifi_index = getInterfaceIndex(ifname);
     nlm.put(info)
         .put(IFLA_MASTER, masterIndex);
-    send(nlm, pid);
+    return nlm;
+}
+
+void bridgeModify(pid_t pid, const std::string& ifname, uint32_t masterIndex) {
+    send(bridgeModifyMessage(ifname, masterIndex), pid);
+}
+
+NetlinkMessage inetAddrMessage(uint16_t type, uint16_t flags, uint32_t index, const InetAddr& addr)
+{
+    NetlinkMessage nlm(type, flags);
+    ifaddrmsg infoAddr = utils::make_clean<ifaddrmsg>();
+    infoAddr.ifa_index = index;
+    infoAddr.ifa_family = addr.type == InetAddrType::IPV4 ? AF_INET : AF_INET6;
+    infoAddr.ifa_prefixlen = addr.prefix;
+    infoAddr.ifa_flags = addr.flags;
+    nlm.put(infoAddr);
+
+    if (addr.type == InetAddrType::IPV6) {
+        nlm.put(IFA_ADDRESS, addr.getAddr<in6_addr>());
+        nlm.put(IFA_LOCAL, addr.getAddr<in6_addr>());
+    } else if (addr.type == InetAddrType::IPV4) {
+        nlm.put(IFA_ADDRESS, addr.getAddr<in_addr>());
+        nlm.put(IFA_LOCAL, addr.getAddr<in_addr>());
+    }
+    return nlm;
 }
 
 void getAddressList(pid_t pid, std::vector<InetAddr>& addrs, int family, const std::string& ifname)
@@ -122,7 +298,9 @@ void getAddressList(pid_t pid, std::vector<InetAddr>& addrs, int family, const s
     NetlinkMessage nlm(RTM_GETADDR, NLM_F_REQUEST | NLM_F_ACK | NLM_F_DUMP);
     ifaddrmsg infoAddr = utils::make_clean<ifaddrmsg>();
     infoAddr.ifa_family = family; //test AF_PACKET to get all AF_INET* ?
-    nlm.put(infoAddr);
+    infoAddr.ifa_index = index;
+    nlm.put(infoAddr)
+        .setStrictCheck();
 
     NetlinkResponse response = send(nlm, pid);
     while (response.hasMessage()) {
@@ -293,63 +471,38 @@ InetAddr::InetAddr(const std::string& a, unsigned p, uint32_t f) :
 
 void NetworkInterface::create(InterfaceType type,
                               const std::string& peerif,
-                              MacVLanMode mode)
+                              MacVLanMode mode,
+                              const LinkOptions& options)
 {
     switch (type) {
         case InterfaceType::VETH:
-            createVeth(peerif);
+            createVeth(peerif, options);
             break;
         case InterfaceType::BRIDGE:
             createBridge();
             break;
         case InterfaceType::MACVLAN:
-            createMacVLan(peerif, mode);
+            createMacVLan(peerif, mode, options);
+            break;
+        case InterfaceType::IPVLAN:
+            createIPVLan(peerif, IPVLanMode::L2, options);
             break;
         default:
             throw NetworkException("Unsupported interface type");
     }
 }
 
-void NetworkInterface::createVeth(const std::string& peerif)
+void NetworkInterface::createVeth(const std::string& peerif, const LinkOptions& options)
 {
-    NetlinkMessage nlm(RTM_NEWLINK, NLM_F_REQUEST | NLM_F_CREATE | NLM_F_EXCL | NLM_F_ACK);
-    ifinfomsg info = utils::make_clean<ifinfomsg>();
-    info.ifi_family = AF_UNSPEC;
-    info.ifi_change = CHANGE_FLAGS_DEFAULT;
-    nlm.put(info)
-        .put(IFLA_IFNAME, mIfname)
-        .beginNested(IFLA_LINKINFO)
-            .put(IFLA_INFO_KIND, "veth")
-            .beginNested(IFLA_INFO_DATA)
-                .beginNested(VETH_INFO_PEER)
-                    .put(info)
-                    .put(IFLA_IFNAME, peerif)
-                .endNested()
-            .endNested()
-        .endNested();
-    send(nlm, mContainerPid);
+    send(vethMessage(mIfname, peerif, options), mContainerPid);
 }
 
 void NetworkInterface::createBridge()
 {
-    NetlinkMessage nlm(RTM_NEWLINK, NLM_F_REQUEST | NLM_F_CREATE | NLM_F_EXCL | NLM_F_ACK);
-    ifinfomsg info = utils::make_clean<ifinfomsg>();
-    info.ifi_family = AF_UNSPEC;
-    info.ifi_change = CHANGE_FLAGS_DEFAULT;
-    nlm.put(info)
-        .beginNested(IFLA_LINKINFO)
-            .put(IFLA_INFO_KIND, "bridge")
-            .beginNested(IFLA_INFO_DATA)
-                .beginNested(IFLA_AF_SPEC)
-                    .put<uint32_t>(IFLA_BRIDGE_FLAGS, BRIDGE_FLAGS_MASTER)
-                .endNested()
-            .endNested()
-        .endNested()
-        .put(IFLA_IFNAME, mIfname); //bridge name (will be created)
-    send(nlm, mContainerPid);
+    send(bridgeMessage(mIfname), mContainerPid);
 }
 
-void NetworkInterface::createMacVLan(const std::string& maserif, MacVLanMode mode)
+void NetworkInterface::createMacVLan(const std::string& maserif, MacVLanMode mode, const LinkOptions& options)
 {
     uint32_t index = getInterfaceIndex(maserif);
     NetlinkMessage nlm(RTM_NEWLINK, NLM_F_REQUEST | NLM_F_CREATE | NLM_F_EXCL | NLM_F_ACK);
@@ -365,9 +518,16 @@ void NetworkInterface::createMacVLan(const std::string& maserif, MacVLanMode mod
         .endNested()
         .put(IFLA_LINK, index)      //master index
         .put(IFLA_IFNAME, mIfname); //slave name (will be created)
+    putLinkOptions(nlm, options);
     send(nlm, mContainerPid);
 }
 
+void NetworkInterface::createIPVLan(const std::string& masterif, IPVLanMode mode, const LinkOptions& options)
+{
+    send(ipvlanMessage(mIfname, getInterfaceIndex(mContainerPid, masterif), mode, options),
+         mContainerPid);
+}
+
 void NetworkInterface::moveToContainer(pid_t pid)
 {
     NetlinkMessage nlm(RTM_NEWLINK, NLM_F_REQUEST | NLM_F_ACK);
@@ -430,26 +590,14 @@ void NetworkInterface::renameFrom(const std::string& oldif)
     send(nlm, mContainerPid);
 }
 
-void NetworkInterface::addToBridge(const std::string& bridge)
-{
-    bridgeModify(mContainerPid, mIfname, getInterfaceIndex(mContainerPid, bridge));
-}
-
-void NetworkInterface::delFromBridge()
-{
-    bridgeModify(mContainerPid, mIfname, 0);
-}
+namespace {
 
-void NetworkInterface::setAttrs(const Attrs& attrs)
+NetlinkMessage setAttrsMessage(uint32_t index, const Attrs& attrs)
 {
-    if (attrs.empty()) {
-        return ;
-    }
-
     //TODO check this: NetlinkMessage nlm(RTM_SETLINK, NLM_F_REQUEST | NLM_F_ACK);
     NetlinkMessage nlm(RTM_NEWLINK, NLM_F_REQUEST | NLM_F_CREATE | NLM_F_ACK);
     ifinfomsg info = utils::make_clean<ifinfomsg>();
-    info.ifi_index = getInterfaceIndex(mContainerPid, mIfname);
+    info.ifi_index = index;
     info.ifi_family = AF_UNSPEC;
     info.ifi_change = CHANGE_FLAGS_DEFAULT;
 
@@ -488,8 +636,41 @@ void NetworkInterface::setAttrs(const Attrs& attrs)
         toMacAddressArray(mac, buf, 6);
         nlm.put(IFLA_ADDRESS, buf);
     }
+    return nlm;
+}
 
-    NetlinkResponse response = send(nlm, mContainerPid);
+} // namespace
+
+void NetworkInterface::addToBridge(const std::string& bridge, bool bringUp)
+{
+    const uint32_t masterIndex = getInterfaceIndex(mContainerPid, bridge);
+    if (!bringUp) {
+        bridgeModify(mContainerPid, mIfname, masterIndex);
+        return;
+    }
+
+    Attrs attrs;
+    attrs.push_back(Attr{AttrName::CHANGE, std::to_string(IFF_UP)});
+    attrs.push_back(Attr{AttrName::FLAGS, std::to_string(IFF_UP)});
+    NetlinkTransaction transaction(mContainerPid);
+    transaction.add(bridgeModifyMessage(mIfname, masterIndex))
+               .add(setAttrsMessage(getInterfaceIndex(mContainerPid, mIfname), attrs));
+    transaction.commit();
+}
+
+void NetworkInterface::delFromBridge()
+{
+    bridgeModify(mContainerPid, mIfname, 0);
+}
+
+void NetworkInterface::setAttrs(const Attrs& attrs)
+{
+    if (attrs.empty()) {
+        return ;
+    }
+
+    NetlinkResponse response = send(setAttrsMessage(getInterfaceIndex(mContainerPid, mIfname), attrs),
+                                    mContainerPid);
     if (!response.hasMessage()) {
         throw NetworkException("Can't set interface information");
     }
@@ -561,44 +742,31 @@ Attrs NetworkInterface::getAttrs() const
 
 void NetworkInterface::addInetAddr(const InetAddr& addr)
 {
-    NetlinkMessage nlm(RTM_NEWADDR, NLM_F_CREATE | NLM_F_REQUEST | NLM_F_ACK);
-    ifaddrmsg infoAddr = utils::make_clean<ifaddrmsg>();
-    infoAddr.ifa_index = getInterfaceIndex(mContainerPid, mIfname);
-    infoAddr.ifa_family = addr.type == InetAddrType::IPV4 ? AF_INET : AF_INET6;
-    infoAddr.ifa_prefixlen = addr.prefix;
-    infoAddr.ifa_flags = addr.flags;
-    nlm.put(infoAddr);
+    send(inetAddrMessage(RTM_NEWADDR, NLM_F_CREATE | NLM_F_REQUEST | NLM_F_ACK,
+                         getInterfaceIndex(mContainerPid, mIfname), addr),
+         mContainerPid);
+}
 
-    if (addr.type == InetAddrType::IPV6) {
-        nlm.put(IFA_ADDRESS, addr.getAddr<in6_addr>());
-        nlm.put(IFA_LOCAL, addr.getAddr<in6_addr>());
-    } else if (addr.type == InetAddrType::IPV4) {
-        nlm.put(IFA_ADDRESS, addr.getAddr<in_addr>());
-        nlm.put(IFA_LOCAL, addr.getAddr<in_addr>());
+void NetworkInterface::addInetAddrs(const std::vector<InetAddr>& addrs)
+{
+    if (addrs.empty()) {
+        return;
     }
 
-    send(nlm, mContainerPid);
+    const uint32_t index = getInterfaceIndex(mContainerPid, mIfname);
+    NetlinkTransaction transaction(mContainerPid);
+    for (const auto& addr : addrs) {
+        transaction.add(inetAddrMessage(RTM_NEWADDR, NLM_F_CREATE | NLM_F_REQUEST | NLM_F_ACK,
+                                        index, addr));
+    }
+    transaction.commit();
 }
 
 void NetworkInterface::delInetAddr(const InetAddr& addr)
 {
-    NetlinkMessage nlm(RTM_DELADDR, NLM_F_REQUEST | NLM_F_ACK);
-    ifaddrmsg infoAddr = utils::make_clean<ifaddrmsg>();
-    infoAddr.ifa_index = getInterfaceIndex(mContainerPid, mIfname);
-    infoAddr.ifa_family = addr.type == InetAddrType::IPV4 ? AF_INET : AF_INET6;
-    infoAddr.ifa_prefixlen = addr.prefix;
-    infoAddr.ifa_flags = addr.flags;
-    nlm.put(infoAddr);
-
-    if (addr.type == InetAddrType::IPV6) {
-        nlm.put(IFA_ADDRESS, addr.getAddr<in6_addr>());
-        nlm.put(IFA_LOCAL, addr.getAddr<in6_addr>());
-    } else if (addr.type == InetAddrType::IPV4) {
-        nlm.put(IFA_ADDRESS, addr.getAddr<in_addr>());
-        nlm.put(IFA_LOCAL, addr.getAddr<in_addr>());
-    }
-
-    send(nlm, mContainerPid);
+    send(inetAddrMessage(RTM_DELADDR, NLM_F_REQUEST | NLM_F_ACK,
+                         getInterfaceIndex(mContainerPid, mIfname), addr),
+         mContainerPid);
 }
 
 std::vector<InetAddr> NetworkInterface::getInetAddressList() const
@@ -643,7 +811,9 @@ static RoutingTable getRoutingTable(unsigned tbl)
     }
 }
 
-void NetworkInterface::addRoute(const Route& route, const RoutingTable rt)
+namespace {
+
+NetlinkMessage routeMessage(uint32_t index, const Route& route, const RoutingTable rt)
 {
     InetAddrType type = route.dst.type;
     if (route.src.prefix > 0 && route.src.type != type) {
@@ -651,7 +821,6 @@ void NetworkInterface::addRoute(const Route& route, const RoutingTable rt)
         LOGE(msg);
         throw NetworkException(msg);
     }
-    uint32_t index = getInterfaceIndex(mContainerPid, mIfname);
     NetlinkMessage nlm(RTM_NEWROUTE, NLM_F_REQUEST | NLM_F_CREATE | NLM_F_EXCL | NLM_F_ACK);
 
     rtmsg msg = utils::make_clean<rtmsg>();
@@ -692,8 +861,14 @@ void NetworkInterface::addRoute(const Route& route, const RoutingTable rt)
     }
 
     nlm.put(RTA_OIF, index);
+    return nlm;
+}
 
-    send(nlm, mContainerPid);
+} // namespace
+
+void NetworkInterface::addRoute(const Route& route, const RoutingTable rt)
+{
+    send(routeMessage(getInterfaceIndex(mContainerPid, mIfname), route, rt), mContainerPid);
 }
 
 void NetworkInterface::delRoute(const Route& route, const RoutingTable rt)
@@ -731,19 +906,24 @@ void NetworkInterface::delRoute(const Route& route, const RoutingTable rt)
 static std::vector<Route> getRoutesImpl(pid_t pid, rt_class_t tbl, const std::string& ifname, int family)
 {
     uint32_t searchindex = 0;
-    NetlinkMessage nlm(RTM_GETROUTE, NLM_F_REQUEST | NLM_F_ACK | NLM_F_DUMP);
-    ifinfomsg info = utils::make_clean<ifinfomsg>();
-    info.ifi_family = family;
-    info.ifi_change = CHANGE_FLAGS_DEFAULT;
-
-    nlm.put(info);
-
-    NetlinkResponse response = send(nlm, pid);
-
     if (!ifname.empty()) {
         searchindex = getInterfaceIndex(pid, ifname);
     }
 
+    NetlinkMessage nlm(RTM_GETROUTE, NLM_F_REQUEST | NLM_F_ACK | NLM_F_DUMP);
+    rtmsg info = utils::make_clean<rtmsg>();
+    info.rtm_family = family;
+    nlm.put(info)
+        .setStrictCheck();
+    if (tbl != RT_TABLE_UNSPEC) {
+        nlm.put(RTA_TABLE, static_cast<uint32_t>(tbl));
+    }
+    if (searchindex != 0) {
+        nlm.put(RTA_OIF, searchindex);
+    }
+
+    NetlinkResponse response = send(nlm, pid);
+
     std::vector<Route> routes;
     for ( ; response.hasMessage(); response.fetchNextMessage()) {
         if (response.getMessageType() != RTM_NEWROUTE) {
@@ -916,4 +1096,150 @@ std::vector<Route> NetworkInterface::getRoutes(pid_t initpid, const RoutingTable
     return getRoutesImpl(initpid, tbl, "", AF_UNSPEC);
 }
 
+NetworkBatch::NetworkBatch(pid_t pid) :
+    mPid(pid),
+    mTransaction(new NetlinkTransaction(pid))
+{
+}
+
+NetworkBatch::~NetworkBatch()
+{
+}
+
+void NetworkBatch::createBridge(const std::string& ifname)
+{
+    mTransaction->add(bridgeMessage(ifname));
+    addLink(ifname, mPid);
+}
+
+void NetworkBatch::createBridgedVeth(const std::string& ifname,
+                                     const std::string& bridge,
+                                     const std::string& peerif,
+                                     pid_t peerPid,
+                                     const LinkOptions& options)
+{
+    mTransaction->add(vethMessage(ifname, peerif, options, getInterfaceIndex(mPid, bridge), peerPid));
+    // the peer goes away with it
+    addLink(ifname, mPid);
+}
+
+void NetworkBatch::createIPVLan(const std::string& ifname,
+                                const std::string& masterif,
+                                IPVLanMode mode,
+                                pid_t pid,
+                                const LinkOptions& options)
+{
+    mTransaction->add(ipvlanMessage(ifname, getInterfaceIndex(mPid, masterif), mode, options, pid));
+    addLink(ifname, pid ? pid : mPid);
+}
+
+void NetworkBatch::createBridgedVethInNetns(const std::string& ifname,
+                                            const std::string& bridge,
+                                            const std::string& peerif,
+                                            int netnsFD,
+                                            const LinkOptions& options)
+{
+    mTransaction->add(vethMessage(ifname, peerif, options, getInterfaceIndex(mPid, bridge), 0, netnsFD));
+    addLink(ifname, mPid);
+}
+
+void NetworkBatch::createIPVLanInNetns(const std::string& ifname,
+                                       const std::string& masterif,
+                                       IPVLanMode mode,
+                                       int netnsFD,
+                                       const LinkOptions& options)
+{
+    mTransaction->add(ipvlanMessage(ifname, getInterfaceIndex(mPid, masterif), mode, options, 0, netnsFD));
+    addLink(ifname, 0, netnsFD);
+}
+
+void NetworkBatch::setAttrs(const std::string& ifname, const Attrs& attrs)
+{
+    if (!attrs.empty()) {
+        mTransaction->add(setAttrsMessage(getInterfaceIndex(mPid, ifname), attrs));
+    }
+}
+
+void NetworkBatch::addInetAddrs(const std::string& ifname, const std::vector<InetAddr>& addrs)
+{
+    if (addrs.empty()) {
+        return;
+    }
+    const uint32_t index = getInterfaceIndex(mPid, ifname);
+    for (const auto& addr : addrs) {
+        mTransaction->add(inetAddrMessage(RTM_NEWADDR, NLM_F_CREATE | NLM_F_REQUEST | NLM_F_ACK,
+                                          index, addr));
+    }
+}
+
+void NetworkBatch::addRoute(const std::string& ifname, const Route& route, const RoutingTable rt)
+{
+    mTransaction->add(routeMessage(getInterfaceIndex(mPid, ifname), route, rt));
+}
+
+std::size_t NetworkBatch::size() const
+{
+    return mTransaction->size();
+}
+
+void NetworkBatch::setStopOnError()
+{
+    mTransaction->setStopOnError();
+}
+
+void NetworkBatch::commit()
+{
+    std::vector<Link> links;
+    links.swap(mLinks);
+    try {
+        mTransaction->commit();
+    } catch (const std::exception&) {
+        // operations following the failed one might have created links as well
+        const std::vector<int>& errors = mTransaction->getErrors();
+        for (auto it = links.rbegin(); it != links.rend(); ++it) {
+            if (it->operation < errors.size() && errors[it->operation] == 0) {
+                deleteLink(*it);
+            }
+        }
+        throw;
+    }
+}
+
+void NetworkBatch::addLink(const std::string& ifname, pid_t pid, int netnsFD)
+{
+    mLinks.push_back(Link{mTransaction->size() - 1, ifname, pid, netnsFD});
+}
+
+void NetworkBatch::deleteLink(const Link& link)
+{
+    NetlinkMessage nlm(RTM_DELLINK, NLM_F_REQUEST | NLM_F_ACK);
+    ifinfomsg info = utils::make_clean<ifinfomsg>();
+    info.ifi_family = AF_UNSPEC;
+    info.ifi_change = CHANGE_FLAGS_DEFAULT;
+    nlm.put(info)
+        .put(IFLA_IFNAME, link.ifname);
+
+    if (link.pid || link.netnsFD < 0) {
+        try {
+            send(nlm, link.pid);
+        } catch (const std::exception& e) {
+            LOGW("Can't delete " << link.ifname << ": " << e.what());
+        }
+        return;
+    }
+
+    // there is no process in the namespace, a thread enters it to send the request
+    std::thread thread([&nlm, &link] {
+        const pid_t tid = ::syscall(SYS_gettid);
+        try {
+            setnsFD(link.netnsFD, CLONE_NEWNET);
+            send(nlm, tid);
+        } catch (const std::exception& e) {
+            LOGW("Can't delete " << link.ifname << ": " << e.what());
+        }
+        closeConnection(tid);
+    });
+    thread.join();
+}
+
 } // namespace lxcpp
@@ -30,10 +30,17 @@
 #include <string>
 #include <vector>
 #include <array>
+#include <memory>
 #include <ostream>
 
 #include <arpa/inet.h>
 
+namespace vasum {
+namespace netlink {
+class NetlinkTransaction;
+} // namespace netlink
+} // namespace vasum
+
 namespace lxcpp {
 
 std::string toString(const in_addr& addr);
@@ -179,7 +186,8 @@ typedef std::vector<Attr> Attrs;
 enum class InterfaceType : int {
     VETH,
     BRIDGE,
-    MACVLAN
+    MACVLAN,
+    IPVLAN
 };
 
 /**
@@ -192,6 +200,48 @@ enum class MacVLanMode {
     PASSTHRU
 };
 
+/**
+ * Suported IPVLan modes
+ */
+enum class IPVLanMode {
+    L2,
+    L3,
+    L3S
+};
+
+/**
+ * Link parameters which can be set only when the interface is created,
+ * 0 means the kernel default
+ */
+struct LinkOptions {
+    unsigned numTxQueues;   ///< number of transmit queues
+    unsigned numRxQueues;   ///< number of receive queues
+    unsigned gsoMaxSize;    ///< maximum size of generic segmentation offload packet
+    unsigned gsoMaxSegs;    ///< maximum number of segments of GSO packet
+    unsigned groMaxSize;    ///< maximum size of generic receive offload packet
+    unsigned txQueueLen;    ///< transmit queue length
+
+    LinkOptions() :
+        numTxQueues(0),
+        numRxQueues(0),
+        gsoMaxSize(0),
+        gsoMaxSegs(0),
+        groMaxSize(0),
+        txQueueLen(0)
+    {
+    }
+
+    CARGO_REGISTER
+    (
+        numTxQueues,
+        numRxQueues,
+        gsoMaxSize,
+        gsoMaxSegs,
+        groMaxSize,
+        txQueueLen
+    )
+};
+
 enum class NetStatus {
     DOWN,
     UP
@@ -237,8 +287,35 @@ public:
      *
      *   Create pseudo-ethernet interface on existing one:
      *      - ip link add @ref mIfname type macvlan link @b peerif [mode @b mode]
+     *
+     *   Create interface sharing MAC address of existing one:
+     *      - ip link add @ref mIfname link @b peerif type ipvlan mode l2
+     *
+     * @b options are used by all types except bridge.
      */
-    void create(InterfaceType type, const std::string& peerif = "", MacVLanMode mode = MacVLanMode::PRIVATE);
+    void create(InterfaceType type,
+                const std::string& peerif = "",
+                MacVLanMode mode = MacVLanMode::PRIVATE,
+                const LinkOptions& options = LinkOptions());
+
+    /**
+     * Create pair of virtual ethernet interfaces, @b options are used for both of them.
+     * Equivalent to: ip link add @ref mIfname numtxqueues N numrxqueues N txqueuelen N
+     *                  type veth peer name @b peerif numtxqueues N numrxqueues N txqueuelen N
+     *
+     * Multiple queues let the traffic of many flows be processed by many CPUs.
+     */
+    void createVeth(const std::string& peerif, const LinkOptions& options = LinkOptions());
+
+    /**
+     * Create interface which shares MAC address of @b masterif.
+     * Equivalent to: ip link add @ref mIfname link @b masterif type ipvlan mode @b mode
+     *
+     * Packets skip the bridge and the veth pair, in L3 mode they are routed by @b masterif.
+     */
+    void createIPVLan(const std::string& masterif,
+                      IPVLanMode mode,
+                      const LinkOptions& options = LinkOptions());
 
     /**
      * Delete interface.
@@ -259,10 +336,10 @@ public:
     void renameFrom(const std::string& oldif);
 
     /**
-     * Add interface to the bridge.
-     * Equivalent to: ip link set @ref mIfname master @b bridge
+     * Add interface to the bridge, optionally setting it up in the same netlink transaction.
+     * Equivalent to: ip link set @ref mIfname master @b bridge [up]
      */
-    void addToBridge(const std::string& bridge);
+    void addToBridge(const std::string& bridge, bool bringUp = false);
 
     /**
      * Remove insterface from the bridge.
@@ -283,6 +360,12 @@ public:
      */
     void addInetAddr(const InetAddr& addr);
 
+    /**
+     * Add many inet addresses to the interface in one netlink transaction.
+     * Equivalent to: ip addr add @b addr dev @ref mIfname (for each address)
+     */
+    void addInetAddrs(const std::vector<InetAddr>& addrs);
+
     /**
      * Remove inet address from the interface.
      * Equivalent to: ip addr del @b addr dev @ref mIfname
@@ -362,9 +445,8 @@ public:
     static std::vector<Route> getRoutes(pid_t initpid, const RoutingTable rt = RoutingTable::MAIN);
 
 private:
-    void createVeth(const std::string& peerif);
     void createBridge();
-    void createMacVLan(const std::string& masterif, MacVLanMode mode);
+    void createMacVLan(const std::string& masterif, MacVLanMode mode, const LinkOptions& options);
 
     void modifyRoute(int cmd, const InetAddr& src, const InetAddr& dst);
 
@@ -372,6 +454,126 @@ private:
     pid_t mContainerPid;       ///< Container pid to operate on (0 means kernel)
 };
 
+/**
+ * Network operations on many interfaces sent to the kernel together
+ *
+ * Operations are queued and sent in one netlink transaction by commit(),
+ * so setting up many interfaces costs one round trip instead of one per step.
+ * The kernel processes them in the order they were queued. Interfaces
+ * referenced by the operations (bridges, masters, configured interfaces)
+ * have to exist when the operation is queued.
+ * All of them are processed even if one fails, unless setStopOnError() is used.
+ * Interfaces created by a failed batch are deleted, so it doesn't leave half of a setup.
+ */
+class NetworkBatch {
+public:
+    /**
+     * @param pid process which describes network namespace (0 means own one)
+     */
+    explicit NetworkBatch(pid_t pid = 0);
+    ~NetworkBatch();
+
+    NetworkBatch(const NetworkBatch&) = delete;
+    NetworkBatch& operator=(const NetworkBatch&) = delete;
+
+    /**
+     * Equivalent to: ip link add @b ifname type bridge
+     */
+    void createBridge(const std::string& ifname);
+
+    /**
+     * Create veth pair with @b ifname added to @b bridge and up,
+     * @b peerif is created directly in network namespace of @b peerPid.
+     * Equivalent to: ip link add @b ifname master @b bridge up
+     *                  type veth peer name @b peerif netns @b peerPid
+     */
+    void createBridgedVeth(const std::string& ifname,
+                           const std::string& bridge,
+                           const std::string& peerif,
+                           pid_t peerPid,
+                           const LinkOptions& options = LinkOptions());
+
+    /**
+     * Create ipvlan on @b masterif directly in network namespace of @b pid.
+     * Equivalent to: ip link add @b ifname link @b masterif netns @b pid type ipvlan mode @b mode
+     */
+    void createIPVLan(const std::string& ifname,
+                      const std::string& masterif,
+                      IPVLanMode mode,
+                      pid_t pid,
+                      const LinkOptions& options = LinkOptions());
+
+    /**
+     * Same as createBridgedVeth, but @b peerif is created in network namespace
+     * referred to by the @b netnsFD descriptor
+     */
+    void createBridgedVethInNetns(const std::string& ifname,
+                                  const std::string& bridge,
+                                  const std::string& peerif,
+                                  int netnsFD,
+                                  const LinkOptions& options = LinkOptions());
+
+    /**
+     * Same as createIPVLan, but @b ifname is created in network namespace
+     * referred to by the @b netnsFD descriptor
+     */
+    void createIPVLanInNetns(const std::string& ifname,
+                             const std::string& masterif,
+                             IPVLanMode mode,
+                             int netnsFD,
+                             const LinkOptions& options = LinkOptions());
+
+    /**
+     * @see NetworkInterface::setAttrs
+     */
+    void setAttrs(const std::string& ifname, const Attrs& attrs);
+
+    /**
+     * @see NetworkInterface::addInetAddrs
+     */
+    void addInetAddrs(const std::string& ifname, const std::vector<InetAddr>& addrs);
+
+    /**
+     * @see NetworkInterface::addRoute
+     */
+    void addRoute(const std::string& ifname, const Route& route, const RoutingTable rt = RoutingTable::MAIN);
+
+    /**
+     * Number of queued operations
+     */
+    std::size_t size() const;
+
+    /**
+     * Don't process operations following a failed one
+     *
+     * Operations are sent one by one then, which costs a round trip each.
+     */
+    void setStopOnError();
+
+    /**
+     * Send queued operations and wait for their results
+     *
+     * If any operation fails, interfaces created by the batch are deleted
+     * and an exception describing the first failed operation is thrown.
+     */
+    void commit();
+
+private:
+    struct Link {
+        std::size_t operation; ///< index of the operation creating the link
+        std::string ifname;
+        pid_t pid;             ///< process in network namespace of the link
+        int netnsFD;           ///< network namespace of the link, used when pid is 0
+    };
+
+    pid_t mPid;
+    std::unique_ptr<vasum::netlink::NetlinkTransaction> mTransaction;
+    std::vector<Link> mLinks;
+
+    void addLink(const std::string& ifname, pid_t pid, int netnsFD = -1);
+    void deleteLink(const Link& link);
+};
+
 } // namespace lxcpp
 
 #endif // LXCPP_NETWORK_HPP
@@ -25,6 +25,7 @@
 
 #include "lxcpp/process.hpp"
 #include "lxcpp/exception.hpp"
+#include "lxcpp/terminal.hpp"
 
 #include "logger/logger.hpp"
 #include "utils/fd-utils.hpp"
@@ -52,6 +53,33 @@ pid_t fork()
     return pid;
 }
 
+int daemonize()
+{
+    // Set a new session so the process looses its control terminal
+    if (::setsid() < 0) {
+        return -1;
+    }
+
+    // Double fork() with exit() to reattach the process under the host's init
+    // and to make sure that the child is not a process group leader
+    // and cannot reacquire its control terminal
+    pid_t pid = ::fork();
+    if (pid < 0) { // fork failed
+        return -1;
+    }
+    if (pid > 0) { // exit in parent process
+        ::_exit(EXIT_SUCCESS);
+    }
+
+    // Chdir to / so it's independent on other directories
+    if (::chdir("/") < 0) {
+        return -1;
+    }
+
+    // Null std* fds so it's properly dettached from the terminal
+    return nullStdFDs();
+}
+
 pid_t clone(int (*function)(void *),
             void *args,
             const int flags)
@@ -127,6 +155,15 @@ void setns(const pid_t pid, int requestedNamespaces)
     utils::close(dirFD);
 }
 
+void setnsFD(const int fd, const int ns)
+{
+    if (-1 == ::setns(fd, ns)) {
+        const std::string msg = "setns() failed: " + utils::getSystemErrorMessage();
+        LOGE(msg);
+        throw ProcessSetupException(msg);
+    }
+}
+
 int waitpid(const pid_t pid)
 {
     int status;
@@ -34,12 +34,21 @@ namespace lxcpp {
 
 pid_t fork();
 
+/**
+ * Detach the process from its session and terminal and reattach it
+ * under the host's init. Only the daemon returns, 0 on success.
+ * This function has to be safe in regard to signal(7).
+ */
+int daemonize();
+
 pid_t clone(int (*function)(void *),
             void *args,
             const int flags);
 
 void setns(const pid_t pid, const int namespaces);
 
+void setnsFD(const int fd, const int ns);
+
 int waitpid(const pid_t pid);
 
 void unshare(const int ns);
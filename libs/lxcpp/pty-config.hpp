@@ -58,18 +58,24 @@ struct PTYsConfig {
     uid_t mUID;
     std::string mDevptsPath;
     std::vector<PTYConfig> mPTYs;
+    unsigned int mLogSize;
+    bool mLogFile;
 
     PTYsConfig(const unsigned int count = 1, const uid_t UID = 0, const std::string &devptsPath = "")
         : mCount(count),
           mUID(UID),
-          mDevptsPath(devptsPath)
+          mDevptsPath(devptsPath),
+          mLogSize(0),
+          mLogFile(false)
     {}
 
     CARGO_REGISTER
     (
         mCount,
         mDevptsPath,
-        mPTYs
+        mPTYs,
+        mLogSize,
+        mLogFile
     )
 };
 
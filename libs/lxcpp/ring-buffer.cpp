@@ -0,0 +1,158 @@
+/*
+ *  Copyright (C) 2015 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License version 2.1 as published by the Free Software Foundation.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/**
+ * @file
+ * @author  agent (agent@local)
+ * @brief   Byte ring buffer for relaying data between file descriptors
+ */
+
+#include "config.hpp"
+
+#include "lxcpp/ring-buffer.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <unistd.h>
+#include <sys/uio.h>
+
+namespace lxcpp {
+
+RingBuffer::RingBuffer(std::size_t capacity, std::size_t maxCapacity)
+    : mBuffer(std::max<std::size_t>(capacity, 1)),
+      mMaxCapacity(std::max(maxCapacity, mBuffer.size())),
+      mBegin(0),
+      mSize(0)
+{
+}
+
+std::size_t RingBuffer::size() const
+{
+    return mSize;
+}
+
+std::size_t RingBuffer::capacity() const
+{
+    return mBuffer.size();
+}
+
+bool RingBuffer::empty() const
+{
+    return mSize == 0;
+}
+
+bool RingBuffer::full() const
+{
+    return mSize == mMaxCapacity;
+}
+
+ssize_t RingBuffer::readFrom(int fd)
+{
+    if (mSize == mBuffer.size()) {
+        if (full()) {
+            errno = ENOBUFS;
+            return -1;
+        }
+        grow();
+    }
+
+    const std::size_t capacity = mBuffer.size();
+    const std::size_t end = mBegin + mSize;
+    ::iovec iov[2];
+    int count = 1;
+    if (end < capacity) {
+        // free space after the data and before it
+        iov[0].iov_base = mBuffer.data() + end;
+        iov[0].iov_len = capacity - end;
+        iov[1].iov_base = mBuffer.data();
+        iov[1].iov_len = mBegin;
+        count = mBegin ? 2 : 1;
+    } else {
+        // data wraps, free space is between its parts
+        iov[0].iov_base = mBuffer.data() + end - capacity;
+        iov[0].iov_len = capacity - mSize;
+    }
+
+    const ssize_t ret = TEMP_FAILURE_RETRY(::readv(fd, iov, count));
+    if (ret > 0) {
+        mSize += ret;
+    }
+    return ret;
+}
+
+ssize_t RingBuffer::writeTo(int fd)
+{
+    if (mSize == 0) {
+        return 0;
+    }
+
+    const std::size_t capacity = mBuffer.size();
+    const std::size_t end = mBegin + mSize;
+    ::iovec iov[2];
+    int count = 1;
+    iov[0].iov_base = mBuffer.data() + mBegin;
+    if (end <= capacity) {
+        iov[0].iov_len = mSize;
+    } else {
+        iov[0].iov_len = capacity - mBegin;
+        iov[1].iov_base = mBuffer.data();
+        iov[1].iov_len = end - capacity;
+        count = 2;
+    }
+
+    const ssize_t ret = TEMP_FAILURE_RETRY(::writev(fd, iov, count));
+    if (ret > 0) {
+        mSize -= ret;
+        // an empty buffer starts from the beginning, so the data doesn't wrap
+        mBegin = mSize ? (mBegin + ret) % capacity : 0;
+    }
+    return ret;
+}
+
+std::size_t RingBuffer::push(const char* data, std::size_t len)
+{
+    while (mSize + len > mBuffer.size() && mBuffer.size() < mMaxCapacity) {
+        grow();
+    }
+
+    const std::size_t capacity = mBuffer.size();
+    len = std::min(len, capacity - mSize);
+    const std::size_t end = (mBegin + mSize) % capacity;
+    const std::size_t first = std::min(len, capacity - end);
+    std::copy(data, data + first, mBuffer.begin() + end);
+    std::copy(data + first, data + len, mBuffer.begin());
+    mSize += len;
+    return len;
+}
+
+void RingBuffer::clear()
+{
+    mBegin = 0;
+    mSize = 0;
+}
+
+void RingBuffer::grow()
+{
+    std::vector<char> buffer(std::min(mBuffer.size() * 2, mMaxCapacity));
+    const std::size_t first = std::min(mSize, mBuffer.size() - mBegin);
+    std::copy(mBuffer.begin() + mBegin, mBuffer.begin() + mBegin + first, buffer.begin());
+    std::copy(mBuffer.begin(), mBuffer.begin() + (mSize - first), buffer.begin() + first);
+    mBuffer.swap(buffer);
+    mBegin = 0;
+}
+
+} // namespace lxcpp
@@ -0,0 +1,105 @@
+/*
+ *  Copyright (C) 2015 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License version 2.1 as published by the Free Software Foundation.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/**
+ * @file
+ * @author  agent (agent@local)
+ * @brief   Byte ring buffer for relaying data between file descriptors
+ */
+
+#ifndef LXCPP_RING_BUFFER_HPP
+#define LXCPP_RING_BUFFER_HPP
+
+#include <cstddef>
+#include <vector>
+#include <sys/types.h>
+
+namespace lxcpp {
+
+/**
+ * FIFO of bytes read from one file descriptor and written to another.
+ *
+ * Data is never moved inside the buffer, both reading and writing use
+ * the free or used space as it is, in up to two parts (readv/writev).
+ * The buffer starts small and doubles each time it's full, up to
+ * the maximal capacity, so only busy relays use more memory.
+ */
+class RingBuffer {
+public:
+    /**
+     * @param capacity initial capacity in bytes
+     * @param maxCapacity capacity the buffer can grow to
+     */
+    RingBuffer(std::size_t capacity, std::size_t maxCapacity);
+
+    /**
+     * Number of buffered bytes
+     */
+    std::size_t size() const;
+
+    /**
+     * Current capacity in bytes
+     */
+    std::size_t capacity() const;
+
+    bool empty() const;
+
+    /**
+     * No more data fits, even after growing
+     */
+    bool full() const;
+
+    /**
+     * Read from the descriptor into the free space with one call.
+     * The buffer grows first if there's no free space.
+     *
+     * @return the same as ::read, -1 with ENOBUFS errno if the buffer is full
+     */
+    ssize_t readFrom(int fd);
+
+    /**
+     * Store the data, growing the buffer if needed
+     *
+     * @return number of bytes stored, less than @b len if the buffer got full
+     */
+    std::size_t push(const char* data, std::size_t len);
+
+    /**
+     * Drop all buffered data
+     */
+    void clear();
+
+    /**
+     * Write buffered data to the descriptor with one call.
+     * Written data is removed from the buffer.
+     *
+     * @return the same as ::write, 0 if the buffer is empty
+     */
+    ssize_t writeTo(int fd);
+
+private:
+    std::vector<char> mBuffer;
+    std::size_t mMaxCapacity;
+    std::size_t mBegin;
+    std::size_t mSize;
+
+    void grow();
+};
+
+} // namespace lxcpp
+
+#endif // LXCPP_RING_BUFFER_HPP
@@ -0,0 +1,66 @@
+/*
+ *  Copyright (C) 2015 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License version 2.1 as published by the Free Software Foundation.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/**
+ * @file
+ * @author  agent (agent@local)
+ * @brief   Timing of the container start phases
+ */
+
+#include "config.hpp"
+
+#include "lxcpp/start-profile.hpp"
+
+#include <time.h>
+
+namespace lxcpp {
+
+std::uint64_t getMonotonicTime()
+{
+    struct timespec ts;
+    ::clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<std::uint64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+std::uint64_t StartPhase::getDuration() const
+{
+    return mEnd > mBegin ? mEnd - mBegin : 0;
+}
+
+void StartProfile::begin(const std::string& name)
+{
+    mPhases.emplace_back(name, getMonotonicTime());
+}
+
+void StartProfile::end()
+{
+    if (!mPhases.empty()) {
+        mPhases.back().mEnd = getMonotonicTime();
+    }
+}
+
+void StartProfile::clear()
+{
+    mPhases.clear();
+}
+
+void StartProfile::append(const StartProfile& profile)
+{
+    mPhases.insert(mPhases.end(), profile.mPhases.begin(), profile.mPhases.end());
+}
+
+} // namespace lxcpp
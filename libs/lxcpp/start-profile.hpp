@@ -0,0 +1,96 @@
+/*
+ *  Copyright (C) 2015 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License version 2.1 as published by the Free Software Foundation.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/**
+ * @file
+ * @author  agent (agent@local)
+ * @brief   Timing of the container start phases
+ */
+
+#ifndef LXCPP_START_PROFILE_HPP
+#define LXCPP_START_PROFILE_HPP
+
+#include "cargo/fields.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace lxcpp {
+
+/**
+ * Monotonic clock in nanoseconds, the same in all the processes
+ * (host, guard and init), so their timestamps can be compared
+ */
+std::uint64_t getMonotonicTime();
+
+struct StartPhase {
+    std::string mName;
+    // CLOCK_MONOTONIC nanoseconds, mEnd is 0 if the phase hasn't finished
+    std::uint64_t mBegin;
+    std::uint64_t mEnd;
+
+    StartPhase()
+        : mBegin(0),
+          mEnd(0)
+    {}
+
+    StartPhase(const std::string& name, const std::uint64_t begin)
+        : mName(name),
+          mBegin(begin),
+          mEnd(0)
+    {}
+
+    std::uint64_t getDuration() const;
+
+    CARGO_REGISTER
+    (
+        mName,
+        mBegin,
+        mEnd
+    )
+};
+
+/**
+ * Phases of the last container start in the order they began.
+ * Phases of the host, the guard and the init process are all here.
+ */
+struct StartProfile {
+    std::vector<StartPhase> mPhases;
+
+    /**
+     * Start timing a phase, it lasts until the next end()
+     */
+    void begin(const std::string& name);
+    void end();
+
+    void clear();
+
+    /**
+     * Add phases timed by another process
+     */
+    void append(const StartProfile& profile);
+
+    CARGO_REGISTER
+    (
+        mPhases
+    )
+};
+
+} // namespace lxcpp
+
+#endif // LXCPP_START_PROFILE_HPP
@@ -0,0 +1,113 @@
+/*
+ *  Copyright (C) 2015 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License version 2.1 as published by the Free Software Foundation.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/**
+ * @file
+ * @author  agent (agent@local)
+ * @brief   Bounded log of a terminal output
+ */
+
+#include "config.hpp"
+
+#include "lxcpp/terminal-log.hpp"
+#include "lxcpp/exception.hpp"
+
+#include "logger/logger.hpp"
+#include "utils/exception.hpp"
+#include "utils/fd-utils.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+namespace lxcpp {
+
+TerminalLog::TerminalLog(std::size_t size, const std::string& path)
+    : mCapacity(std::max<std::size_t>(size, 1)),
+      mMapSize(sizeof(std::uint64_t) + mCapacity)
+{
+    int fd = -1;
+    if (!path.empty()) {
+        fd = utils::open(path, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+        if (-1 == ::ftruncate(fd, mMapSize)) {
+            const std::string msg = "ftruncate() failed: " + utils::getSystemErrorMessage();
+            utils::close(fd);
+            LOGE(msg);
+            throw TerminalException(msg);
+        }
+    }
+
+    mMap = ::mmap(nullptr, mMapSize, PROT_READ | PROT_WRITE,
+                  fd == -1 ? MAP_PRIVATE | MAP_ANONYMOUS : MAP_SHARED, fd, 0);
+    const std::string error = utils::getSystemErrorMessage();
+    if (fd != -1) {
+        utils::close(fd);
+    }
+    if (mMap == MAP_FAILED) {
+        const std::string msg = "mmap() failed: " + error;
+        LOGE(msg);
+        throw TerminalException(msg);
+    }
+
+    // both anonymous and truncated file mappings are zeroed
+    mWritten = static_cast<std::uint64_t*>(mMap);
+    mData = static_cast<char*>(mMap) + sizeof(std::uint64_t);
+}
+
+TerminalLog::~TerminalLog()
+{
+    ::munmap(mMap, mMapSize);
+}
+
+void TerminalLog::append(const char* data, std::size_t len)
+{
+    if (len > mCapacity) {
+        // only the end would be kept anyway
+        *mWritten += len - mCapacity;
+        data += len - mCapacity;
+        len = mCapacity;
+    }
+
+    const std::size_t pos = *mWritten % mCapacity;
+    const std::size_t first = std::min(len, mCapacity - pos);
+    ::memcpy(mData + pos, data, first);
+    ::memcpy(mData, data + first, len - first);
+    *mWritten += len;
+}
+
+std::string TerminalLog::tail(std::size_t len) const
+{
+    const std::size_t kept = size();
+    if (len == 0 || len > kept) {
+        len = kept;
+    }
+
+    const std::size_t pos = (*mWritten - len) % mCapacity;
+    const std::size_t first = std::min(len, mCapacity - pos);
+    std::string ret(mData + pos, first);
+    ret.append(mData, len - first);
+    return ret;
+}
+
+std::size_t TerminalLog::size() const
+{
+    return std::min<std::uint64_t>(*mWritten, mCapacity);
+}
+
+} // namespace lxcpp
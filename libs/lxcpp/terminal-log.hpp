@@ -0,0 +1,75 @@
+/*
+ *  Copyright (C) 2015 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License version 2.1 as published by the Free Software Foundation.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/**
+ * @file
+ * @author  agent (agent@local)
+ * @brief   Bounded log of a terminal output
+ */
+
+#ifndef LXCPP_TERMINAL_LOG_HPP
+#define LXCPP_TERMINAL_LOG_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace lxcpp {
+
+/**
+ * TerminalLog keeps the last part of a terminal output.
+ *
+ * When it's full the oldest data is overwritten, so appending never waits.
+ * The log can be kept in a memory-mapped file, the file stays after the
+ * container is stopped. It starts with a 64-bit number of bytes appended
+ * so far, followed by the data wrapped around at the log size.
+ */
+class TerminalLog {
+public:
+    /**
+     * @param size maximal number of bytes kept
+     * @param path file the log is kept in, only memory is used if empty
+     */
+    explicit TerminalLog(std::size_t size, const std::string& path = std::string());
+    ~TerminalLog();
+
+    TerminalLog(const TerminalLog&) = delete;
+    TerminalLog& operator=(const TerminalLog&) = delete;
+
+    void append(const char* data, std::size_t len);
+
+    /**
+     * Get the last @b len bytes of the log, all of it if @b len is 0
+     */
+    std::string tail(std::size_t len = 0) const;
+
+    /**
+     * Number of bytes kept
+     */
+    std::size_t size() const;
+
+private:
+    std::size_t mCapacity;
+    std::size_t mMapSize;
+    void* mMap;
+    std::uint64_t* mWritten;
+    char* mData;
+};
+
+} // namespace lxcpp
+
+#endif // LXCPP_TERMINAL_LOG_HPP
@@ -302,6 +302,20 @@ Unit tests for both: server and client and integration tests.
 %attr(755,root,root) /etc/vasum/tests/templates/*.sh
 %{python_sitelib}/vsm_integration_tests
 
+## Benchmarks Package ##########################################################
+%package benchmarks
+Summary:          Vasum Benchmarks
+Group:            Development/Libraries
+Requires:         liblxcpp = %{epoch}:%{version}-%{release}
+Requires:         libLogger
+
+%description benchmarks
+Benchmarks of the netlink operations used to set up zone networks.
+
+%files benchmarks
+%defattr(644,root,root,755)
+%attr(755,root,root) %{_bindir}/vasum-netlink-benchmark
+
 %if !%{without_dbus}
 ## libSimpleDbus Package #######################################################
 %package -n libSimpleDbus
@@ -28,6 +28,7 @@
 
 #include "host-dbus-connection.hpp"
 #include "host-dbus-definitions.hpp"
+#include "host-methods.hpp"
 #include "exception.hpp"
 #include "api/dbus-method-result-builder.hpp"
 #include "api/messages.hpp"
@@ -44,16 +45,62 @@ namespace {
 // Can happen if glib loop is busy or not present.
 // TODO: this should be in host's configuration file
 const unsigned int NAME_ACQUIRED_TIMEOUT = 5 * 1000;
-const std::string EMPTY_CALLER = "";
 
 } // namespace
 
+/**
+ * Fills the method handler map from the host method table
+ */
+class HostDbusConnection::MethodRegistrar {
+public:
+    MethodRegistrar(HostDbusConnection& connection)
+        : mConnection(connection)
+    {
+    }
+
+    template<typename ArgIn, typename ArgOut>
+    void method(const std::string& dbusName,
+                const ::cargo::ipc::MethodID /* ipcId */,
+                void (ZonesManager::*handler)(const ArgIn&, api::MethodResultBuilder::Pointer))
+    {
+        ZonesManager* zonesManagerPtr = mConnection.mZonesManagerPtr;
+        mConnection.mMethodHandlers[dbusName] = [zonesManagerPtr, handler](GVariant* parameters,
+                                                                           dbus::MethodResultBuilder::Pointer result) {
+            ArgIn data;
+            cargo::loadFromGVariant(parameters, data);
+
+            auto rb = std::make_shared<api::DbusMethodResultBuilder<ArgOut>>(result);
+            (zonesManagerPtr->*handler)(data, rb);
+        };
+    }
+
+    template<typename ArgIn, typename ArgOut>
+    void method(const std::string& dbusName,
+                const ::cargo::ipc::MethodID /* ipcId */,
+                void (ZonesManager::*handler)(api::MethodResultBuilder::Pointer))
+    {
+        static_assert(std::is_same<ArgIn, api::Void>::value, "Handler without input arguments");
+        ZonesManager* zonesManagerPtr = mConnection.mZonesManagerPtr;
+        mConnection.mMethodHandlers[dbusName] = [zonesManagerPtr, handler](GVariant* /* parameters */,
+                                                                           dbus::MethodResultBuilder::Pointer result) {
+            auto rb = std::make_shared<api::DbusMethodResultBuilder<ArgOut>>(result);
+            (zonesManagerPtr->*handler)(rb);
+        };
+    }
+
+private:
+    HostDbusConnection& mConnection;
+};
+
 
 HostDbusConnection::HostDbusConnection(ZonesManager* zonesManagerPtr)
     : mNameAcquired(false)
     , mNameLost(false)
     , mZonesManagerPtr(zonesManagerPtr)
 {
+    MethodRegistrar registrar(*this);
+    forEachHostMethod(registrar);
+
     LOGT("Connecting to host system DBUS");
     mDbusConnection = dbus::DbusConnection::createSystem();
 
@@ -135,15 +182,6 @@ void HostDbusConnection::onMessageCall(const std::string& objectPath,
         return;
     }
 
-    if (methodName == api::dbus::METHOD_SET_ACTIVE_ZONE) {
-        api::ZoneId zoneId;
-        cargo::loadFromGVariant(parameters, zoneId);
-
-        auto rb = std::make_shared<api::DbusMethodResultBuilder<api::Void>>(result);
-        mZonesManagerPtr->handleSetActiveZoneCall(zoneId, rb);
-        return;
-    }
-
     if (methodName == api::dbus::METHOD_PROXY_CALL) {
         const gchar* target = NULL;
         const gchar* targetBusName = NULL;
@@ -173,246 +211,9 @@ void HostDbusConnection::onMessageCall(const std::string& objectPath,
         return;
     }
 
-    if (methodName == api::dbus::METHOD_LOCK_QUEUE) {
-        auto rb = std::make_shared<api::DbusMethodResultBuilder<api::Void>>(result);
-        mZonesManagerPtr->handleLockQueueCall(rb);
-        return;
-    }
-
-    if (methodName == api::dbus::METHOD_UNLOCK_QUEUE) {
-        auto rb = std::make_shared<api::DbusMethodResultBuilder<api::Void>>(result);
-        mZonesManagerPtr->handleUnlockQueueCall(rb);
-        return;
-    }
-
-    if (methodName == api::dbus::METHOD_GET_ZONE_ID_LIST) {
-        auto rb = std::make_shared<api::DbusMethodResultBuilder<api::ZoneIds>>(result);
-        mZonesManagerPtr->handleGetZoneIdsCall(rb);
-        return;
-    }
-
-    if (methodName == api::dbus::METHOD_GET_ACTIVE_ZONE_ID) {
-        auto rb = std::make_shared<api::DbusMethodResultBuilder<api::ZoneId>>(result);
-        mZonesManagerPtr->handleGetActiveZoneIdCall(rb);
-        return;
-    }
-
-    if (methodName == api::dbus::METHOD_GET_ZONE_INFO) {
-        api::ZoneId zoneId;
-        cargo::loadFromGVariant(parameters, zoneId);
-
-        auto rb = std::make_shared<api::DbusMethodResultBuilder<api::ZoneInfoOut>>(result);
-        mZonesManagerPtr->handleGetZoneInfoCall(zoneId, rb);
-        return;
-    }
-
-    if (methodName == api::dbus::METHOD_SET_NETDEV_ATTRS) {
-        api::SetNetDevAttrsIn data;
-        cargo::loadFromGVariant(parameters, data);
-
-        auto rb = std::make_shared<api::DbusMethodResultBuilder<api::Void>>(result);
-        mZonesManagerPtr->handleSetNetdevAttrsCall(data, rb);
-        return;
-    }
-
-    if (methodName == api::dbus::METHOD_GET_NETDEV_ATTRS) {
-        api::GetNetDevAttrsIn data;
-        cargo::loadFromGVariant(parameters, data);
-
-        auto rb = std::make_shared<api::DbusMethodResultBuilder<api::GetNetDevAttrs>>(result);
-        mZonesManagerPtr->handleGetNetdevAttrsCall(data, rb);
-        return;
-    }
-
-    if (methodName == api::dbus::METHOD_GET_NETDEV_LIST) {
-        api::ZoneId data;
-        cargo::loadFromGVariant(parameters, data);
-
-        auto rb = std::make_shared<api::DbusMethodResultBuilder<api::NetDevList>>(result);
-        mZonesManagerPtr->handleGetNetdevListCall(data, rb);
-        return;
-    }
-
-    if (methodName == api::dbus::METHOD_CREATE_NETDEV_VETH) {
-        api::CreateNetDevVethIn data;
-        cargo::loadFromGVariant(parameters, data);
-
-        auto rb = std::make_shared<api::DbusMethodResultBuilder<api::Void>>(result);
-        mZonesManagerPtr->handleCreateNetdevVethCall(data, rb);
-        return;
-    }
-
-    if (methodName == api::dbus::METHOD_CREATE_NETDEV_MACVLAN) {
-        api::CreateNetDevMacvlanIn data;
-        cargo::loadFromGVariant(parameters, data);
-
-        auto rb = std::make_shared<api::DbusMethodResultBuilder<api::Void>>(result);
-        mZonesManagerPtr->handleCreateNetdevMacvlanCall(data, rb);
-        return;
-    }
-
-    if (methodName == api::dbus::METHOD_CREATE_NETDEV_PHYS) {
-        api::CreateNetDevPhysIn data;
-        cargo::loadFromGVariant(parameters, data);
-
-        auto rb = std::make_shared<api::DbusMethodResultBuilder<api::Void>>(result);
-        mZonesManagerPtr->handleCreateNetdevPhysCall(data, rb);
-        return;
-    }
-
-    if (methodName == api::dbus::METHOD_DESTROY_NETDEV) {
-        api::DestroyNetDevIn data;
-        cargo::loadFromGVariant(parameters, data);
-
-        auto rb = std::make_shared<api::DbusMethodResultBuilder<api::Void>>(result);
-        mZonesManagerPtr->handleDestroyNetdevCall(data, rb);
-        return;
-    }
-
-    if (methodName == api::dbus::METHOD_DELETE_NETDEV_IP_ADDRESS) {
-        api::DeleteNetdevIpAddressIn data;
-        cargo::loadFromGVariant(parameters, data);
-
-        auto rb = std::make_shared<api::DbusMethodResultBuilder<api::Void>>(result);
-        mZonesManagerPtr->handleDeleteNetdevIpAddressCall(data, rb);
-        return;
-    }
-
-    if (methodName == api::dbus::METHOD_DECLARE_FILE) {
-        api::DeclareFileIn data;
-        cargo::loadFromGVariant(parameters, data);
-
-        auto rb = std::make_shared<api::DbusMethodResultBuilder<api::Declaration>>(result);
-        mZonesManagerPtr->handleDeclareFileCall(data, rb);
-        return;
-    }
-
-    if (methodName == api::dbus::METHOD_DECLARE_MOUNT) {
-        api::DeclareMountIn data;
-        cargo::loadFromGVariant(parameters, data);
-
-        auto rb = std::make_shared<api::DbusMethodResultBuilder<api::Declaration>>(result);
-        mZonesManagerPtr->handleDeclareMountCall(data, rb);
-        return;
-    }
-
-    if (methodName == api::dbus::METHOD_DECLARE_LINK) {
-        api::DeclareLinkIn data;
-        cargo::loadFromGVariant(parameters, data);
-
-        auto rb = std::make_shared<api::DbusMethodResultBuilder<api::Declaration>>(result);
-        mZonesManagerPtr->handleDeclareLinkCall(data, rb);
-        return;
-    }
-
-    if (methodName == api::dbus::METHOD_GET_DECLARATIONS) {
-        api::ZoneId data;
-        cargo::loadFromGVariant(parameters, data);
-
-        auto rb = std::make_shared<api::DbusMethodResultBuilder<api::Declarations>>(result);
-        mZonesManagerPtr->handleGetDeclarationsCall(data, rb);
-        return;
-    }
-
-    if (methodName == api::dbus::METHOD_REMOVE_DECLARATION) {
-        api::RemoveDeclarationIn data;
-        cargo::loadFromGVariant(parameters, data);
-
-        auto rb = std::make_shared<api::DbusMethodResultBuilder<api::Void>>(result);
-        mZonesManagerPtr->handleRemoveDeclarationCall(data, rb);
-        return;
-    }
-
-    if (methodName == api::dbus::METHOD_CREATE_ZONE) {
-        api::CreateZoneIn data;
-        cargo::loadFromGVariant(parameters, data);
-
-        auto rb = std::make_shared<api::DbusMethodResultBuilder<api::Void>>(result);
-        mZonesManagerPtr->handleCreateZoneCall(data, rb);
-        return;
-    }
-
-    if (methodName == api::dbus::METHOD_DESTROY_ZONE) {
-        api::ZoneId data;
-        cargo::loadFromGVariant(parameters, data);
-
-        auto rb = std::make_shared<api::DbusMethodResultBuilder<api::Void>>(result);
-        mZonesManagerPtr->handleDestroyZoneCall(data, rb);
-        return;
-    }
-
-    if (methodName == api::dbus::METHOD_SHUTDOWN_ZONE) {
-        api::ZoneId data;
-        cargo::loadFromGVariant(parameters, data);
-
-        auto rb = std::make_shared<api::DbusMethodResultBuilder<api::Void>>(result);
-        mZonesManagerPtr->handleShutdownZoneCall(data, rb);
-        return;
-    }
-
-    if (methodName == api::dbus::METHOD_START_ZONE) {
-        api::ZoneId data;
-        cargo::loadFromGVariant(parameters, data);
-
-        auto rb = std::make_shared<api::DbusMethodResultBuilder<api::Void>>(result);
-        mZonesManagerPtr->handleStartZoneCall(data, rb);
-    }
-
-    if (methodName == api::dbus::METHOD_LOCK_ZONE) {
-        api::ZoneId data;
-        cargo::loadFromGVariant(parameters, data);
-
-        auto rb = std::make_shared<api::DbusMethodResultBuilder<api::Void>>(result);
-        mZonesManagerPtr->handleLockZoneCall(data, rb);
-        return;
-    }
-
-    if (methodName == api::dbus::METHOD_UNLOCK_ZONE) {
-        api::ZoneId data;
-        cargo::loadFromGVariant(parameters, data);
-
-        auto rb = std::make_shared<api::DbusMethodResultBuilder<api::Void>>(result);
-        mZonesManagerPtr->handleUnlockZoneCall(data, rb);
-        return;
-    }
-
-    if (methodName == api::dbus::METHOD_GRANT_DEVICE) {
-        api::GrantDeviceIn data;
-        cargo::loadFromGVariant(parameters, data);
-
-        auto rb = std::make_shared<api::DbusMethodResultBuilder<api::Void>>(result);
-        mZonesManagerPtr->handleGrantDeviceCall(data, rb);
-        return;
-    }
-
-    if (methodName == api::dbus::METHOD_REVOKE_DEVICE) {
-        api::RevokeDeviceIn data;
-        cargo::loadFromGVariant(parameters, data);
-
-        auto rb = std::make_shared<api::DbusMethodResultBuilder<api::Void>>(result);
-        mZonesManagerPtr->handleRevokeDeviceCall(data, rb);
-        return;
-    }
-
-    if (methodName == api::dbus::METHOD_CREATE_FILE) {
-        api::CreateFileIn data;
-        cargo::loadFromGVariant(parameters, data);
-
-        auto rb = std::make_shared<api::DbusMethodResultBuilder<api::CreateFileOut>>(result);
-        mZonesManagerPtr->handleCreateFileCall(data, rb);
-        return;
-    }
-
-    if (methodName == api::dbus::METHOD_SWITCH_TO_DEFAULT) {
-        auto rb = std::make_shared<api::DbusMethodResultBuilder<api::Void>>(result);
-        mZonesManagerPtr->handleSwitchToDefaultCall(EMPTY_CALLER, rb);
-        return;
-    }
-
-    if (methodName == api::dbus::METHOD_CLEAN_UP_ZONES_ROOT) {
-        auto rb = std::make_shared<api::DbusMethodResultBuilder<api::Void>>(result);
-        mZonesManagerPtr->handleCleanUpZonesRootCall(rb);
-        return;
+    const auto it = mMethodHandlers.find(methodName);
+    if (it != mMethodHandlers.end()) {
+        it->second(parameters, result);
     }
 }
 
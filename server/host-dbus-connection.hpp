@@ -34,6 +34,7 @@
 #include <mutex>
 #include <condition_variable>
 #include <tuple>
+#include <unordered_map>
 #include <vector>
 
 
@@ -74,6 +75,12 @@ public:
                         const dbus::DbusConnection::AsyncMethodCallCallback& callback);
 
 private:
+    class MethodRegistrar;
+
+    typedef std::function<void(GVariant* parameters,
+                               dbus::MethodResultBuilder::Pointer result
+                              )> MethodHandler;
+
     dbus::DbusConnection::Pointer mDbusConnection;
     std::mutex mNameMutex;
     std::condition_variable mNameCondition;
@@ -82,6 +89,7 @@ private:
     dbus::DbusConnection::SubscriptionId mSubscriptionId;
     ProxyCallCallback mProxyCallCallback;
     ZonesManager* mZonesManagerPtr;
+    std::unordered_map<std::string, MethodHandler> mMethodHandlers;
 
     void onNameAcquired();
     void onNameLost();
@@ -47,9 +47,13 @@ const std::string METHOD_CREATE_NETDEV_MACVLAN    = "CreateNetdevMacvlan";
 const std::string METHOD_CREATE_NETDEV_PHYS       = "CreateNetdevPhys";
 const std::string METHOD_DESTROY_NETDEV           = "DestroyNetdev";
 const std::string METHOD_DELETE_NETDEV_IP_ADDRESS = "DeleteNetdevIpAddress";
+const std::string METHOD_NETDEV_APPLY             = "NetdevApply";
+const std::string METHOD_SET_NETDEV_BANDWIDTH     = "SetNetdevBandwidth";
+const std::string METHOD_GET_NETDEV_STATS         = "GetNetdevStats";
 const std::string METHOD_DECLARE_FILE             = "DeclareFile";
 const std::string METHOD_DECLARE_MOUNT            = "DeclareMount";
 const std::string METHOD_DECLARE_LINK             = "DeclareLink";
+const std::string METHOD_DECLARE_BATCH            = "DeclareBatch";
 const std::string METHOD_GET_DECLARATIONS         = "GetDeclarations";
 const std::string METHOD_REMOVE_DECLARATION       = "RemoveDeclaration";
 const std::string METHOD_SET_ACTIVE_ZONE          = "SetActiveZone";
@@ -126,6 +130,30 @@ const std::string DEFINITION =
     "      <arg type='s' name='devId' direction='in'/>"
     "      <arg type='s' name='ip' direction='in'/>"
     "    </method>"
+    "    <method name='" + METHOD_NETDEV_APPLY + "'>"
+    "      <arg type='s' name='zone' direction='in'/>"
+    "      <arg type='s' name='netDev' direction='in'/>"
+    "      <arg type='i' name='type' direction='in'/>"
+    "      <arg type='s' name='hostDev' direction='in'/>"
+    "      <arg type='u' name='macvlanMode' direction='in'/>"
+    "      <arg type='u' name='mtu' direction='in'/>"
+    "      <arg type='s' name='mac' direction='in'/>"
+    "      <arg type='as' name='addresses' direction='in'/>"
+    "      <arg type='a(ssu)' name='routes' direction='in'/>"
+    "      <arg type='b' name='up' direction='in'/>"
+    "      <arg type='as' name='changes' direction='out'/>"
+    "    </method>"
+    "    <method name='" + METHOD_SET_NETDEV_BANDWIDTH + "'>"
+    "      <arg type='s' name='zone' direction='in'/>"
+    "      <arg type='s' name='netDev' direction='in'/>"
+    "      <arg type='t' name='downloadRate' direction='in'/>"
+    "      <arg type='t' name='uploadRate' direction='in'/>"
+    "      <arg type='u' name='burst' direction='in'/>"
+    "    </method>"
+    "    <method name='" + METHOD_GET_NETDEV_STATS + "'>"
+    "      <arg type='s' name='zone' direction='in'/>"
+    "      <arg type='a(stttttttttttt)' name='stats' direction='out'/>"
+    "    </method>"
     "    <method name='" + METHOD_DECLARE_FILE + "'>"
     "      <arg type='s' name='zone' direction='in'/>"
     "      <arg type='i' name='type' direction='in'/>"
@@ -149,6 +177,11 @@ const std::string DEFINITION =
     "      <arg type='s' name='target' direction='in'/>"
     "      <arg type='s' name='id' direction='out'/>"
     "    </method>"
+    "    <method name='" + METHOD_DECLARE_BATCH + "'>"
+    "      <arg type='s' name='zone' direction='in'/>"
+    "      <arg type='a(iissstis)' name='declarations' direction='in'/>"
+    "      <arg type='as' name='ids' direction='out'/>"
+    "    </method>"
     "    <method name='" + METHOD_GET_DECLARATIONS + "'>"
     "      <arg type='s' name='zone' direction='in'/>"
     "      <arg type='as' name='list' direction='out'/>"
@@ -28,6 +28,7 @@
 
 #include "host-ipc-connection.hpp"
 #include "host-ipc-definitions.hpp"
+#include "host-methods.hpp"
 #include "exception.hpp"
 #include "logger/logger.hpp"
 #include "zones-manager.hpp"
@@ -35,6 +36,45 @@
 
 namespace vasum {
 
+/**
+ * Registers every method from the host method table in the IPC service
+ */
+class HostIPCConnection::MethodRegistrar {
+public:
+    MethodRegistrar(HostIPCConnection& connection)
+        : mConnection(connection)
+    {
+    }
+
+    template<typename ArgIn, typename ArgOut>
+    void method(const std::string& /* dbusName */,
+                const ::cargo::ipc::MethodID ipcId,
+                void (ZonesManager::*handler)(const ArgIn&, api::MethodResultBuilder::Pointer))
+    {
+        using namespace std::placeholders;
+        typedef IPCMethodWrapper<const ArgIn, ArgOut> Callback;
+        mConnection.mService->setMethodHandler<typename Callback::out, typename Callback::in>(
+            ipcId,
+            Callback::getWrapper(std::bind(handler, mConnection.mZonesManagerPtr, _1, _2)));
+    }
+
+    template<typename ArgIn, typename ArgOut>
+    void method(const std::string& /* dbusName */,
+                const ::cargo::ipc::MethodID ipcId,
+                void (ZonesManager::*handler)(api::MethodResultBuilder::Pointer))
+    {
+        static_assert(std::is_same<ArgIn, api::Void>::value, "Handler without input arguments");
+        using namespace std::placeholders;
+        typedef IPCMethodWrapper<ArgOut> Callback;
+        mConnection.mService->setMethodHandler<typename Callback::out, typename Callback::in>(
+            ipcId,
+            Callback::getWrapper(std::bind(handler, mConnection.mZonesManagerPtr, _1)));
+    }
+
+private:
+    HostIPCConnection& mConnection;
+};
+
 HostIPCConnection::HostIPCConnection(cargo::ipc::epoll::EventPoll& eventPoll, ZonesManager* zonesManagerPtr)
     : mZonesManagerPtr(zonesManagerPtr)
 {
@@ -48,96 +88,8 @@ HostIPCConnection::HostIPCConnection(cargo::ipc::epoll::EventPoll& eventPoll, Zo
     mService.reset(new cargo::ipc::Service(eventPoll, HOST_IPC_SOCKET,
                                     nullptr, removedCallback));
 
-    using namespace std::placeholders;
-    setLockQueueCallback(std::bind(&ZonesManager::handleLockQueueCall,
-                                   mZonesManagerPtr, _1));
-
-    setUnlockQueueCallback(std::bind(&ZonesManager::handleUnlockQueueCall,
-                                     mZonesManagerPtr, _1));
-
-    setGetZoneIdsCallback(std::bind(&ZonesManager::handleGetZoneIdsCall,
-                                    mZonesManagerPtr, _1));
-
-    setGetActiveZoneIdCallback(std::bind(&ZonesManager::handleGetActiveZoneIdCall,
-                                         mZonesManagerPtr, _1));
-
-    setGetZoneInfoCallback(std::bind(&ZonesManager::handleGetZoneInfoCall,
-                                     mZonesManagerPtr, _1, _2));
-
-    setSetNetdevAttrsCallback(std::bind(&ZonesManager::handleSetNetdevAttrsCall,
-                                        mZonesManagerPtr, _1, _2));
-
-    setGetNetdevAttrsCallback(std::bind(&ZonesManager::handleGetNetdevAttrsCall,
-                                        mZonesManagerPtr, _1, _2));
-
-    setGetNetdevListCallback(std::bind(&ZonesManager::handleGetNetdevListCall,
-                                       mZonesManagerPtr, _1, _2));
-
-    setCreateNetdevVethCallback(std::bind(&ZonesManager::handleCreateNetdevVethCall,
-                                          mZonesManagerPtr, _1, _2));
-
-    setCreateNetdevMacvlanCallback(std::bind(&ZonesManager::handleCreateNetdevMacvlanCall,
-                                             mZonesManagerPtr, _1, _2));
-
-    setCreateNetdevPhysCallback(std::bind(&ZonesManager::handleCreateNetdevPhysCall,
-                                          mZonesManagerPtr, _1, _2));
-
-    setDestroyNetdevCallback(std::bind(&ZonesManager::handleDestroyNetdevCall,
-                                       mZonesManagerPtr, _1, _2));
-
-    setDeleteNetdevIpAddressCallback(std::bind(&ZonesManager::handleDeleteNetdevIpAddressCall,
-                                               mZonesManagerPtr, _1, _2));
-
-    setDeclareFileCallback(std::bind(&ZonesManager::handleDeclareFileCall,
-                                     mZonesManagerPtr, _1, _2));
-
-    setDeclareMountCallback(std::bind(&ZonesManager::handleDeclareMountCall,
-                                      mZonesManagerPtr, _1, _2));
-
-    setDeclareLinkCallback(std::bind(&ZonesManager::handleDeclareLinkCall,
-                                     mZonesManagerPtr, _1, _2));
-
-    setGetDeclarationsCallback(std::bind(&ZonesManager::handleGetDeclarationsCall,
-                                         mZonesManagerPtr, _1, _2));
-
-    setRemoveDeclarationCallback(std::bind(&ZonesManager::handleRemoveDeclarationCall,
-                                           mZonesManagerPtr, _1, _2));
-
-    setSetActiveZoneCallback(std::bind(&ZonesManager::handleSetActiveZoneCall,
-                                       mZonesManagerPtr, _1, _2));
-
-    setCreateZoneCallback(std::bind(&ZonesManager::handleCreateZoneCall,
-                                    mZonesManagerPtr, _1, _2));
-
-    setDestroyZoneCallback(std::bind(&ZonesManager::handleDestroyZoneCall,
-                                     mZonesManagerPtr, _1, _2));
-
-    setShutdownZoneCallback(std::bind(&ZonesManager::handleShutdownZoneCall,
-                                      mZonesManagerPtr, _1, _2));
-
-    setStartZoneCallback(std::bind(&ZonesManager::handleStartZoneCall,
-                                   mZonesManagerPtr, _1, _2));
-
-    setLockZoneCallback(std::bind(&ZonesManager::handleLockZoneCall,
-                                  mZonesManagerPtr, _1, _2));
-
-    setUnlockZoneCallback(std::bind(&ZonesManager::handleUnlockZoneCall,
-                                    mZonesManagerPtr, _1, _2));
-
-    setGrantDeviceCallback(std::bind(&ZonesManager::handleGrantDeviceCall,
-                                     mZonesManagerPtr, _1, _2));
-
-    setRevokeDeviceCallback(std::bind(&ZonesManager::handleRevokeDeviceCall,
-                                      mZonesManagerPtr, _1, _2));
-
-    setSwitchToDefaultCallback(std::bind(&ZonesManager::handleSwitchToDefaultCall,
-                                         mZonesManagerPtr, "", _1));
-
-    setCreateFileCallback(std::bind(&ZonesManager::handleCreateFileCall,
-                                    mZonesManagerPtr, _1, _2));
-
-    setCleanUpZonesRootCallback(std::bind(&ZonesManager::handleCleanUpZonesRootCall,
-                                          mZonesManagerPtr, _1));
+    MethodRegistrar registrar(*this);
+    forEachHostMethod(registrar);
 }
 
 HostIPCConnection::~HostIPCConnection()
@@ -162,245 +114,4 @@ bool HostIPCConnection::isRunning()
     return mService->isStarted();
 }
 
-void HostIPCConnection::setLockQueueCallback(const Method<api::Void>::type& callback)
-{
-    typedef IPCMethodWrapper<api::Void> Callback;
-    mService->setMethodHandler<Callback::out, Callback::in>(
-        api::cargo::ipc::METHOD_LOCK_QUEUE,
-        Callback::getWrapper(callback));
-}
-
-void HostIPCConnection::setUnlockQueueCallback(const Method<api::Void>::type& callback)
-{
-    typedef IPCMethodWrapper<api::Void> Callback;
-    mService->setMethodHandler<Callback::out, Callback::in>(
-        api::cargo::ipc::METHOD_UNLOCK_QUEUE,
-        Callback::getWrapper(callback));
-}
-
-void HostIPCConnection::setGetZoneIdsCallback(const Method<api::ZoneIds>::type& callback)
-{
-    typedef IPCMethodWrapper<api::ZoneIds> Callback;
-    mService->setMethodHandler<Callback::out, Callback::in>(
-        api::cargo::ipc::METHOD_GET_ZONE_ID_LIST,
-        Callback::getWrapper(callback));
-}
-
-void HostIPCConnection::setGetActiveZoneIdCallback(const Method<api::ZoneId>::type& callback)
-{
-    typedef IPCMethodWrapper<api::ZoneId> Callback;
-    mService->setMethodHandler<Callback::out, Callback::in>(
-        api::cargo::ipc::METHOD_GET_ACTIVE_ZONE_ID,
-        Callback::getWrapper(callback));
-}
-
-void HostIPCConnection::setGetZoneInfoCallback(const Method<const api::ZoneId, api::ZoneInfoOut>::type& callback)
-{
-    typedef IPCMethodWrapper<const api::ZoneId, api::ZoneInfoOut> Callback;
-    mService->setMethodHandler<Callback::out, Callback::in>(
-        api::cargo::ipc::METHOD_GET_ZONE_INFO,
-        Callback::getWrapper(callback));
-}
-
-void HostIPCConnection::setSetNetdevAttrsCallback(const Method<const api::SetNetDevAttrsIn>::type& callback)
-{
-    typedef IPCMethodWrapper<const api::SetNetDevAttrsIn> Callback;
-    mService->setMethodHandler<Callback::out, Callback::in>(
-        api::cargo::ipc::METHOD_SET_NETDEV_ATTRS,
-        Callback::getWrapper(callback));
-}
-
-void HostIPCConnection::setGetNetdevAttrsCallback(const Method<const api::GetNetDevAttrsIn, api::GetNetDevAttrs>::type& callback)
-{
-    typedef IPCMethodWrapper<const api::GetNetDevAttrsIn, api::GetNetDevAttrs> Callback;
-    mService->setMethodHandler<Callback::out, Callback::in>(
-        api::cargo::ipc::METHOD_GET_NETDEV_ATTRS,
-        Callback::getWrapper(callback));
-}
-
-void HostIPCConnection::setGetNetdevListCallback(const Method<const api::ZoneId, api::NetDevList>::type& callback)
-{
-    typedef IPCMethodWrapper<const api::ZoneId, api::NetDevList> Callback;
-    mService->setMethodHandler<Callback::out, Callback::in>(
-        api::cargo::ipc::METHOD_GET_NETDEV_LIST,
-        Callback::getWrapper(callback));
-}
-
-void HostIPCConnection::setCreateNetdevVethCallback(const Method<const api::CreateNetDevVethIn>::type& callback)
-{
-    typedef IPCMethodWrapper<const api::CreateNetDevVethIn> Callback;
-    mService->setMethodHandler<Callback::out, Callback::in>(
-        api::cargo::ipc::METHOD_CREATE_NETDEV_VETH,
-        Callback::getWrapper(callback));
-}
-
-void HostIPCConnection::setCreateNetdevMacvlanCallback(const Method<const api::CreateNetDevMacvlanIn>::type& callback)
-{
-    typedef IPCMethodWrapper<const api::CreateNetDevMacvlanIn> Callback;
-    mService->setMethodHandler<Callback::out, Callback::in>(
-        api::cargo::ipc::METHOD_CREATE_NETDEV_MACVLAN,
-        Callback::getWrapper(callback));
-}
-
-void HostIPCConnection::setCreateNetdevPhysCallback(const Method<const api::CreateNetDevPhysIn>::type& callback)
-{
-    typedef IPCMethodWrapper<const api::CreateNetDevPhysIn> Callback;
-    mService->setMethodHandler<Callback::out, Callback::in>(
-        api::cargo::ipc::METHOD_CREATE_NETDEV_PHYS,
-        Callback::getWrapper(callback));
-}
-
-void HostIPCConnection::setDestroyNetdevCallback(const Method<const api::DestroyNetDevIn>::type& callback)
-{
-    typedef IPCMethodWrapper<const api::DestroyNetDevIn> Callback;
-    mService->setMethodHandler<Callback::out, Callback::in>(
-        api::cargo::ipc::METHOD_DESTROY_NETDEV,
-        Callback::getWrapper(callback));
-}
-
-void HostIPCConnection::setDeleteNetdevIpAddressCallback(const Method<const api::DeleteNetdevIpAddressIn>::type& callback)
-{
-    typedef IPCMethodWrapper<const api::DeleteNetdevIpAddressIn> Callback;
-    mService->setMethodHandler<Callback::out, Callback::in>(
-        api::cargo::ipc::METHOD_DELETE_NETDEV_IP_ADDRESS,
-        Callback::getWrapper(callback));
-}
-
-void HostIPCConnection::setDeclareFileCallback(const Method<const api::DeclareFileIn, api::Declaration>::type& callback)
-{
-    typedef IPCMethodWrapper<const api::DeclareFileIn, api::Declaration> Callback;
-    mService->setMethodHandler<Callback::out, Callback::in>(
-        api::cargo::ipc::METHOD_DECLARE_FILE,
-        Callback::getWrapper(callback));
-}
-
-void HostIPCConnection::setDeclareMountCallback(const Method<const api::DeclareMountIn, api::Declaration>::type& callback)
-{
-    typedef IPCMethodWrapper<const api::DeclareMountIn, api::Declaration> Callback;
-    mService->setMethodHandler<Callback::out, Callback::in>(
-        api::cargo::ipc::METHOD_DECLARE_MOUNT,
-        Callback::getWrapper(callback));
-}
-
-void HostIPCConnection::setDeclareLinkCallback(const Method<const api::DeclareLinkIn, api::Declaration>::type& callback)
-{
-    typedef IPCMethodWrapper<const api::DeclareLinkIn, api::Declaration> Callback;
-    mService->setMethodHandler<Callback::out, Callback::in>(
-        api::cargo::ipc::METHOD_DECLARE_LINK,
-        Callback::getWrapper(callback));
-}
-
-void HostIPCConnection::setGetDeclarationsCallback(const Method<const api::ZoneId, api::Declarations>::type& callback)
-{
-    typedef IPCMethodWrapper<const api::ZoneId, api::Declarations> Callback;
-    mService->setMethodHandler<Callback::out, Callback::in>(
-        api::cargo::ipc::METHOD_GET_DECLARATIONS,
-        Callback::getWrapper(callback));
-}
-
-void HostIPCConnection::setRemoveDeclarationCallback(const Method<const api::RemoveDeclarationIn>::type& callback)
-{
-    typedef IPCMethodWrapper<const api::RemoveDeclarationIn> Callback;
-    mService->setMethodHandler<Callback::out, Callback::in>(
-        api::cargo::ipc::METHOD_REMOVE_DECLARATION,
-        Callback::getWrapper(callback));
-}
-
-void HostIPCConnection::setSetActiveZoneCallback(const Method<const api::ZoneId>::type& callback)
-{
-    typedef IPCMethodWrapper<const api::ZoneId> Callback;
-    mService->setMethodHandler<Callback::out, Callback::in>(
-        api::cargo::ipc::METHOD_SET_ACTIVE_ZONE,
-        Callback::getWrapper(callback));
-}
-
-void HostIPCConnection::setCreateZoneCallback(const Method<const api::CreateZoneIn>::type& callback)
-{
-    typedef IPCMethodWrapper<const api::CreateZoneIn> Callback;
-    mService->setMethodHandler<Callback::out, Callback::in>(
-        api::cargo::ipc::METHOD_CREATE_ZONE,
-        Callback::getWrapper(callback));
-}
-
-void HostIPCConnection::setDestroyZoneCallback(const Method<const api::ZoneId>::type& callback)
-{
-    typedef IPCMethodWrapper<const api::ZoneId> Callback;
-    mService->setMethodHandler<Callback::out, Callback::in>(
-        api::cargo::ipc::METHOD_DESTROY_ZONE,
-        Callback::getWrapper(callback));
-}
-
-void HostIPCConnection::setShutdownZoneCallback(const Method<const api::ZoneId>::type& callback)
-{
-    typedef IPCMethodWrapper<const api::ZoneId> Callback;
-    mService->setMethodHandler<Callback::out, Callback::in>(
-        api::cargo::ipc::METHOD_SHUTDOWN_ZONE,
-        Callback::getWrapper(callback));
-}
-
-void HostIPCConnection::setStartZoneCallback(const Method<const api::ZoneId>::type& callback)
-{
-    typedef IPCMethodWrapper<const api::ZoneId> Callback;
-    mService->setMethodHandler<Callback::out, Callback::in>(
-        api::cargo::ipc::METHOD_START_ZONE,
-        Callback::getWrapper(callback));
-}
-
-void HostIPCConnection::setLockZoneCallback(const Method<const api::ZoneId>::type& callback)
-{
-    typedef IPCMethodWrapper<const api::ZoneId> Callback;
-    mService->setMethodHandler<Callback::out, Callback::in>(
-        api::cargo::ipc::METHOD_LOCK_ZONE,
-        Callback::getWrapper(callback));
-}
-
-void HostIPCConnection::setUnlockZoneCallback(const Method<const api::ZoneId>::type& callback)
-{
-    typedef IPCMethodWrapper<const api::ZoneId> Callback;
-    mService->setMethodHandler<Callback::out, Callback::in>(
-        api::cargo::ipc::METHOD_UNLOCK_ZONE,
-        Callback::getWrapper(callback));
-}
-
-void HostIPCConnection::setGrantDeviceCallback(const Method<const api::GrantDeviceIn>::type& callback)
-{
-    typedef IPCMethodWrapper<const api::GrantDeviceIn> Callback;
-    mService->setMethodHandler<Callback::out, Callback::in>(
-        api::cargo::ipc::METHOD_GRANT_DEVICE,
-        Callback::getWrapper(callback));
-}
-
-void HostIPCConnection::setRevokeDeviceCallback(const Method<const api::RevokeDeviceIn>::type& callback)
-{
-    typedef IPCMethodWrapper<const api::RevokeDeviceIn> Callback;
-    mService->setMethodHandler<Callback::out, Callback::in>(
-        api::cargo::ipc::METHOD_REVOKE_DEVICE,
-        Callback::getWrapper(callback));
-}
-
-void HostIPCConnection::setSwitchToDefaultCallback(const Method<api::Void>::type& callback)
-{
-    typedef IPCMethodWrapper<api::Void> Callback;
-    mService->setMethodHandler<Callback::out, Callback::in>(
-        api::cargo::ipc::METHOD_SWITCH_TO_DEFAULT,
-        Callback::getWrapper(callback));
-}
-
-void HostIPCConnection::setCreateFileCallback(const Method<const api::CreateFileIn,
-                                              api::CreateFileOut>::type& callback)
-{
-    typedef IPCMethodWrapper<const api::CreateFileIn, api::CreateFileOut> Method;
-    mService->setMethodHandler<Method::out, Method::in>(
-        api::cargo::ipc::METHOD_CREATE_FILE,
-        Method::getWrapper(callback));
-}
-
-void HostIPCConnection::setCleanUpZonesRootCallback(const Method<api::Void>::type& callback)
-{
-    typedef IPCMethodWrapper<api::Void> Callback;
-    mService->setMethodHandler<Callback::out, Callback::in>(
-        api::cargo::ipc::METHOD_CLEAN_UP_ZONES_ROOT,
-        Callback::getWrapper(callback));
-}
-
 } // namespace vasum
@@ -62,6 +62,10 @@ const ::cargo::ipc::MethodID METHOD_LOCK_QUEUE               = 28;
 const ::cargo::ipc::MethodID METHOD_UNLOCK_QUEUE             = 29;
 const ::cargo::ipc::MethodID METHOD_SWITCH_TO_DEFAULT        = 30;
 const ::cargo::ipc::MethodID METHOD_CLEAN_UP_ZONES_ROOT      = 31;
+const ::cargo::ipc::MethodID METHOD_DECLARE_BATCH            = 32;
+const ::cargo::ipc::MethodID METHOD_NETDEV_APPLY             = 33;
+const ::cargo::ipc::MethodID METHOD_SET_NETDEV_BANDWIDTH     = 34;
+const ::cargo::ipc::MethodID METHOD_GET_NETDEV_STATS         = 35;
 
 } // namespace ipc
 } // namespace cargo
@@ -0,0 +1,135 @@
+/*
+ *  Copyright (c) 2015 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *  Contact: agent <agent@local>
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License
+ */
+
+/**
+ * @file
+ * @author  agent (agent@local)
+ * @brief   Table of host API methods shared by the IPC and D-Bus frontends
+ */
+
+
+#ifndef SERVER_HOST_METHODS_HPP
+#define SERVER_HOST_METHODS_HPP
+
+#include "zones-manager.hpp"
+#include "host-ipc-definitions.hpp"
+#include "host-dbus-definitions.hpp"
+#include "api/messages.hpp"
+
+
+namespace vasum {
+
+/**
+ * Calls the visitor once for every host API method.
+ *
+ * The visitor has to provide two overloads of a method template:
+ *
+ * template<typename ArgIn, typename ArgOut>
+ * void method(const std::string& dbusName,
+ *             const ::cargo::ipc::MethodID ipcId,
+ *             void (ZonesManager::*handler)(const ArgIn&, api::MethodResultBuilder::Pointer));
+ *
+ * template<typename ArgIn, typename ArgOut>
+ * void method(const std::string& dbusName,
+ *             const ::cargo::ipc::MethodID ipcId,
+ *             void (ZonesManager::*handler)(api::MethodResultBuilder::Pointer));
+ *
+ * The second one is used for methods without input arguments (ArgIn is api::Void).
+ * Both frontends register exactly the methods listed here.
+ */
+template<typename Visitor>
+void forEachHostMethod(Visitor& v)
+{
+    namespace dbus = api::dbus;
+    namespace ipc = api::cargo::ipc;
+    typedef ZonesManager ZM;
+
+    v.template method<api::Void, api::Void>(dbus::METHOD_LOCK_QUEUE, ipc::METHOD_LOCK_QUEUE,
+                                            &ZM::handleLockQueueCall);
+    v.template method<api::Void, api::Void>(dbus::METHOD_UNLOCK_QUEUE, ipc::METHOD_UNLOCK_QUEUE,
+                                            &ZM::handleUnlockQueueCall);
+    v.template method<api::Void, api::ZoneIds>(dbus::METHOD_GET_ZONE_ID_LIST, ipc::METHOD_GET_ZONE_ID_LIST,
+                                               &ZM::handleGetZoneIdsCall);
+    v.template method<api::Void, api::ZoneId>(dbus::METHOD_GET_ACTIVE_ZONE_ID, ipc::METHOD_GET_ACTIVE_ZONE_ID,
+                                              &ZM::handleGetActiveZoneIdCall);
+    v.template method<api::ZoneId, api::ZoneInfoOut>(dbus::METHOD_GET_ZONE_INFO, ipc::METHOD_GET_ZONE_INFO,
+                                                     &ZM::handleGetZoneInfoCall);
+    v.template method<api::SetNetDevAttrsIn, api::Void>(dbus::METHOD_SET_NETDEV_ATTRS, ipc::METHOD_SET_NETDEV_ATTRS,
+                                                        &ZM::handleSetNetdevAttrsCall);
+    v.template method<api::GetNetDevAttrsIn, api::GetNetDevAttrs>(dbus::METHOD_GET_NETDEV_ATTRS, ipc::METHOD_GET_NETDEV_ATTRS,
+                                                                  &ZM::handleGetNetdevAttrsCall);
+    v.template method<api::ZoneId, api::NetDevList>(dbus::METHOD_GET_NETDEV_LIST, ipc::METHOD_GET_NETDEV_LIST,
+                                                    &ZM::handleGetNetdevListCall);
+    v.template method<api::CreateNetDevVethIn, api::Void>(dbus::METHOD_CREATE_NETDEV_VETH, ipc::METHOD_CREATE_NETDEV_VETH,
+                                                          &ZM::handleCreateNetdevVethCall);
+    v.template method<api::CreateNetDevMacvlanIn, api::Void>(dbus::METHOD_CREATE_NETDEV_MACVLAN, ipc::METHOD_CREATE_NETDEV_MACVLAN,
+                                                             &ZM::handleCreateNetdevMacvlanCall);
+    v.template method<api::CreateNetDevPhysIn, api::Void>(dbus::METHOD_CREATE_NETDEV_PHYS, ipc::METHOD_CREATE_NETDEV_PHYS,
+                                                          &ZM::handleCreateNetdevPhysCall);
+    v.template method<api::DestroyNetDevIn, api::Void>(dbus::METHOD_DESTROY_NETDEV, ipc::METHOD_DESTROY_NETDEV,
+                                                       &ZM::handleDestroyNetdevCall);
+    v.template method<api::DeleteNetdevIpAddressIn, api::Void>(dbus::METHOD_DELETE_NETDEV_IP_ADDRESS, ipc::METHOD_DELETE_NETDEV_IP_ADDRESS,
+                                                               &ZM::handleDeleteNetdevIpAddressCall);
+    v.template method<api::NetDevApplyIn, api::NetDevApplyOut>(dbus::METHOD_NETDEV_APPLY, ipc::METHOD_NETDEV_APPLY,
+                                                               &ZM::handleNetdevApplyCall);
+    v.template method<api::SetNetDevBandwidthIn, api::Void>(dbus::METHOD_SET_NETDEV_BANDWIDTH, ipc::METHOD_SET_NETDEV_BANDWIDTH,
+                                                            &ZM::handleSetNetdevBandwidthCall);
+    v.template method<api::ZoneId, api::NetDevStatsOut>(dbus::METHOD_GET_NETDEV_STATS, ipc::METHOD_GET_NETDEV_STATS,
+                                                         &ZM::handleGetNetdevStatsCall);
+    v.template method<api::DeclareFileIn, api::Declaration>(dbus::METHOD_DECLARE_FILE, ipc::METHOD_DECLARE_FILE,
+                                                            &ZM::handleDeclareFileCall);
+    v.template method<api::DeclareMountIn, api::Declaration>(dbus::METHOD_DECLARE_MOUNT, ipc::METHOD_DECLARE_MOUNT,
+                                                             &ZM::handleDeclareMountCall);
+    v.template method<api::DeclareLinkIn, api::Declaration>(dbus::METHOD_DECLARE_LINK, ipc::METHOD_DECLARE_LINK,
+                                                            &ZM::handleDeclareLinkCall);
+    v.template method<api::DeclareBatchIn, api::Declarations>(dbus::METHOD_DECLARE_BATCH, ipc::METHOD_DECLARE_BATCH,
+                                                               &ZM::handleDeclareBatchCall);
+    v.template method<api::ZoneId, api::Declarations>(dbus::METHOD_GET_DECLARATIONS, ipc::METHOD_GET_DECLARATIONS,
+                                                      &ZM::handleGetDeclarationsCall);
+    v.template method<api::RemoveDeclarationIn, api::Void>(dbus::METHOD_REMOVE_DECLARATION, ipc::METHOD_REMOVE_DECLARATION,
+                                                           &ZM::handleRemoveDeclarationCall);
+    v.template method<api::ZoneId, api::Void>(dbus::METHOD_SET_ACTIVE_ZONE, ipc::METHOD_SET_ACTIVE_ZONE,
+                                              &ZM::handleSetActiveZoneCall);
+    v.template method<api::CreateZoneIn, api::Void>(dbus::METHOD_CREATE_ZONE, ipc::METHOD_CREATE_ZONE,
+                                                    &ZM::handleCreateZoneCall);
+    v.template method<api::ZoneId, api::Void>(dbus::METHOD_DESTROY_ZONE, ipc::METHOD_DESTROY_ZONE,
+                                              &ZM::handleDestroyZoneCall);
+    v.template method<api::ZoneId, api::Void>(dbus::METHOD_SHUTDOWN_ZONE, ipc::METHOD_SHUTDOWN_ZONE,
+                                              &ZM::handleShutdownZoneCall);
+    v.template method<api::ZoneId, api::Void>(dbus::METHOD_START_ZONE, ipc::METHOD_START_ZONE,
+                                              &ZM::handleStartZoneCall);
+    v.template method<api::ZoneId, api::Void>(dbus::METHOD_LOCK_ZONE, ipc::METHOD_LOCK_ZONE,
+                                              &ZM::handleLockZoneCall);
+    v.template method<api::ZoneId, api::Void>(dbus::METHOD_UNLOCK_ZONE, ipc::METHOD_UNLOCK_ZONE,
+                                              &ZM::handleUnlockZoneCall);
+    v.template method<api::GrantDeviceIn, api::Void>(dbus::METHOD_GRANT_DEVICE, ipc::METHOD_GRANT_DEVICE,
+                                                     &ZM::handleGrantDeviceCall);
+    v.template method<api::RevokeDeviceIn, api::Void>(dbus::METHOD_REVOKE_DEVICE, ipc::METHOD_REVOKE_DEVICE,
+                                                      &ZM::handleRevokeDeviceCall);
+    v.template method<api::CreateFileIn, api::CreateFileOut>(dbus::METHOD_CREATE_FILE, ipc::METHOD_CREATE_FILE,
+                                                             &ZM::handleCreateFileCall);
+    v.template method<api::Void, api::Void>(dbus::METHOD_SWITCH_TO_DEFAULT, ipc::METHOD_SWITCH_TO_DEFAULT,
+                                            &ZM::handleSwitchToDefaultCall);
+    v.template method<api::Void, api::Void>(dbus::METHOD_CLEAN_UP_ZONES_ROOT, ipc::METHOD_CLEAN_UP_ZONES_ROOT,
+                                            &ZM::handleCleanUpZonesRootCall);
+}
+
+} // namespace vasum
+
+
+#endif // SERVER_HOST_METHODS_HPP
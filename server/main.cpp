@@ -58,6 +58,7 @@ const std::string CONFIG_PATH = "/etc/vasum/daemon.conf";
 int main(int argc, char* argv[])
 {
     bool runAsRoot = false;
+    int handoffFD = -1;
     try {
 #ifndef NDEBUG
         const char *defaultLoggingBackend = "stderr";
@@ -81,6 +82,8 @@ int main(int argc, char* argv[])
         ("log-file,f", po::value<std::string>()->default_value("vasum.log"),
                           "set filename for file logging, optional")
         ("check,c", "check runtime environment and exit")
+        ("handoff-fd", po::value<int>()->default_value(-1),
+                       "fd with runtime state handed over on update (internal)")
         ("version,v", "show application version")
         ;
 
@@ -152,6 +155,7 @@ int main(int argc, char* argv[])
         }
 
         runAsRoot = vm.count("root") > 0;
+        handoffFD = vm["handoff-fd"].as<int>();
 
     } catch (std::exception& e) {
         std::cerr << e.what() << std::endl;
@@ -167,7 +171,7 @@ int main(int argc, char* argv[])
         utils::signalIgnore({SIGTERM});
 
         LOGI("Starting daemon...");
-        Server server(CONFIG_PATH);
+        Server server(CONFIG_PATH, handoffFD);
         server.run(runAsRoot);
         server.reloadIfRequired(argv);
         LOGI("Daemon stopped");
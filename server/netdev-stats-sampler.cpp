@@ -0,0 +1,122 @@
+/*
+ *  Copyright (c) 2015 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *  Contact: agent <agent@local>
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License
+ */
+
+/**
+ * @file
+ * @author  agent (agent@local)
+ * @brief   Periodic sampling of zones network traffic definition
+ */
+
+#include "config.hpp"
+
+#include "netdev-stats-sampler.hpp"
+#include "zones-manager.hpp"
+#include "exception.hpp"
+
+#include "logger/logger.hpp"
+#include "utils/exception.hpp"
+#include "utils/fd-utils.hpp"
+
+#include <cstdint>
+#include <functional>
+#include <sys/timerfd.h>
+
+
+namespace vasum {
+
+NetdevStatsSampler::NetdevStatsSampler(cargo::ipc::epoll::EventPoll& eventPoll,
+                                       unsigned int intervalMs,
+                                       ZonesManager* zonesManager)
+    : mEventPoll(eventPoll)
+    , mIntervalMs(intervalMs)
+    , mZonesManager(zonesManager)
+    , mFd(-1)
+    , mSampling(false)
+    , mWorker(utils::Worker::create())
+{
+}
+
+NetdevStatsSampler::~NetdevStatsSampler()
+{
+    LOGD("Destroying NetdevStatsSampler");
+    stop();
+}
+
+void NetdevStatsSampler::start()
+{
+    using namespace std::placeholders;
+
+    if (mFd != -1) {
+        return;
+    }
+
+    mFd = ::timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (mFd < 0) {
+        const std::string msg = "Can't create network statistics timer: " + utils::getSystemErrorMessage();
+        LOGE(msg);
+        throw ServerException(msg);
+    }
+
+    itimerspec spec;
+    spec.it_interval.tv_sec = mIntervalMs / 1000;
+    spec.it_interval.tv_nsec = (mIntervalMs % 1000) * 1000000L;
+    spec.it_value = spec.it_interval;
+    if (::timerfd_settime(mFd, 0, &spec, nullptr) < 0) {
+        const std::string msg = "Can't start network statistics timer: " + utils::getSystemErrorMessage();
+        LOGE(msg);
+        utils::close(mFd);
+        mFd = -1;
+        throw ServerException(msg);
+    }
+
+    mEventPoll.addFD(mFd, EPOLLIN, std::bind(&NetdevStatsSampler::handleInternal, this, _1, _2));
+}
+
+void NetdevStatsSampler::stop()
+{
+    if (mFd != -1) {
+        mEventPoll.removeFD(mFd);
+        utils::close(mFd);
+        mFd = -1;
+        // wait for a sample in progress
+        mWorker->addTaskAndWait([] {});
+    }
+}
+
+void NetdevStatsSampler::handleInternal(int /* fd */, cargo::ipc::epoll::Events /* events */)
+{
+    std::uint64_t expirations;
+    try {
+        utils::read(mFd, &expirations, sizeof(expirations));
+    } catch (const std::exception& ex) {
+        LOGE("Read from network statistics timer failed: " << ex.what());
+        return;
+    }
+
+    if (mSampling.exchange(true)) {
+        LOGD("Previous network statistics sample is not finished, skipping");
+        return;
+    }
+
+    mWorker->addTask([this] {
+        mZonesManager->sampleNetdevStats();
+        mSampling = false;
+    });
+}
+
+} // namespace vasum
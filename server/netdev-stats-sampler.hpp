@@ -0,0 +1,72 @@
+/*
+ *  Copyright (c) 2015 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *  Contact: agent <agent@local>
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License
+ */
+
+/**
+ * @file
+ * @author  agent (agent@local)
+ * @brief   Periodic sampling of zones network traffic declaration
+ */
+
+#ifndef SERVER_NETDEV_STATS_SAMPLER_HPP
+#define SERVER_NETDEV_STATS_SAMPLER_HPP
+
+#include "cargo-ipc/epoll/event-poll.hpp"
+#include "utils/worker.hpp"
+
+#include <atomic>
+
+
+namespace vasum {
+
+class ZonesManager;
+
+/**
+ * Calls ZonesManager::sampleNetdevStats() periodically
+ *
+ * A timerfd is dispatched by the server event poll, but sampling runs on a worker
+ * thread of the sampler, so netlink dumps don't delay other events of the server.
+ * A tick is skipped while the previous sample is still being taken.
+ */
+class NetdevStatsSampler {
+public:
+    NetdevStatsSampler(cargo::ipc::epoll::EventPoll& eventPoll,
+                       unsigned int intervalMs,
+                       ZonesManager* zonesManager);
+    ~NetdevStatsSampler();
+
+    NetdevStatsSampler(const NetdevStatsSampler&) = delete;
+    NetdevStatsSampler& operator=(const NetdevStatsSampler&) = delete;
+
+    void start();
+    void stop();
+
+private:
+    cargo::ipc::epoll::EventPoll& mEventPoll;
+    unsigned int mIntervalMs;
+    ZonesManager* mZonesManager;
+    int mFd;
+    std::atomic<bool> mSampling;
+    utils::Worker::Pointer mWorker;
+
+    void handleInternal(int fd, cargo::ipc::epoll::Events events);
+};
+
+} // namespace vasum
+
+
+#endif // SERVER_NETDEV_STATS_SAMPLER_HPP
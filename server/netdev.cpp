@@ -25,6 +25,7 @@
 #include "config.hpp"
 
 #include "netdev.hpp"
+#include "veth-name-allocator.hpp"
 #include "netlink/netlink-message.hpp"
 #include "utils/make-clean.hpp"
 #include "utils/exception.hpp"
@@ -33,12 +34,18 @@
 #include "logger/logger.hpp"
 
 #include <algorithm>
+#include <array>
+#include <limits>
 #include <string>
 #include <cstdint>
 #include <cstring>
 #include <cassert>
 #include <sstream>
+#include <iomanip>
+#include <cstdio>
+#include <map>
 #include <set>
+#include <cctype>
 
 #include <boost/algorithm/string/split.hpp>
 #include <boost/algorithm/string/classification.hpp>
@@ -47,13 +54,16 @@
 #include <unistd.h>
 #include <sys/ioctl.h>
 #include <arpa/inet.h>
-#include <ifaddrs.h>
+#include <net/ethernet.h>
 #include <linux/rtnetlink.h>
 #include <linux/veth.h>
 #include <linux/sockios.h>
 #include <linux/if_link.h>
 #include <linux/rtnetlink.h>
 #include <linux/if_bridge.h>
+#include <linux/if_ether.h>
+#include <linux/pkt_sched.h>
+#include <linux/pkt_cls.h>
 
 //IFLA_BRIDGE_FLAGS and BRIDGE_FLAGS_MASTER
 //should be defined in linux/if_bridge.h since kernel v3.7
@@ -73,28 +83,7 @@ namespace netdev {
 
 namespace {
 
-std::string getUniqueVethName()
-{
-    auto find = [](const ifaddrs* ifaddr, const std::string& name) -> bool {
-        for (const ifaddrs* ifa = ifaddr; ifa != NULL; ifa = ifa->ifa_next) {
-            if (name == ifa->ifa_name) {
-                return true;
-            }
-        }
-        return false;
-    };
-
-    ifaddrs* ifaddr;
-    getifaddrs(&ifaddr);
-    std::string newName;
-    int i = 0;
-    do {
-        newName = "veth0" + std::to_string(++i);
-    } while (find(ifaddr, newName));
-
-    freeifaddrs(ifaddr);
-    return newName;
-}
+VethNameAllocator gVethNameAllocator;
 
 uint32_t getInterfaceIndex(const std::string& name) {
     uint32_t index = if_nametoindex(name.c_str());
@@ -185,7 +174,7 @@ void attachToBridge(const std::string& bridge, const std::string& netdev)
     close(fd);
 }
 
-int setFlags(const std::string& name, uint32_t mask, uint32_t flags)
+NetlinkMessage setFlagsMessage(const std::string& name, uint32_t mask, uint32_t flags)
 {
     uint32_t index = getInterfaceIndex(name);
     NetlinkMessage nlm(RTM_NEWLINK, NLM_F_REQUEST | NLM_F_ACK);
@@ -196,16 +185,10 @@ int setFlags(const std::string& name, uint32_t mask, uint32_t flags)
     // since kernel v2.6.22 ifi_change is used to change only selected flags;
     infoPeer.ifi_change = mask;
     nlm.put(infoPeer);
-    send(nlm);
-    return 0;
+    return nlm;
 }
 
-void up(const std::string& netdev)
-{
-    setFlags(netdev, IFF_UP, IFF_UP);
-}
-
-void moveToNS(const std::string& netdev, pid_t pid)
+NetlinkMessage moveToNSMessage(const std::string& netdev, pid_t pid)
 {
     uint32_t index = getInterfaceIndex(netdev);
     NetlinkMessage nlm(RTM_NEWLINK, NLM_F_REQUEST | NLM_F_ACK);
@@ -214,7 +197,20 @@ void moveToNS(const std::string& netdev, pid_t pid)
     infopeer.ifi_index = index;
     nlm.put(infopeer)
         .put(IFLA_NET_NS_PID, pid);
-    send(nlm);
+    return nlm;
+}
+
+void moveToNS(const std::string& netdev, pid_t pid)
+{
+    send(moveToNSMessage(netdev, pid));
+}
+
+void upAndMoveToNS(const std::string& upNetdev, const std::string& nsNetdev, pid_t pid)
+{
+    NetlinkTransaction transaction;
+    transaction.add(setFlagsMessage(upNetdev, IFF_UP, IFF_UP))
+               .add(moveToNSMessage(nsNetdev, pid));
+    transaction.commit();
 }
 
 void createMacvlan(const std::string& master, const std::string& slave, const macvlan_mode& mode)
@@ -244,7 +240,9 @@ std::vector<Attrs> getIpAddresses(const pid_t nsPid, int family, uint32_t index)
     NetlinkMessage nlm(RTM_GETADDR, NLM_F_REQUEST | NLM_F_ACK | NLM_F_DUMP);
     ifaddrmsg infoAddr = utils::make_clean<ifaddrmsg>();
     infoAddr.ifa_family = family;
-    nlm.put(infoAddr);
+    infoAddr.ifa_index = index;
+    nlm.put(infoAddr)
+        .setStrictCheck();
     NetlinkResponse response = send(nlm, nsPid);
     if (!response.hasMessage()) {
         //There is no interfaces with addresses
@@ -371,23 +369,546 @@ void deleteIpAddress(const pid_t nsPid,
     send(nlm, nsPid);
 }
 
+
+// Kernel assigns this metric to IPv6 routes added without one (IP6_RT_PRIO_USER)
+const uint32_t IPV6_DEFAULT_METRIC = 1024;
+
+/**
+ * Address or network in canonical text form
+ */
+struct IpPrefix {
+    int family;
+    std::string ip;
+    int prefixlen;
+
+    std::string toString() const
+    {
+        return ip + "/" + std::to_string(prefixlen);
+    }
+};
+
+struct StaticRoute {
+    IpPrefix dst;
+    std::string gateway;
+    uint32_t metric;
+
+    std::string toString() const
+    {
+        return dst.toString() + (gateway.empty() ? "" : " via " + gateway) +
+               " metric " + std::to_string(metric);
+    }
+};
+
+struct LinkState {
+    uint32_t index;
+    uint32_t flags;
+    uint32_t mtu;
+    std::string mac;
+};
+
+std::string canonicalIp(int family, const std::string& ip)
+{
+    in6_addr addr;
+    char buf[INET6_ADDRSTRLEN];
+    if (inet_pton(family, ip.c_str(), &addr) != 1 || inet_ntop(family, &addr, buf, sizeof(buf)) == NULL) {
+        const std::string msg = "Wrong address format: " + ip;
+        LOGE(msg);
+        throw VasumException(msg);
+    }
+    return buf;
+}
+
+IpPrefix parsePrefix(const std::string& cidr)
+{
+    size_t slash = cidr.find('/');
+    if (slash == std::string::npos) {
+        const std::string msg = "Wrong address format: it is not CIDR notation: " + cidr;
+        LOGE(msg);
+        throw VasumException(msg);
+    }
+
+    IpPrefix prefix;
+    prefix.family = getIpFamily(cidr);
+    prefix.ip = canonicalIp(prefix.family, cidr.substr(0, slash));
+    const std::string len = cidr.substr(slash + 1);
+    const int maxLen = prefix.family == AF_INET6 ? 128 : 32;
+    if (len.empty() || len.size() > 3 || !std::all_of(len.begin(), len.end(), ::isdigit) ||
+        std::stoi(len) > maxLen) {
+        const std::string msg = "Wrong address format: invalid prefixlen: " + cidr;
+        LOGE(msg);
+        throw VasumException(msg);
+    }
+    prefix.prefixlen = std::stoi(len);
+    return prefix;
+}
+
+std::string parseMac(const std::string& mac)
+{
+    unsigned int bytes[ETH_ALEN];
+    char tail;
+    if (sscanf(mac.c_str(), "%2x:%2x:%2x:%2x:%2x:%2x%c",
+               &bytes[0], &bytes[1], &bytes[2], &bytes[3], &bytes[4], &bytes[5], &tail) != ETH_ALEN) {
+        const std::string msg = "Wrong MAC address format: " + mac;
+        LOGE(msg);
+        throw VasumException(msg);
+    }
+    return std::string(bytes, bytes + ETH_ALEN);
+}
+
+std::string formatMac(const std::string& mac)
+{
+    std::stringstream ss;
+    ss << std::hex << std::setfill('0');
+    for (size_t i = 0; i < mac.size(); ++i) {
+        ss << (i ? ":" : "") << std::setw(2) << static_cast<unsigned int>(static_cast<unsigned char>(mac[i]));
+    }
+    return ss.str();
+}
+
+void putIp(NetlinkMessage& nlm, int attr, int family, const std::string& ip)
+{
+    // ip is in canonical form, so it can be converted
+    if (family == AF_INET6) {
+        in6_addr addr6;
+        inet_pton(AF_INET6, ip.c_str(), &addr6);
+        nlm.put(attr, addr6);
+    } else {
+        in_addr addr4;
+        inet_pton(AF_INET, ip.c_str(), &addr4);
+        nlm.put(attr, addr4);
+    }
+}
+
+std::string fetchIp(NetlinkResponse& response, int attr, int family)
+{
+    char buf[INET6_ADDRSTRLEN];
+    in6_addr addr6;
+    in_addr addr4;
+    const void* addr;
+    if (family == AF_INET6) {
+        response.fetch(attr, addr6);
+        addr = &addr6;
+    } else {
+        response.fetch(attr, addr4);
+        addr = &addr4;
+    }
+    if (inet_ntop(family, addr, buf, sizeof(buf)) == NULL) {
+        const std::string msg = "Can't convert ip address: " + getSystemErrorMessage();
+        LOGE(msg);
+        throw VasumException(msg);
+    }
+    return buf;
+}
+
+NetlinkMessage addressMessage(uint16_t type, uint32_t index, const IpPrefix& address)
+{
+    const uint16_t flags = type == RTM_NEWADDR ? NLM_F_CREATE | NLM_F_EXCL : 0;
+    NetlinkMessage nlm(type, NLM_F_REQUEST | NLM_F_ACK | flags);
+    ifaddrmsg infoAddr = utils::make_clean<ifaddrmsg>();
+    infoAddr.ifa_family = address.family;
+    infoAddr.ifa_index = index;
+    infoAddr.ifa_prefixlen = address.prefixlen;
+    nlm.put(infoAddr);
+    if (address.family == AF_INET6) {
+        putIp(nlm, IFA_ADDRESS, address.family, address.ip);
+    }
+    putIp(nlm, IFA_LOCAL, address.family, address.ip);
+    return nlm;
+}
+
+NetlinkMessage routeMessage(uint16_t type, uint32_t index, const StaticRoute& route)
+{
+    const uint16_t flags = type == RTM_NEWROUTE ? NLM_F_CREATE | NLM_F_EXCL : 0;
+    NetlinkMessage nlm(type, NLM_F_REQUEST | NLM_F_ACK | flags);
+    rtmsg rt = utils::make_clean<rtmsg>();
+    rt.rtm_family = route.dst.family;
+    rt.rtm_dst_len = route.dst.prefixlen;
+    rt.rtm_table = RT_TABLE_MAIN;
+    rt.rtm_protocol = RTPROT_STATIC;
+    rt.rtm_type = RTN_UNICAST;
+    if (type == RTM_NEWROUTE) {
+        rt.rtm_scope = route.gateway.empty() ? RT_SCOPE_LINK : RT_SCOPE_UNIVERSE;
+    } else {
+        // any scope matches
+        rt.rtm_scope = RT_SCOPE_NOWHERE;
+    }
+    nlm.put(rt);
+    if (route.dst.prefixlen > 0) {
+        putIp(nlm, RTA_DST, route.dst.family, route.dst.ip);
+    }
+    if (!route.gateway.empty()) {
+        putIp(nlm, RTA_GATEWAY, route.dst.family, route.gateway);
+    }
+    nlm.put(RTA_OIF, index);
+    if (route.metric != 0) {
+        nlm.put(RTA_PRIORITY, route.metric);
+    }
+    return nlm;
+}
+
+LinkState getLinkState(const pid_t nsPid, const std::string& netdev)
+{
+    NetlinkMessage nlm(RTM_GETLINK, NLM_F_REQUEST | NLM_F_ACK);
+    ifinfomsg info = utils::make_clean<ifinfomsg>();
+    info.ifi_family = AF_UNSPEC;
+    info.ifi_change = 0xFFFFFFFF;
+    nlm.put(info)
+        .put(IFLA_IFNAME, netdev);
+    NetlinkResponse response = send(nlm, nsPid);
+    if (!response.hasMessage()) {
+        throw VasumException("Can't get interface information");
+    }
+    response.fetch(info);
+
+    LinkState link;
+    link.index = info.ifi_index;
+    link.flags = info.ifi_flags;
+    link.mtu = 0;
+    while (response.hasAttribute()) {
+        switch (response.getAttributeType()) {
+            case IFLA_MTU:
+                response.fetch(IFLA_MTU, link.mtu);
+                break;
+            case IFLA_ADDRESS:
+                response.fetch(IFLA_ADDRESS, link.mac, response.getAttributeLength());
+                break;
+            default:
+                response.skipAttribute();
+                break;
+        }
+    }
+    return link;
+}
+
+std::vector<StaticRoute> getStaticRoutes(const pid_t nsPid, uint32_t index)
+{
+    NetlinkMessage nlm(RTM_GETROUTE, NLM_F_REQUEST | NLM_F_ACK | NLM_F_DUMP);
+    rtmsg rt = utils::make_clean<rtmsg>();
+    rt.rtm_family = AF_UNSPEC;
+    nlm.put(rt)
+        .setStrictCheck()
+        .put(RTA_TABLE, static_cast<uint32_t>(RT_TABLE_MAIN))
+        .put(RTA_OIF, index);
+    NetlinkResponse response = send(nlm, nsPid);
+
+    std::vector<StaticRoute> routes;
+    for (; response.hasMessage(); response.fetchNextMessage()) {
+        if (response.getMessageType() != RTM_NEWROUTE) {
+            continue;
+        }
+        response.fetch(rt);
+        if (rt.rtm_family != AF_INET && rt.rtm_family != AF_INET6) {
+            continue;
+        }
+
+        StaticRoute route;
+        route.dst.family = rt.rtm_family;
+        route.dst.ip = rt.rtm_family == AF_INET6 ? "::" : "0.0.0.0";
+        route.dst.prefixlen = rt.rtm_dst_len;
+        route.metric = 0;
+        uint32_t table = rt.rtm_table;
+        uint32_t oif = 0;
+        while (response.hasAttribute()) {
+            int attrType = response.getAttributeType();
+            switch (attrType) {
+                case RTA_DST:
+                    route.dst.ip = fetchIp(response, RTA_DST, rt.rtm_family);
+                    break;
+                case RTA_GATEWAY:
+                    route.gateway = fetchIp(response, RTA_GATEWAY, rt.rtm_family);
+                    break;
+                case RTA_OIF:
+                    response.fetch(RTA_OIF, oif);
+                    break;
+                case RTA_PRIORITY:
+                    response.fetch(RTA_PRIORITY, route.metric);
+                    break;
+                case RTA_TABLE:
+                    response.fetch(RTA_TABLE, table);
+                    break;
+                default:
+                    response.skipAttribute();
+                    break;
+            }
+        }
+        // filters are checked also here, older kernels ignore them
+        if (rt.rtm_protocol == RTPROT_STATIC && rt.rtm_type == RTN_UNICAST &&
+            !(rt.rtm_flags & RTM_F_CLONED) && table == RT_TABLE_MAIN && oif == index) {
+            routes.push_back(route);
+        }
+    }
+    return routes;
+}
+
+// traffic control handles (major:minor), see tc(8)
+const uint32_t TC_ROOT_HANDLE = TC_H_MAKE(1U << 16, 0);
+const uint32_t TC_LEAF_HANDLE = TC_H_MAKE(10U << 16, 0);
+const uint32_t TC_INGRESS_HANDLE = TC_H_MAKE(TC_H_INGRESS, 0);
+const uint16_t TC_POLICER_PRIORITY = 1;
+// veth passes GSO packets, the buckets have to hold them
+const uint32_t TC_MAX_PACKET_SIZE = 65536;
+// kernel measures time in 64ns ticks (PSCHED_SHIFT)
+const uint64_t TC_TICKS_PER_SEC = 1000000000 >> 6;
+// automatic burst lasts 10ms at full speed
+const uint64_t TC_BURST_DIVISOR = 100;
+// packets wait in the token bucket at most 50ms
+const uint64_t TC_LATENCY_DIVISOR = 20;
+
+// ignored by recent kernels, but older ones require it
+typedef std::array<uint32_t, 256> RateTable;
+
+struct LinkInfo {
+    int index;
+    int link;
+    std::string kind;
+};
+
+struct QdiscState {
+    bool hasLimit;
+    bool hasIngress;
+    std::set<uint16_t> policers; // priorities of ingress filters
+};
+
+uint32_t toU32(uint64_t value)
+{
+    return static_cast<uint32_t>(std::min<uint64_t>(value, std::numeric_limits<uint32_t>::max()));
+}
+
+uint32_t toTicks(uint64_t bytesPerSec, uint64_t size)
+{
+    return toU32(size * TC_TICKS_PER_SEC / bytesPerSec);
+}
+
+tc_ratespec makeRate(uint64_t bytesPerSec, RateTable& table)
+{
+    tc_ratespec rate = utils::make_clean<tc_ratespec>();
+    rate.rate = toU32(bytesPerSec);
+    rate.linklayer = TC_LINKLAYER_ETHERNET;
+    rate.cell_align = -1;
+    while ((TC_MAX_PACKET_SIZE >> rate.cell_log) > table.size() - 1) {
+        ++rate.cell_log;
+    }
+    for (size_t i = 0; i < table.size(); ++i) {
+        table[i] = toTicks(bytesPerSec, (i + 1) << rate.cell_log);
+    }
+    return rate;
+}
+
+NetlinkMessage tcMessage(uint16_t type,
+                         uint16_t flags,
+                         int index,
+                         uint32_t parent,
+                         uint32_t handle,
+                         uint32_t info = 0)
+{
+    NetlinkMessage nlm(type, NLM_F_REQUEST | NLM_F_ACK | flags);
+    tcmsg tc = utils::make_clean<tcmsg>();
+    tc.tcm_family = AF_UNSPEC;
+    tc.tcm_ifindex = index;
+    tc.tcm_parent = parent;
+    tc.tcm_handle = handle;
+    tc.tcm_info = info;
+    nlm.put(tc);
+    return nlm;
+}
+
+NetlinkMessage tbfMessage(int index, uint64_t bytesPerSec, uint32_t burst)
+{
+    RateTable table;
+    tc_tbf_qopt qopt = utils::make_clean<tc_tbf_qopt>();
+    qopt.rate = makeRate(bytesPerSec, table);
+    qopt.buffer = toTicks(bytesPerSec, burst);
+    qopt.limit = toU32(bytesPerSec / TC_LATENCY_DIVISOR + burst);
+
+    NetlinkMessage nlm = tcMessage(RTM_NEWQDISC, NLM_F_CREATE | NLM_F_REPLACE,
+                                   index, TC_H_ROOT, TC_ROOT_HANDLE);
+    nlm.put(TCA_KIND, "tbf")
+        .beginNested(TCA_OPTIONS)
+            .put(TCA_TBF_PARMS, qopt)
+            .put(TCA_TBF_RTAB, table)
+            .put(TCA_TBF_BURST, burst);
+    if (bytesPerSec > std::numeric_limits<uint32_t>::max()) {
+        nlm.put(TCA_TBF_RATE64, bytesPerSec);
+    }
+    nlm.endNested();
+    return nlm;
+}
+
+NetlinkMessage policerMessage(int index, uint16_t priority, uint64_t bytesPerSec, uint32_t burst)
+{
+    RateTable table;
+    tc_police police = utils::make_clean<tc_police>();
+    police.action = TC_POLICE_SHOT;
+    police.rate = makeRate(bytesPerSec, table);
+    police.burst = toTicks(bytesPerSec, burst);
+    police.mtu = TC_MAX_PACKET_SIZE;
+
+    // one key with empty mask matches every packet
+    tc_u32_sel sel = utils::make_clean<tc_u32_sel>();
+    sel.flags = TC_U32_TERMINAL;
+    sel.nkeys = 1;
+    std::array<char, sizeof(tc_u32_sel) + sizeof(tc_u32_key)> selector{};
+    ::memcpy(selector.data(), &sel, sizeof(sel));
+
+    NetlinkMessage nlm = tcMessage(RTM_NEWTFILTER, NLM_F_CREATE | NLM_F_EXCL,
+                                   index, TC_INGRESS_HANDLE, 0,
+                                   TC_H_MAKE(static_cast<uint32_t>(priority) << 16, htons(ETH_P_ALL)));
+    nlm.put(TCA_KIND, "u32")
+        .beginNested(TCA_OPTIONS)
+            .put(TCA_U32_SEL, selector)
+            .beginNested(TCA_U32_POLICE)
+                .put(TCA_POLICE_TBF, police)
+                .put(TCA_POLICE_RATE, table);
+    if (bytesPerSec > std::numeric_limits<uint32_t>::max()) {
+        nlm.put(TCA_POLICE_RATE64, bytesPerSec);
+    }
+    nlm.endNested()
+        .endNested();
+    return nlm;
+}
+
+LinkInfo getLinkInfo(const pid_t nsPid, const std::string& netdev, int index)
+{
+    NetlinkMessage nlm(RTM_GETLINK, NLM_F_REQUEST | NLM_F_ACK);
+    ifinfomsg info = utils::make_clean<ifinfomsg>();
+    info.ifi_family = AF_UNSPEC;
+    info.ifi_index = index;
+    nlm.put(info);
+    if (!netdev.empty()) {
+        nlm.put(IFLA_IFNAME, netdev);
+    }
+    NetlinkResponse response = send(nlm, nsPid);
+    if (!response.hasMessage()) {
+        throw VasumException("Can't get interface information");
+    }
+    response.fetch(info);
+
+    LinkInfo link{info.ifi_index, 0, std::string()};
+    while (response.hasAttribute()) {
+        switch (response.getAttributeType()) {
+            case IFLA_LINK:
+                response.fetch(IFLA_LINK, link.link);
+                break;
+            case IFLA_LINKINFO:
+                response.openNested(IFLA_LINKINFO);
+                while (response.hasAttribute()) {
+                    if (response.getAttributeType() == IFLA_INFO_KIND) {
+                        response.fetch(IFLA_INFO_KIND, link.kind, response.getAttributeLength() - 1);
+                    } else {
+                        response.skipAttribute();
+                    }
+                }
+                response.closeNested();
+                break;
+            default:
+                response.skipAttribute();
+                break;
+        }
+    }
+    return link;
+}
+
+int getHostVethIndex(const pid_t nsPid, const std::string& netdev)
+{
+    const LinkInfo zoneLink = getLinkInfo(nsPid, netdev, 0);
+    if (zoneLink.kind == "veth" && zoneLink.link != 0) {
+        try {
+            const LinkInfo hostLink = getLinkInfo(0, std::string(), zoneLink.link);
+            if (hostLink.kind == "veth" && hostLink.link == zoneLink.index) {
+                return hostLink.index;
+            }
+        } catch (const std::exception& ex) {
+            LOGD("Can't get peer of " << netdev << ": " << ex.what());
+        }
+    }
+    const std::string msg = netdev + " is not a veth device connected to the host";
+    LOGE(msg);
+    throw VasumException(msg);
+}
+
+QdiscState getQdiscState(int index)
+{
+    NetlinkMessage nlm(RTM_GETQDISC, NLM_F_REQUEST | NLM_F_ACK | NLM_F_DUMP);
+    tcmsg tc = utils::make_clean<tcmsg>();
+    tc.tcm_family = AF_UNSPEC;
+    tc.tcm_ifindex = index;
+    nlm.put(tc);
+    NetlinkResponse response = send(nlm);
+
+    QdiscState state{false, false, {}};
+    for (; response.hasMessage(); response.fetchNextMessage()) {
+        if (response.getMessageType() != RTM_NEWQDISC) {
+            continue;
+        }
+        response.fetch(tc);
+        if (tc.tcm_ifindex != index) {
+            continue;
+        }
+        std::string kind;
+        while (response.hasAttribute()) {
+            if (response.getAttributeType() == TCA_KIND) {
+                response.fetch(TCA_KIND, kind, response.getAttributeLength() - 1);
+            } else {
+                response.skipAttribute();
+            }
+        }
+        if (tc.tcm_parent == TC_H_ROOT && tc.tcm_handle == TC_ROOT_HANDLE && kind == "tbf") {
+            state.hasLimit = true;
+        } else if (tc.tcm_parent == TC_H_INGRESS) {
+            state.hasIngress = true;
+        }
+    }
+    if (!state.hasIngress) {
+        return state;
+    }
+
+    NetlinkMessage filters(RTM_GETTFILTER, NLM_F_REQUEST | NLM_F_ACK | NLM_F_DUMP);
+    tc = utils::make_clean<tcmsg>();
+    tc.tcm_family = AF_UNSPEC;
+    tc.tcm_ifindex = index;
+    tc.tcm_parent = TC_INGRESS_HANDLE;
+    filters.put(tc);
+    response = send(filters);
+    for (; response.hasMessage(); response.fetchNextMessage()) {
+        if (response.getMessageType() != RTM_NEWTFILTER) {
+            continue;
+        }
+        response.fetch(tc);
+        if (tc.tcm_ifindex == index && tc.tcm_parent == TC_INGRESS_HANDLE) {
+            state.policers.insert(TC_H_MAJ(tc.tcm_info) >> 16);
+        }
+    }
+    return state;
+}
+
+NetlinkMessage delPolicerMessage(int index, uint16_t priority)
+{
+    return tcMessage(RTM_DELTFILTER, 0, index, TC_INGRESS_HANDLE, 0,
+                     TC_H_MAKE(static_cast<uint32_t>(priority) << 16, htons(ETH_P_ALL)));
+}
+
 } // namespace
 
 void createVeth(const pid_t& nsPid, const std::string& nsDev, const std::string& hostDev)
 {
-    std::string hostVeth = getUniqueVethName();
+    std::string hostVeth = gVethNameAllocator.allocate();
     LOGT("Creating veth: bridge: " << hostDev << ", port: " << hostVeth << ", zone: " << nsDev);
-    createPipedNetdev(nsDev, hostVeth);
+    try {
+        createPipedNetdev(nsDev, hostVeth);
+    } catch(const std::exception& ex) {
+        gVethNameAllocator.release(hostVeth);
+        throw;
+    }
     try {
         attachToBridge(hostDev, hostVeth);
-        up(hostVeth);
-        moveToNS(nsDev, nsPid);
+        upAndMoveToNS(hostVeth, nsDev, nsPid);
     } catch(const std::exception& ex) {
         try {
             destroyNetdev(hostVeth);
         } catch (const std::exception& ex) {
             LOGE("Can't destroy netdev pipe: " << hostVeth << ", " << nsDev);
         }
+        gVethNameAllocator.release(hostVeth);
         throw;
     }
 }
@@ -400,8 +921,7 @@ void createMacvlan(const pid_t& nsPid,
     LOGT("Creating macvlan: host: " << hostDev << ", zone: " << nsDev << ", mode: " << mode);
     createMacvlan(hostDev, nsDev, mode);
     try {
-        up(nsDev);
-        moveToNS(nsDev, nsPid);
+        upAndMoveToNS(nsDev, nsDev, nsPid);
     } catch(const std::exception& ex) {
         try {
             destroyNetdev(nsDev);
@@ -637,6 +1157,290 @@ void deleteIpAddress(const pid_t nsPid,
     deleteIpAddress(nsPid, index, ip.substr(0, slash), prefixlen, getIpFamily(ip));
 }
 
+std::vector<std::string> apply(const pid_t nsPid, const DeviceConfig& config)
+{
+    LOGT("Applying network device configuration: " << config.name);
+    validateNetdevName(config.name);
+
+    // whole configuration is validated before the first change
+    const std::string mac = config.mac.empty() ? std::string() : parseMac(config.mac);
+    std::map<std::string, IpPrefix> addresses;
+    for (const auto& address : config.addresses) {
+        const IpPrefix prefix = parsePrefix(address);
+        addresses.emplace(prefix.toString(), prefix);
+    }
+    if (!config.up && !config.routes.empty()) {
+        const std::string msg = "Routes require the network device to be up";
+        LOGE(msg);
+        throw VasumException(msg);
+    }
+    std::map<std::string, StaticRoute> routes;
+    for (const auto& entry : config.routes) {
+        StaticRoute route;
+        route.dst = parsePrefix(entry.dst);
+        route.gateway = entry.gateway.empty() ? std::string() : canonicalIp(route.dst.family, entry.gateway);
+        route.metric = entry.metric;
+        if (route.metric == 0 && route.dst.family == AF_INET6) {
+            route.metric = IPV6_DEFAULT_METRIC;
+        }
+        routes.emplace(route.toString(), route);
+    }
+
+    std::vector<std::string> changes;
+    const std::vector<std::string> netdevs = listNetdev(nsPid);
+    if (std::find(netdevs.begin(), netdevs.end(), config.name) == netdevs.end()) {
+        switch (config.type) {
+            case DeviceConfig::Type::VETH:
+                createVeth(nsPid, config.name, config.hostDev);
+                changes.push_back("created: veth");
+                break;
+            case DeviceConfig::Type::MACVLAN:
+                createMacvlan(nsPid, config.name, config.hostDev, config.macvlanMode);
+                changes.push_back("created: macvlan");
+                break;
+            case DeviceConfig::Type::PHYS:
+                movePhys(nsPid, config.name);
+                changes.push_back("created: phys");
+                break;
+        }
+    }
+
+    const LinkState link = getLinkState(nsPid, config.name);
+    NetlinkTransaction transaction(nsPid);
+
+    // device is brought up first and down last, routes through a device going down are flushed
+    NetlinkMessage linkMessage(RTM_NEWLINK, NLM_F_REQUEST | NLM_F_ACK);
+    ifinfomsg info = utils::make_clean<ifinfomsg>();
+    info.ifi_family = AF_UNSPEC;
+    info.ifi_index = link.index;
+    const bool isUp = link.flags & IFF_UP;
+    bool linkChanged = config.up && !isUp;
+    if (linkChanged) {
+        info.ifi_change = IFF_UP;
+        info.ifi_flags = IFF_UP;
+        changes.push_back("state: down -> up");
+    }
+    linkMessage.put(info);
+    if (config.mtu != 0 && config.mtu != link.mtu) {
+        linkMessage.put(IFLA_MTU, config.mtu);
+        changes.push_back("mtu: " + std::to_string(link.mtu) + " -> " + std::to_string(config.mtu));
+        linkChanged = true;
+    }
+    if (!mac.empty() && mac != link.mac) {
+        ether_addr addr;
+        std::copy(mac.begin(), mac.end(), addr.ether_addr_octet);
+        linkMessage.put(IFLA_ADDRESS, addr);
+        changes.push_back("mac: " + formatMac(link.mac) + " -> " + formatMac(mac));
+        linkChanged = true;
+    }
+    if (linkChanged) {
+        transaction.add(std::move(linkMessage));
+    }
+
+    // routes may depend on addresses, so they are removed first and added last
+    std::set<std::string> currentRoutes;
+    for (const auto& route : getStaticRoutes(nsPid, link.index)) {
+        if (routes.find(route.toString()) == routes.end()) {
+            transaction.add(routeMessage(RTM_DELROUTE, link.index, route));
+            changes.push_back("route removed: " + route.toString());
+        }
+        currentRoutes.insert(route.toString());
+    }
+
+    std::set<std::string> currentAddresses;
+    for (int family : {AF_INET, AF_INET6}) {
+        for (const auto& attrs : getIpAddresses(nsPid, family, link.index)) {
+            IpPrefix address;
+            address.family = family;
+            address.prefixlen = 0;
+            int scope = RT_SCOPE_UNIVERSE;
+            for (const auto& attr : attrs) {
+                if (get<0>(attr) == "ip") {
+                    address.ip = get<1>(attr);
+                } else if (get<0>(attr) == "prefixlen") {
+                    address.prefixlen = std::stoi(get<1>(attr));
+                } else if (get<0>(attr) == "scope") {
+                    scope = std::stoi(get<1>(attr));
+                }
+            }
+            if (family == AF_INET6 && scope == RT_SCOPE_LINK) {
+                continue;
+            }
+            if (addresses.find(address.toString()) == addresses.end()) {
+                transaction.add(addressMessage(RTM_DELADDR, link.index, address));
+                changes.push_back("address removed: " + address.toString());
+            }
+            currentAddresses.insert(address.toString());
+        }
+    }
+    for (const auto& address : addresses) {
+        if (currentAddresses.find(address.first) == currentAddresses.end()) {
+            transaction.add(addressMessage(RTM_NEWADDR, link.index, address.second));
+            changes.push_back("address added: " + address.first);
+        }
+    }
+
+    for (const auto& route : routes) {
+        if (currentRoutes.find(route.first) == currentRoutes.end()) {
+            transaction.add(routeMessage(RTM_NEWROUTE, link.index, route.second));
+            changes.push_back("route added: " + route.first);
+        }
+    }
+
+    if (!config.up && isUp) {
+        info.ifi_change = IFF_UP;
+        info.ifi_flags = 0;
+        NetlinkMessage downMessage(RTM_NEWLINK, NLM_F_REQUEST | NLM_F_ACK);
+        downMessage.put(info);
+        transaction.add(std::move(downMessage));
+        changes.push_back("state: up -> down");
+    }
+
+    transaction.commit();
+    return changes;
+}
+
+std::vector<Statistics> getStatistics(const pid_t nsPid)
+{
+    NetlinkMessage nlm(RTM_GETLINK, NLM_F_REQUEST | NLM_F_ACK | NLM_F_DUMP);
+    ifinfomsg info = utils::make_clean<ifinfomsg>();
+    info.ifi_family = AF_UNSPEC;
+    nlm.put(info)
+        .setUncached();
+    NetlinkResponse response = send(nlm, nsPid);
+
+    std::vector<Statistics> statistics;
+    for (; response.hasMessage(); response.fetchNextMessage()) {
+        if (response.getMessageType() != RTM_NEWLINK) {
+            continue;
+        }
+        response.fetch(info);
+
+        // newer kernels append counters, older ones may send less of them
+        rtnl_link_stats64 stats = utils::make_clean<rtnl_link_stats64>();
+        std::string name;
+        while (response.hasAttribute()) {
+            switch (response.getAttributeType()) {
+                case IFLA_IFNAME:
+                    response.fetch(IFLA_IFNAME, name, response.getAttributeLength() - 1);
+                    break;
+                case IFLA_STATS64: {
+                    std::string raw;
+                    response.fetch(IFLA_STATS64, raw);
+                    ::memcpy(&stats, raw.data(), std::min(raw.size(), sizeof(stats)));
+                    break;
+                }
+                default:
+                    response.skipAttribute();
+                    break;
+            }
+        }
+        statistics.push_back({name,
+                              stats.rx_bytes,
+                              stats.tx_bytes,
+                              stats.rx_packets,
+                              stats.tx_packets,
+                              stats.rx_dropped,
+                              stats.tx_dropped,
+                              stats.rx_errors,
+                              stats.tx_errors});
+    }
+    return statistics;
+}
+
+void setBandwidth(const pid_t nsPid, const std::string& netdev, const Bandwidth& limits)
+{
+    LOGT("Setting bandwidth of " << netdev << ": download " << limits.downloadRate
+         << " bit/s, upload " << limits.uploadRate << " bit/s, burst " << limits.burst);
+    validateNetdevName(netdev);
+
+    const uint64_t download = limits.downloadRate / 8;
+    const uint64_t upload = limits.uploadRate / 8;
+    if ((limits.downloadRate != 0 && download == 0) || (limits.uploadRate != 0 && upload == 0)) {
+        const std::string msg = "Bandwidth limit has to be at least 8 bit/s";
+        LOGE(msg);
+        throw VasumException(msg);
+    }
+    if (limits.burst != 0 && limits.burst < TC_MAX_PACKET_SIZE) {
+        const std::string msg = "Burst has to be at least " + std::to_string(TC_MAX_PACKET_SIZE) + " bytes";
+        LOGE(msg);
+        throw VasumException(msg);
+    }
+    auto getBurst = [&limits](uint64_t bytesPerSec) -> uint32_t {
+        if (limits.burst != 0) {
+            return limits.burst;
+        }
+        return toU32(std::max<uint64_t>(bytesPerSec / TC_BURST_DIVISOR, TC_MAX_PACKET_SIZE));
+    };
+
+    const int index = getHostVethIndex(nsPid, netdev);
+    const QdiscState state = getQdiscState(index);
+
+    // not all kernels can change a policer in place, so the new one gets
+    // another priority and the old one is removed after it's attached
+    uint16_t priority = TC_POLICER_PRIORITY;
+    while (state.policers.count(priority) != 0) {
+        ++priority;
+    }
+
+    NetlinkTransaction transaction;
+    if (download != 0) {
+        transaction.add(tbfMessage(index, download, getBurst(download)));
+    } else if (state.hasLimit) {
+        transaction.add(tcMessage(RTM_DELQDISC, 0, index, TC_H_ROOT, TC_ROOT_HANDLE));
+    }
+
+    // the ingress qdisc of the host veth belongs to vasum
+    if (upload != 0) {
+        if (!state.hasIngress) {
+            NetlinkMessage ingress = tcMessage(RTM_NEWQDISC, NLM_F_CREATE | NLM_F_EXCL,
+                                               index, TC_H_INGRESS, TC_INGRESS_HANDLE);
+            ingress.put(TCA_KIND, "ingress");
+            transaction.add(std::move(ingress));
+        }
+        transaction.add(policerMessage(index, priority, upload, getBurst(upload)));
+    } else if (state.hasIngress) {
+        transaction.add(tcMessage(RTM_DELQDISC, 0, index, TC_H_INGRESS, TC_INGRESS_HANDLE));
+    }
+
+    if (transaction.size() != 0) {
+        try {
+            transaction.commit();
+        } catch (const std::exception&) {
+            if (upload != 0) {
+                // the old policer is kept, the new one is removed if it was attached
+                try {
+                    send(state.hasIngress
+                         ? delPolicerMessage(index, priority)
+                         : tcMessage(RTM_DELQDISC, 0, index, TC_H_INGRESS, TC_INGRESS_HANDLE));
+                } catch (const std::exception& ex) {
+                    LOGD("New policer of " << netdev << " not removed: " << ex.what());
+                }
+            }
+            throw;
+        }
+    }
+
+    if (upload != 0 && !state.policers.empty()) {
+        NetlinkTransaction cleanup;
+        for (uint16_t old : state.policers) {
+            cleanup.add(delPolicerMessage(index, old));
+        }
+        cleanup.commit();
+    }
+
+    if (download != 0) {
+        NetlinkMessage leaf = tcMessage(RTM_NEWQDISC, NLM_F_CREATE | NLM_F_REPLACE,
+                                        index, TC_H_MAKE(TC_ROOT_HANDLE, 1), TC_LEAF_HANDLE);
+        leaf.put(TCA_KIND, "fq_codel");
+        try {
+            send(leaf);
+        } catch (const std::exception& ex) {
+            // the limit works without it, flows just share one fifo
+            LOGW("Can't attach fq_codel to " << netdev << ": " << ex.what());
+        }
+    }
+}
 
 } //namespace netdev
 } //namespace vasum
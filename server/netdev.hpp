@@ -25,6 +25,7 @@
 #ifndef SERVER_NETDEV_HPP
 #define SERVER_NETDEV_HPP
 
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <tuple>
@@ -37,6 +38,62 @@ namespace netdev {
 
 typedef std::vector<std::tuple<std::string, std::string>> Attrs;
 
+/**
+ * Static route through a network device
+ */
+struct DeviceRoute {
+    std::string dst;     ///< destination in CIDR notation
+    std::string gateway; ///< empty for directly connected network
+    uint32_t metric;
+};
+
+/**
+ * Desired state of a zone network device
+ */
+struct DeviceConfig {
+    enum class Type {
+        VETH,
+        PHYS,
+        MACVLAN
+    };
+
+    std::string name;                   ///< name in zone
+    Type type;                          ///< used when the device doesn't exist
+    std::string hostDev;                ///< bridge (veth) or lower device (macvlan)
+    macvlan_mode macvlanMode;
+    uint32_t mtu;                       ///< 0 keeps the current value
+    std::string mac;                    ///< empty keeps the current value
+    std::vector<std::string> addresses; ///< all addresses in CIDR notation
+    std::vector<DeviceRoute> routes;    ///< all static routes through the device
+    bool up;
+};
+
+/**
+ * Bandwidth limits of a zone network device
+ *
+ * Rates are in bits per second, 0 means no limit.
+ */
+struct Bandwidth {
+    uint64_t downloadRate; ///< traffic sent to the zone
+    uint64_t uploadRate;   ///< traffic sent by the zone
+    uint32_t burst;        ///< bytes sent at full speed, 0 selects it automatically
+};
+
+/**
+ * Traffic counters of a network device
+ */
+struct Statistics {
+    std::string name;
+    uint64_t rxBytes;
+    uint64_t txBytes;
+    uint64_t rxPackets;
+    uint64_t txPackets;
+    uint64_t rxDropped;
+    uint64_t txDropped;
+    uint64_t rxErrors;
+    uint64_t txErrors;
+};
+
 void createVeth(const pid_t& nsPid, const std::string& nsDev, const std::string& hostDev);
 void createMacvlan(const pid_t& nsPid,
                    const std::string& nsDev,
@@ -63,6 +120,48 @@ void setAttrs(const pid_t nsPid, const std::string& netdev, const Attrs& attrs);
  */
 void deleteIpAddress(const pid_t nsPid, const std::string& netdev, const std::string& ip);
 
+/**
+ * Bring network device to the given state
+ *
+ * The device is created when it doesn't exist. Then link attributes,
+ * addresses and static routes (RTPROT_STATIC in the main table) are compared
+ * with the desired ones and all differences are sent in one netlink
+ * transaction. Addresses and static routes not listed in config are removed,
+ * IPv6 link local addresses are kept.
+ *
+ * Application is best effort: requests of the transaction which succeeded
+ * before or after a failed one are not rolled back, applying the config
+ * again finishes the job.
+ *
+ * @param nsPid pid which defines zone network namespace
+ * @param config desired state
+ * @return description of changes made, empty if the device was already in the given state
+ */
+std::vector<std::string> apply(const pid_t nsPid, const DeviceConfig& config);
+
+/**
+ * Limit bandwidth of a zone veth device
+ *
+ * Traffic control is attached to the host side of the veth pair, so it can't
+ * be changed from inside the zone. Traffic sent to the zone goes through
+ * a token bucket (tbf) with fq_codel inside, traffic sent by the zone above
+ * the limit is dropped by an ingress policer. Zero rates remove the limits.
+ * A new policer is attached before the old one is removed, and the old one
+ * is kept when the new one can't be attached.
+ *
+ * @param nsPid pid which defines zone network namespace
+ * @param netdev veth device name in zone
+ * @param limits bandwidth limits
+ */
+void setBandwidth(const pid_t nsPid, const std::string& netdev, const Bandwidth& limits);
+
+/**
+ * Get traffic counters (IFLA_STATS64) of all network devices
+ *
+ * @param nsPid pid which defines network namespace
+ */
+std::vector<Statistics> getStatistics(const pid_t nsPid = 0);
+
 } //namespace netdev
 } //namespace vasum
 
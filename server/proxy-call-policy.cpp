@@ -37,12 +37,32 @@ inline bool match(const std::string& rule, const std::string& value) {
     return rule == ANY || rule == value;
 }
 
+// D-Bus names, paths and zone ids never contain '\0'
+inline std::string makeKey(const std::string& caller,
+                           const std::string& target,
+                           const std::string& targetInterface)
+{
+    std::string key;
+    key.reserve(caller.size() + target.size() + targetInterface.size() + 2);
+    key.append(caller).push_back('\0');
+    key.append(target).push_back('\0');
+    key.append(targetInterface);
+    return key;
+}
+
 } // namespace
 
+const std::size_t ProxyCallPolicy::DEFAULT_DECISION_CACHE_SIZE;
 
-ProxyCallPolicy::ProxyCallPolicy(const std::vector<ProxyCallRule>& proxyCallRules)
+ProxyCallPolicy::ProxyCallPolicy(const std::vector<ProxyCallRule>& proxyCallRules,
+                                 std::size_t decisionCacheSize)
     : mProxyCallRules(proxyCallRules)
+    , mDecisionCacheSize(decisionCacheSize)
 {
+    for (std::size_t i = 0; i < mProxyCallRules.size(); ++i) {
+        const ProxyCallRule& rule = mProxyCallRules[i];
+        mRuleIndex[makeKey(rule.caller, rule.target, rule.targetInterface)].push_back(i);
+    }
 }
 
 bool ProxyCallPolicy::isProxyCallAllowed(const std::string& caller,
@@ -52,14 +72,58 @@ bool ProxyCallPolicy::isProxyCallAllowed(const std::string& caller,
                                          const std::string& targetInterface,
                                          const std::string& targetMethod) const
 {
-    for (const ProxyCallRule& rule : mProxyCallRules) {
-        if (match(rule.caller, caller)
-                && match(rule.target, target)
-                && match(rule.targetBusName, targetBusName)
-                && match(rule.targetObjectPath, targetObjectPath)
-                && match(rule.targetInterface, targetInterface)
-                && match(rule.targetMethod, targetMethod)) {
-            return true;
+    if (mDecisionCacheSize == 0) {
+        return checkRules(caller, target, targetBusName, targetObjectPath, targetInterface, targetMethod);
+    }
+
+    std::string key = makeKey(caller, target, targetInterface);
+    key.append(1, '\0').append(targetBusName);
+    key.append(1, '\0').append(targetObjectPath);
+    key.append(1, '\0').append(targetMethod);
+
+    std::lock_guard<std::mutex> lock(mDecisionCacheMutex);
+
+    auto it = mDecisionCache.find(key);
+    if (it != mDecisionCache.end()) {
+        mDecisions.splice(mDecisions.begin(), mDecisions, it->second);
+        return it->second->second;
+    }
+
+    const bool allowed = checkRules(caller, target, targetBusName, targetObjectPath, targetInterface, targetMethod);
+
+    if (mDecisions.size() >= mDecisionCacheSize) {
+        mDecisionCache.erase(mDecisions.back().first);
+        mDecisions.pop_back();
+    }
+    mDecisions.emplace_front(key, allowed);
+    mDecisionCache.emplace(std::move(key), mDecisions.begin());
+
+    return allowed;
+}
+
+bool ProxyCallPolicy::checkRules(const std::string& caller,
+                                 const std::string& target,
+                                 const std::string& targetBusName,
+                                 const std::string& targetObjectPath,
+                                 const std::string& targetInterface,
+                                 const std::string& targetMethod) const
+{
+    // try every exact/wildcard combination of the indexed fields
+    for (int mask = 0; mask < 8; ++mask) {
+        const auto bucket = mRuleIndex.find(makeKey(mask & 1 ? ANY : caller,
+                                                    mask & 2 ? ANY : target,
+                                                    mask & 4 ? ANY : targetInterface));
+        if (bucket == mRuleIndex.end()) {
+            continue;
+        }
+
+        for (std::size_t i : bucket->second) {
+            const ProxyCallRule& rule = mProxyCallRules[i];
+            if (match(rule.targetBusName, targetBusName)
+                    && match(rule.targetObjectPath, targetObjectPath)
+                    && match(rule.targetMethod, targetMethod)) {
+                return true;
+            }
         }
     }
 
@@ -28,16 +28,28 @@
 
 #include "proxy-call-config.hpp"
 
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 
 namespace vasum {
 
 
+/**
+ * Checks proxy calls against the allow rules.
+ *
+ * Rules are indexed by (caller, target, interface) with wildcard fallbacks,
+ * so a check looks at most at 8 buckets instead of the whole rule list.
+ * Recent decisions are kept in a bounded LRU cache.
+ */
 class ProxyCallPolicy {
 
 public:
-    ProxyCallPolicy(const std::vector<ProxyCallRule>& proxyCallRules);
+    ProxyCallPolicy(const std::vector<ProxyCallRule>& proxyCallRules,
+                    std::size_t decisionCacheSize = DEFAULT_DECISION_CACHE_SIZE);
 
     bool isProxyCallAllowed(const std::string& caller,
                             const std::string& target,
@@ -46,8 +58,26 @@ public:
                             const std::string& targetInterface,
                             const std::string& targetMethod) const;
 
+    static const std::size_t DEFAULT_DECISION_CACHE_SIZE = 256;
+
 private:
+    typedef std::unordered_map<std::string, std::vector<std::size_t>> RuleIndex;
+    typedef std::list<std::pair<std::string, bool>> Decisions;
+
     std::vector<ProxyCallRule> mProxyCallRules;
+    RuleIndex mRuleIndex;
+
+    const std::size_t mDecisionCacheSize;
+    mutable std::mutex mDecisionCacheMutex;
+    mutable Decisions mDecisions; // most recently used first
+    mutable std::unordered_map<std::string, Decisions::iterator> mDecisionCache;
+
+    bool checkRules(const std::string& caller,
+                    const std::string& target,
+                    const std::string& targetBusName,
+                    const std::string& targetObjectPath,
+                    const std::string& targetInterface,
+                    const std::string& targetMethod) const;
 };
 
 
@@ -28,11 +28,14 @@
 #include "exception.hpp"
 
 #include "cargo-json/cargo-json.hpp"
+#include "cargo-fd/cargo-fd.hpp"
 #include "logger/logger.hpp"
 #include "utils/environment.hpp"
 #include "utils/fs.hpp"
 #include "utils/signal.hpp"
 #include "utils/exception.hpp"
+#include "utils/fd-utils.hpp"
+#include "utils/c-args.hpp"
 
 #include <iostream>
 #include <csignal>
@@ -46,6 +49,7 @@
 #include <linux/capability.h>
 
 #include <sys/types.h>
+#include <sys/mman.h>
 #include <fcntl.h>
 #include <sys/utsname.h>
 #include <lxc/lxccontainer.h>
@@ -74,9 +78,43 @@ using namespace utils;
 
 namespace vasum {
 
-Server::Server(const std::string& configPath)
+namespace {
+
+const std::string HANDOFF_FD_OPTION = "--handoff-fd";
+
+// Closes the descriptor unless it was released
+class FDHolder {
+public:
+    explicit FDHolder(int fd) : mFD(fd) {}
+    ~FDHolder()
+    {
+        if (mFD >= 0) {
+            utils::close(mFD);
+        }
+    }
+
+    FDHolder(const FDHolder&) = delete;
+    FDHolder& operator=(const FDHolder&) = delete;
+
+    int get() const { return mFD; }
+
+    int release()
+    {
+        const int fd = mFD;
+        mFD = -1;
+        return fd;
+    }
+
+private:
+    int mFD;
+};
+
+} // namespace
+
+Server::Server(const std::string& configPath, int handoffFD)
     : mIsRunning(true),
       mIsUpdate(false),
+      mHandoffFD(handoffFD),
       mConfigPath(configPath),
       mSignalFD(mEventPoll),
       mZonesManager(mEventPoll, mConfigPath),
@@ -90,6 +128,7 @@ Server::Server(const std::string& configPath)
 void Server::handleUpdate()
 {
     LOGD("Received SIGUSR1 - triggering update.");
+    saveHandoffState();
     mZonesManager.setZonesDetachOnExit();
     mZonesManager.stop(false);
     mIsUpdate = true;
@@ -109,6 +148,7 @@ void Server::run(bool asRoot)
         throw ServerException("Environment setup failed");
     }
 
+    loadHandoffState();
     mZonesManager.start();
 
     while(mIsRunning || mZonesManager.isRunning()) {
@@ -119,11 +159,72 @@ void Server::run(bool asRoot)
 void Server::reloadIfRequired(char* argv[])
 {
     if (mIsUpdate) {
-        ::execve(argv[0], argv, environ);
+        CArgsBuilder args;
+        args.add(argv[0]);
+        for (int i = 1; argv[i] != nullptr; ++i) {
+            // drop the state passed by our predecessor
+            if (HANDOFF_FD_OPTION == argv[i]) {
+                if (argv[i + 1] != nullptr) {
+                    ++i;
+                }
+                continue;
+            }
+            args.add(argv[i]);
+        }
+
+        const std::string handoffFD = std::to_string(mHandoffFD);
+        if (mHandoffFD >= 0) {
+            utils::setCloseOnExec(mHandoffFD, false);
+            args.add(HANDOFF_FD_OPTION.c_str());
+            args.add(handoffFD.c_str());
+        }
+
+        ::execve(argv[0], const_cast<char* const*>(args.c_array()), environ);
         LOGE("Failed to reload " << argv[0] << ": " << getSystemErrorMessage());
     }
 }
 
+void Server::saveHandoffState()
+{
+    try {
+        const ZonesManagerRuntimeState state = mZonesManager.getRuntimeState();
+
+        FDHolder fd(::memfd_create("vasum-handoff", MFD_CLOEXEC));
+        if (fd.get() < 0) {
+            LOGW("Failed to create handoff memfd: " << getSystemErrorMessage());
+            return;
+        }
+        cargo::saveToFD(fd.get(), state);
+        if (::lseek(fd.get(), 0, SEEK_SET) < 0) {
+            LOGW("Failed to rewind handoff memfd: " << getSystemErrorMessage());
+            return;
+        }
+        mHandoffFD = fd.release();
+        LOGD("Runtime state of " << state.zones.size() << " zones saved for handoff");
+    } catch (const std::exception& e) {
+        // the new instance will fall back to querying lxc
+        LOGW("Failed to save handoff state: " << e.what());
+    }
+}
+
+void Server::loadHandoffState()
+{
+    if (mHandoffFD < 0) {
+        return;
+    }
+
+    try {
+        ZonesManagerRuntimeState state;
+        cargo::loadFromFD(mHandoffFD, state);
+        mZonesManager.setRuntimeState(state);
+        LOGI("Loaded handed over state of " << state.zones.size() << " zones");
+    } catch (const std::exception& e) {
+        LOGW("Failed to load handoff state, starting cold: " << e.what());
+    }
+    utils::close(mHandoffFD);
+    mHandoffFD = -1;
+}
+
 void Server::terminate()
 {
     LOGI("Terminating server");
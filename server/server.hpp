@@ -43,7 +43,12 @@ namespace vasum {
 
 class Server {
 public:
-    Server(const std::string& configPath);
+    /**
+     * @param configPath path to the daemon config
+     * @param handoffFD fd with the runtime state handed over by the previous instance
+     *                  on update, or -1 for a cold start
+     */
+    Server(const std::string& configPath, int handoffFD = -1);
 
     /**
      * Starts all the zones and blocks until SIGINT, SIGTERM or SIGUSR1
@@ -69,6 +74,7 @@ public:
 private:
     bool mIsRunning;
     bool mIsUpdate;
+    int mHandoffFD;
     std::string mConfigPath;
     utils::ScopedGlibLoop loop;
     cargo::ipc::epoll::EventPoll mEventPoll;
@@ -81,6 +87,16 @@ private:
      */
     static bool prepareEnvironment(const std::string& configPath, bool runAsRoot);
 
+    /**
+     * Write zones runtime state to a memfd that survives execve.
+     */
+    void saveHandoffState();
+
+    /**
+     * Pass the state written by the previous instance to ZonesManager.
+     */
+    void loadHandoffState();
+
     void handleUpdate();
     void handleStop();
 
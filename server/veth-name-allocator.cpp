@@ -0,0 +1,223 @@
+/*
+ *  Copyright (c) 2015 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *  Contact: agent <agent@local>
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License
+ */
+
+/**
+ * @file
+ * @author  agent (agent@local)
+ * @brief   Definition of the allocator of host side veth names
+ */
+
+#include "config.hpp"
+
+#include "veth-name-allocator.hpp"
+#include "netlink/netlink-message.hpp"
+#include "utils/make-clean.hpp"
+#include "exception.hpp"
+#include "logger/logger.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+#include <linux/rtnetlink.h>
+
+using namespace vasum::netlink;
+
+
+namespace vasum {
+namespace netdev {
+
+namespace {
+
+const std::string VETH_PREFIX = "veth0";
+
+} // namespace
+
+const unsigned int VethNameAllocator::MAX_NUMBER;
+
+VethNameAllocator::VethNameAllocator(unsigned int maxNumber)
+    : mMonitoring(false)
+    , mMaxNumber(std::min(std::max(maxNumber, 1u), MAX_NUMBER))
+    , mNext(1)
+{
+}
+
+std::string VethNameAllocator::allocate()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    update();
+
+    unsigned int number = 0;
+    while (!mFree.empty() && number == 0) {
+        // a number can be freed many times, it is taken again by the first pop
+        if (mUsed.find(mFree.back()) == mUsed.end()) {
+            number = mFree.back();
+        }
+        mFree.pop_back();
+    }
+    for (unsigned int tried = 0; number == 0 && tried < mMaxNumber; ++tried) {
+        if (mUsed.find(mNext) == mUsed.end()) {
+            number = mNext;
+        }
+        mNext = mNext < mMaxNumber ? mNext + 1 : 1;
+    }
+    if (number == 0) {
+        const std::string msg = "No free veth name";
+        LOGE(msg);
+        throw ZoneOperationException(msg);
+    }
+    // reserved until the link is created
+    mUsed[number] = 0;
+    return VETH_PREFIX + std::to_string(number);
+}
+
+void VethNameAllocator::release(const std::string& name)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    update();
+
+    // a created link is freed by its removal notification
+    auto it = mUsed.find(parseNumber(name));
+    if (it != mUsed.end() && it->second == 0) {
+        mUsed.erase(it);
+    }
+}
+
+unsigned int VethNameAllocator::parseNumber(const std::string& name) const
+{
+    if (name.compare(0, VETH_PREFIX.size(), VETH_PREFIX) != 0) {
+        return 0;
+    }
+    const std::string suffix = name.substr(VETH_PREFIX.size());
+    if (suffix.empty() || suffix.size() > 9 ||
+        !std::all_of(suffix.begin(), suffix.end(), ::isdigit)) {
+        return 0;
+    }
+    unsigned int number = std::stoul(suffix);
+    if (number > mMaxNumber) {
+        // never handed out
+        return 0;
+    }
+    return std::to_string(number) == suffix ? number : 0;
+}
+
+void VethNameAllocator::update()
+{
+    if (!mMonitoring) {
+        mMonitor.open(0, RTMGRP_LINK);
+        try {
+            seed();
+        } catch (const std::exception&) {
+            mMonitor.close();
+            throw;
+        }
+        mMonitoring = true;
+    }
+    for (;;) {
+        int size = mMonitor.rcvNotification(mBuf);
+        if (size == 0) {
+            return;
+        }
+        if (size < 0) {
+            seed();
+            continue;
+        }
+        unsigned int len = size;
+        for (const nlmsghdr* msg = reinterpret_cast<const nlmsghdr*>(mBuf.data());
+             NLMSG_OK(msg, len);
+             msg = NLMSG_NEXT(msg, len)) {
+            if ((msg->nlmsg_type != RTM_NEWLINK && msg->nlmsg_type != RTM_DELLINK) ||
+                msg->nlmsg_len < NLMSG_LENGTH(sizeof(ifinfomsg))) {
+                continue;
+            }
+            const ifinfomsg* info = reinterpret_cast<const ifinfomsg*>(NLMSG_DATA(msg));
+            if (info->ifi_family != AF_UNSPEC) {
+                continue;
+            }
+            std::string name;
+            int attrLen = IFLA_PAYLOAD(msg);
+            for (const rtattr* rta = IFLA_RTA(info); RTA_OK(rta, attrLen); rta = RTA_NEXT(rta, attrLen)) {
+                if (rta->rta_type == IFLA_IFNAME) {
+                    const char* data = reinterpret_cast<const char*>(RTA_DATA(rta));
+                    name.assign(data, ::strnlen(data, RTA_PAYLOAD(rta)));
+                    break;
+                }
+            }
+            removeLink(info->ifi_index);
+            if (msg->nlmsg_type == RTM_NEWLINK) {
+                addLink(info->ifi_index, name);
+            }
+        }
+    }
+}
+
+void VethNameAllocator::seed()
+{
+    // reservations are kept, links are read again
+    for (auto it = mUsed.begin(); it != mUsed.end();) {
+        if (it->second != 0) {
+            it = mUsed.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    mLinks.clear();
+    mFree.clear();
+    mMonitor.discardPending();
+
+    NetlinkMessage nlm(RTM_GETLINK, NLM_F_REQUEST | NLM_F_ACK | NLM_F_DUMP | NLM_F_ROOT);
+    ifinfomsg info = utils::make_clean<ifinfomsg>();
+    info.ifi_family = AF_PACKET;
+    nlm.put(info);
+    NetlinkResponse response = send(nlm);
+    for (; response.hasMessage(); response.fetchNextMessage()) {
+        response.fetch(info);
+        while (response.hasAttribute()) {
+            if (response.getAttributeType() == IFLA_IFNAME) {
+                std::string name;
+                // fetched value contains \0 terminator
+                response.fetch(IFLA_IFNAME, name, response.getAttributeLength() - 1);
+                addLink(info.ifi_index, name);
+                break;
+            }
+            response.skipAttribute();
+        }
+    }
+}
+
+void VethNameAllocator::addLink(int index, const std::string& name)
+{
+    unsigned int number = parseNumber(name);
+    if (number != 0) {
+        mUsed[number] = index;
+        mLinks[index] = number;
+    }
+}
+
+void VethNameAllocator::removeLink(int index)
+{
+    auto it = mLinks.find(index);
+    if (it != mLinks.end()) {
+        mUsed.erase(it->second);
+        mFree.push_back(it->second);
+        mLinks.erase(it);
+    }
+}
+
+} // namespace netdev
+} // namespace vasum
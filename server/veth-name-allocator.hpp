@@ -0,0 +1,92 @@
+/*
+ *  Copyright (c) 2015 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *  Contact: agent <agent@local>
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License
+ */
+
+/**
+ * @file
+ * @author  agent (agent@local)
+ * @brief   Declaration of the allocator of host side veth names
+ */
+
+#ifndef SERVER_VETH_NAME_ALLOCATOR_HPP
+#define SERVER_VETH_NAME_ALLOCATOR_HPP
+
+#include "netlink/netlink.hpp"
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+
+namespace vasum {
+namespace netdev {
+
+
+/**
+ * Allocates names of host side veth interfaces (veth0N)
+ *
+ * Names used in the host are read once and then followed by link notifications,
+ * so allocation doesn't list all interfaces. Numbers of removed links are reused
+ * first, other numbers are handed out in turn and wrap around after maxNumber.
+ */
+class VethNameAllocator {
+public:
+    VethNameAllocator(unsigned int maxNumber = MAX_NUMBER);
+
+    /**
+     * Reserve an unused name
+     *
+     * The name is reserved until its link is created or it's released.
+     * @throw ZoneOperationException when all names are used
+     */
+    std::string allocate();
+
+    /**
+     * Release a reservation of a name whose link wasn't created
+     */
+    void release(const std::string& name);
+
+    // the longest name which fits in IFNAMSIZ
+    static const unsigned int MAX_NUMBER = 999999999;
+
+private:
+    std::mutex mMutex;
+    netlink::Netlink mMonitor;
+    bool mMonitoring;
+    std::vector<char> mBuf;
+    const unsigned int mMaxNumber;
+    unsigned int mNext;
+    // veth number -> link index (0 if reserved but not created yet)
+    std::unordered_map<unsigned int, int> mUsed;
+    // link index -> veth number
+    std::unordered_map<int, unsigned int> mLinks;
+    std::vector<unsigned int> mFree;
+
+    unsigned int parseNumber(const std::string& name) const;
+    void update();
+    void seed();
+    void addLink(int index, const std::string& name);
+    void removeLink(int index);
+};
+
+
+} // namespace netdev
+} // namespace vasum
+
+
+#endif // SERVER_VETH_NAME_ALLOCATOR_HPP
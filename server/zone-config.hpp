@@ -28,6 +28,7 @@
 
 #include "cargo/fields.hpp"
 
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -95,6 +96,37 @@ struct ZoneConfig {
     )
 };
 
+struct ZoneBandwidthConfig {
+
+    /**
+     * Zone side name of the limited veth device
+     */
+    std::string netdev;
+
+    /**
+     * Limit of traffic sent to the zone in bits per second, 0 means no limit
+     */
+    std::uint64_t downloadRate;
+
+    /**
+     * Limit of traffic sent by the zone in bits per second, 0 means no limit
+     */
+    std::uint64_t uploadRate;
+
+    /**
+     * Bytes which can be sent at full speed, 0 selects it automatically
+     */
+    std::uint32_t burst;
+
+    CARGO_REGISTER
+    (
+        netdev,
+        downloadRate,
+        uploadRate,
+        burst
+    )
+};
+
 struct ZoneDynamicConfig {
 
     /**
@@ -122,13 +154,49 @@ struct ZoneDynamicConfig {
      */
     std::string runMountPoint;
 
+    /**
+     * Bandwidth limits of zone network devices, applied when the zone starts
+     */
+    std::vector<ZoneBandwidthConfig> bandwidth;
+
     CARGO_REGISTER
     (
         requestedState,
         ipv4Gateway,
         ipv4,
         vt,
-        runMountPoint
+        runMountPoint,
+        bandwidth
+    )
+};
+
+struct ZoneRuntimeState {
+    /**
+     * Zone id
+     */
+    std::string id;
+
+    /**
+     * Last known lxc state of the zone (see lxc::LxcZone::toString)
+     */
+    std::string state;
+
+    /**
+     * Pid of the zone's init process, -1 if the zone is not running
+     */
+    int initPid;
+
+    /**
+     * Start time of the init process (see proc(5)), tells a reused pid apart
+     */
+    std::uint64_t initStartTime;
+
+    CARGO_REGISTER
+    (
+        id,
+        state,
+        initPid,
+        initStartTime
     )
 };
 
@@ -38,8 +38,13 @@
 
 #include <boost/filesystem.hpp>
 
-#include <string>
 #include <algorithm>
+#include <atomic>
+#include <map>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <unordered_set>
 #include <fcntl.h>
 
 namespace fs = boost::filesystem;
@@ -48,6 +53,32 @@ using namespace utils;
 
 namespace vasum {
 
+namespace {
+
+const std::string& getTarget(const ZoneProvisioningConfig::Provision& provision)
+{
+    if (provision.is<ZoneProvisioningConfig::File>()) {
+        return provision.as<ZoneProvisioningConfig::File>().path;
+    } else if (provision.is<ZoneProvisioningConfig::Mount>()) {
+        return provision.as<ZoneProvisioningConfig::Mount>().target;
+    } else {
+        return provision.as<ZoneProvisioningConfig::Link>().target;
+    }
+}
+
+std::size_t getDepth(const std::string& path)
+{
+    std::size_t depth = 0;
+    for (const fs::path& part : fs::path(path).relative_path()) {
+        if (part != ".") {
+            ++depth;
+        }
+    }
+    return depth;
+}
+
+} // namespace
+
 ZoneProvision::ZoneProvision(const std::string& rootPath,
                              const std::string& configPath,
                              const std::string& dbPath,
@@ -59,6 +90,11 @@ ZoneProvision::ZoneProvision(const std::string& rootPath,
     , mValidLinkPrefixes(validLinkPrefixes)
 {
     cargo::loadFromKVStoreWithJsonFile(dbPath, configPath, mProvisioningConfig, dbPrefix);
+
+    for (const auto& provision : mProvisioningConfig.provisions) {
+        mProvisionIds.push_back(getId(provision));
+    }
+    buildIndex(0);
 }
 
 ZoneProvision::~ZoneProvision()
@@ -66,6 +102,13 @@ ZoneProvision::~ZoneProvision()
     stop();
 }
 
+void ZoneProvision::buildIndex(std::size_t from)
+{
+    for (std::size_t i = from; i < mProvisionIds.size(); ++i) {
+        mProvisionIndex[mProvisionIds[i]] = i;
+    }
+}
+
 void ZoneProvision::saveProvisioningConfig()
 {
     cargo::saveToKVStore(mDbPath, mProvisioningConfig, mDbPrefix);
@@ -74,21 +117,54 @@ void ZoneProvision::saveProvisioningConfig()
 std::string ZoneProvision::declareProvision(ZoneProvisioningConfig::Provision&& provision)
 {
     std::string id = getId(provision);
-    auto it = std::find_if(mProvisioningConfig.provisions.begin(),
-                           mProvisioningConfig.provisions.end(),
-                           [&](const ZoneProvisioningConfig::Provision& existingProvision) {
-                               return getId(existingProvision) == id;
-                           });
-    if (it != mProvisioningConfig.provisions.end()) {
+    if (mProvisionIndex.count(id) != 0) {
         const std::string msg = "Can't add provision. It already exists: " + id;
         LOGE(msg);
         throw lxcpp::ProvisionExistsException(msg);
     }
     mProvisioningConfig.provisions.push_back(std::move(provision));
+    mProvisionIds.push_back(id);
+    mProvisionIndex.emplace(id, mProvisionIds.size() - 1);
     saveProvisioningConfig();
     return id;
 }
 
+std::vector<std::string> ZoneProvision::declareProvisions(std::vector<ZoneProvisioningConfig::Provision>&& provisions)
+{
+    std::vector<std::string> ids;
+    ids.reserve(provisions.size());
+    std::unordered_set<std::string> batchIds;
+    for (const auto& provision : provisions) {
+        std::string id = getId(provision);
+        if (mProvisionIndex.count(id) != 0 || !batchIds.insert(id).second) {
+            const std::string msg = "Can't add provisions. Provision already exists: " + id;
+            LOGE(msg);
+            throw lxcpp::ProvisionExistsException(msg);
+        }
+        ids.push_back(std::move(id));
+    }
+
+    const std::size_t oldSize = mProvisionIds.size();
+    for (std::size_t i = 0; i < provisions.size(); ++i) {
+        mProvisioningConfig.provisions.push_back(std::move(provisions[i]));
+        mProvisionIds.push_back(ids[i]);
+    }
+    buildIndex(oldSize);
+
+    try {
+        saveProvisioningConfig();
+    } catch (...) {
+        for (const std::string& id : ids) {
+            mProvisionIndex.erase(id);
+        }
+        mProvisionIds.resize(oldSize);
+        mProvisioningConfig.provisions.erase(mProvisioningConfig.provisions.begin() + oldSize,
+                                             mProvisioningConfig.provisions.end());
+        throw;
+    }
+    return ids;
+}
+
 std::string ZoneProvision::declareFile(const int32_t& type,
                                        const std::string& path,
                                        const int32_t& flags,
@@ -123,19 +199,91 @@ std::string ZoneProvision::declareLink(const std::string& source,
 
 void ZoneProvision::start() noexcept
 {
+    // Provisions are applied in waves of equal target path depth, shallowest first,
+    // so a directory or a mount point is always in place before anything below it.
+    // Inside a wave directories go first, then the remaining files and links
+    // in parallel and finally mounts, in the order they were declared.
+    std::map<std::size_t, std::vector<const ZoneProvisioningConfig::Provision*>> waves;
     for (const auto& provision : mProvisioningConfig.provisions) {
-        try {
-            if (provision.is<ZoneProvisioningConfig::File>()) {
-                file(provision.as<ZoneProvisioningConfig::File>());
-            } else if (provision.is<ZoneProvisioningConfig::Mount>()) {
-                mount(provision.as<ZoneProvisioningConfig::Mount>());
-            } else if (provision.is<ZoneProvisioningConfig::Link>()) {
-                link(provision.as<ZoneProvisioningConfig::Link>());
+        waves[getDepth(getTarget(provision))].push_back(&provision);
+    }
+
+    for (const auto& wave : waves) {
+        std::vector<const ZoneProvisioningConfig::Provision*> independent;
+        std::vector<const ZoneProvisioningConfig::Provision*> mounts;
+        for (const auto provision : wave.second) {
+            if (provision->is<ZoneProvisioningConfig::Mount>()) {
+                mounts.push_back(provision);
+            } else if (provision->is<ZoneProvisioningConfig::File>() &&
+                       provision->as<ZoneProvisioningConfig::File>().type == VSMFILE_DIRECTORY) {
+                // createDirs may race on common parents, keep it sequential
+                if (apply(*provision)) {
+                    mProvisioned.push_front(*provision);
+                }
+            } else {
+                independent.push_back(provision);
             }
-            // mProvisioned must be FILO
-            mProvisioned.push_front(provision);
-        } catch (const std::exception& ex) {
-            LOGE("Provsion error: " << ex.what());
+        }
+
+        applyInParallel(independent);
+
+        for (const auto provision : mounts) {
+            if (apply(*provision)) {
+                // mProvisioned must be FILO
+                mProvisioned.push_front(*provision);
+            }
+        }
+    }
+}
+
+bool ZoneProvision::apply(const ZoneProvisioningConfig::Provision& provision) noexcept
+{
+    try {
+        if (provision.is<ZoneProvisioningConfig::File>()) {
+            file(provision.as<ZoneProvisioningConfig::File>());
+        } else if (provision.is<ZoneProvisioningConfig::Mount>()) {
+            mount(provision.as<ZoneProvisioningConfig::Mount>());
+        } else if (provision.is<ZoneProvisioningConfig::Link>()) {
+            link(provision.as<ZoneProvisioningConfig::Link>());
+        }
+        return true;
+    } catch (const std::exception& ex) {
+        LOGE("Provsion error: " << ex.what());
+        return false;
+    }
+}
+
+void ZoneProvision::applyInParallel(const std::vector<const ZoneProvisioningConfig::Provision*>& provisions)
+{
+    const std::size_t workersCount = std::min<std::size_t>(provisions.size(),
+                                                           std::max(1u, std::thread::hardware_concurrency()));
+    std::vector<char> applied(provisions.size(), 0);
+    std::atomic<std::size_t> next(0);
+
+    auto worker = [&] {
+        for (std::size_t i = next++; i < provisions.size(); i = next++) {
+            applied[i] = apply(*provisions[i]);
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (std::size_t i = 1; i < workersCount; ++i) {
+        try {
+            workers.emplace_back(worker);
+        } catch (const std::system_error& ex) {
+            LOGW("Can't spawn provisioning thread: " << ex.what());
+            break;
+        }
+    }
+    // The current thread takes part as well, it does everything if no thread was spawned
+    worker();
+    for (auto& thread : workers) {
+        thread.join();
+    }
+
+    for (std::size_t i = 0; i < provisions.size(); ++i) {
+        if (applied[i]) {
+            mProvisioned.push_front(*provisions[i]);
         }
     }
 }
@@ -158,28 +306,24 @@ void ZoneProvision::stop() noexcept
 
 std::vector<std::string> ZoneProvision::list() const
 {
-    std::vector<std::string> items;
-    for (const auto& provision : mProvisioningConfig.provisions) {
-        items.push_back(getId(provision));
-    }
-    return items;
+    return mProvisionIds;
 }
 
 void ZoneProvision::remove(const std::string& item)
 {
-
-    const auto it = std::find_if(mProvisioningConfig.provisions.begin(),
-                                 mProvisioningConfig.provisions.end(),
-                                 [&](const ZoneProvisioningConfig::Provision& provision) {
-                                    return getId(provision) == item;
-                                 });
-    if (it == mProvisioningConfig.provisions.end()) {
+    const auto it = mProvisionIndex.find(item);
+    if (it == mProvisionIndex.end()) {
         const std::string msg = "Can't remove provision: not found.";
         LOGE(msg);
         throw lxcpp::ProvisionNotFoundException(msg);
     }
 
-    mProvisioningConfig.provisions.erase(it);
+    const std::size_t pos = it->second;
+    mProvisionIndex.erase(it);
+    mProvisioningConfig.provisions.erase(mProvisioningConfig.provisions.begin() + pos);
+    mProvisionIds.erase(mProvisionIds.begin() + pos);
+    buildIndex(pos);
+    saveProvisioningConfig();
     LOGI("Provision removed: " << item);
 }
 
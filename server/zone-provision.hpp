@@ -31,6 +31,7 @@
 #include <string>
 #include <vector>
 #include <list>
+#include <unordered_map>
 
 namespace vasum {
 
@@ -81,6 +82,13 @@ public:
      */
     std::string declareLink(const std::string& source,
                             const std::string& target);
+    /**
+     * Declare many provisions at once
+     *
+     * Either all of them are stored or, if any is a duplicate, none.
+     * @return ids of the declared provisions, in the same order
+     */
+    std::vector<std::string> declareProvisions(std::vector<ZoneProvisioningConfig::Provision>&& provisions);
 
     void start() noexcept;
     void stop() noexcept;
@@ -104,7 +112,12 @@ private:
     std::string mDbPrefix;
     std::vector<std::string> mValidLinkPrefixes;
     std::list<ZoneProvisioningConfig::Provision> mProvisioned;
+    // ids of mProvisioningConfig.provisions, in the same order
+    std::vector<std::string> mProvisionIds;
+    // id -> position in mProvisioningConfig.provisions
+    std::unordered_map<std::string, std::size_t> mProvisionIndex;
 
+    void buildIndex(std::size_t from);
     void saveProvisioningConfig();
     std::string declareProvision(ZoneProvisioningConfig::Provision&& provision);
 
@@ -112,6 +125,8 @@ private:
     void umount(const ZoneProvisioningConfig::Mount& config);
     void file(const ZoneProvisioningConfig::File& config);
     void link(const ZoneProvisioningConfig::Link& config);
+    bool apply(const ZoneProvisioningConfig::Provision& provision) noexcept;
+    void applyInParallel(const std::vector<const ZoneProvisioningConfig::Provision*>& provisions);
 
     static std::string getId(const ZoneProvisioningConfig::File& file);
     static std::string getId(const ZoneProvisioningConfig::Mount& mount);
@@ -34,16 +34,20 @@
 #include "utils/vt.hpp"
 #include "utils/c-args.hpp"
 #include "lxc/cgroup.hpp"
+#include "netlink/netlink-message.hpp"
 #include "cargo-sqlite/cargo-sqlite.hpp"
 #include "cargo-sqlite-json/cargo-sqlite-json.hpp"
 
 #include <boost/filesystem.hpp>
 
+#include <algorithm>
 #include <cassert>
 #include <climits>
 #include <string>
 #include <thread>
 #include <chrono>
+#include <fstream>
+#include <sstream>
 
 namespace vasum {
 
@@ -60,6 +64,30 @@ const std::string STATE_PAUSED = "paused";
 const std::uint64_t DEFAULT_CPU_SHARES = 1024;
 const std::uint64_t DEFAULT_VCPU_PERIOD_MS = 100000;
 
+// 0 if the process doesn't exist
+std::uint64_t getProcessStartTime(pid_t pid)
+{
+    std::ifstream stat("/proc/" + std::to_string(pid) + "/stat");
+    std::string content;
+    if (!std::getline(stat, content)) {
+        return 0;
+    }
+
+    // the command name may contain spaces, the fields after it may not
+    const std::string::size_type pos = content.rfind(')');
+    if (pos == std::string::npos) {
+        return 0;
+    }
+    std::istringstream fields(content.substr(pos + 1));
+    std::string field;
+    // starttime is the 22nd field, the 20th after the command name
+    for (int i = 0; i < 19 && fields >> field; ++i) {
+    }
+    std::uint64_t startTime = 0;
+    fields >> startTime;
+    return startTime;
+}
+
 } // namespace
 
 Zone::Zone(const std::string& zoneId,
@@ -73,6 +101,10 @@ Zone::Zone(const std::string& zoneId,
     , mId(zoneId)
     , mDetachOnExit(false)
     , mDestroyOnExit(false)
+    , mHasRuntimeState(false)
+    , mRuntimeState(lxc::LxcZone::State::STOPPED)
+    , mRuntimeInitPid(-1)
+    , mRuntimeInitStartTime(0)
 {
     LOGD(mId << ": Instantiating Zone object");
 
@@ -186,6 +218,7 @@ void Zone::restore()
 void Zone::start()
 {
     Lock lock(mReconnectMutex);
+    dropRuntimeState();
 
     LOGD(mId << ": Starting...");
 
@@ -223,6 +256,8 @@ void Zone::start()
 
     LOGD(mId << ": Started");
 
+    applyBandwidth();
+
     // Increase cpu quota before connect, otherwise it'd take ages.
     goForeground();
     // refocus in ZonesManager will adjust cpu quota after all
@@ -231,6 +266,7 @@ void Zone::start()
 void Zone::stop(bool saveState)
 {
     Lock lock(mReconnectMutex);
+    dropRuntimeState();
 
     LOGD(mId << ": Stopping procedure started...");
 
@@ -247,6 +283,13 @@ void Zone::stop(bool saveState)
         return;
     }
 
+    // cached netlink connection would keep the zone's network namespace alive
+    netlink::closeConnection(getInitPid());
+    {
+        std::lock_guard<std::mutex> statsLock(mNetdevStatsMutex);
+        mNetdevStats.clear();
+    }
+
     if (!mZone.shutdown(mConfig.shutdownTimeout)) {
         // force stop
         if (!mZone.stop()) {
@@ -285,7 +328,7 @@ void Zone::createNetdevVeth(const std::string& zoneDev,
                             const std::string& hostDev)
 {
     Lock lock(mReconnectMutex);
-    netdev::createVeth(mZone.getInitPid(), zoneDev, hostDev);
+    netdev::createVeth(getInitPid(), zoneDev, hostDev);
 }
 
 void Zone::createNetdevMacvlan(const std::string& zoneDev,
@@ -293,19 +336,19 @@ void Zone::createNetdevMacvlan(const std::string& zoneDev,
                                const uint32_t& mode)
 {
     Lock lock(mReconnectMutex);
-    netdev::createMacvlan(mZone.getInitPid(), zoneDev, hostDev, static_cast<macvlan_mode>(mode));
+    netdev::createMacvlan(getInitPid(), zoneDev, hostDev, static_cast<macvlan_mode>(mode));
 }
 
 void Zone::moveNetdev(const std::string& devId)
 {
     Lock lock(mReconnectMutex);
-    netdev::movePhys(mZone.getInitPid(), devId);
+    netdev::movePhys(getInitPid(), devId);
 }
 
 void Zone::destroyNetdev(const std::string& devId)
 {
     Lock lock(mReconnectMutex);
-    netdev::destroyNetdev(devId, mZone.getInitPid());
+    netdev::destroyNetdev(devId, getInitPid());
 }
 
 void Zone::goForeground()
@@ -335,18 +378,19 @@ void Zone::setDestroyOnExit()
 bool Zone::isRunning()
 {
     Lock lock(mReconnectMutex);
-    return mZone.getState() == lxc::LxcZone::State::RUNNING;
+    return getState() == lxc::LxcZone::State::RUNNING;
 }
 
 bool Zone::isStopped()
 {
     Lock lock(mReconnectMutex);
-    return mZone.getState() == lxc::LxcZone::State::STOPPED;
+    return getState() == lxc::LxcZone::State::STOPPED;
 }
 
 void Zone::suspend()
 {
     Lock lock(mReconnectMutex);
+    dropRuntimeState();
 
     LOGD(mId << ": Pausing...");
     if (!mZone.freeze()) {
@@ -360,6 +404,7 @@ void Zone::suspend()
 void Zone::resume()
 {
     Lock lock(mReconnectMutex);
+    dropRuntimeState();
 
     LOGD(mId << ": Resuming...");
     if (!mZone.unfreeze()) {
@@ -373,7 +418,7 @@ void Zone::resume()
 bool Zone::isPaused()
 {
     Lock lock(mReconnectMutex);
-    return mZone.getState() == lxc::LxcZone::State::FROZEN;
+    return getState() == lxc::LxcZone::State::FROZEN;
 }
 
 bool Zone::isSwitchToDefaultAfterTimeoutAllowed() const
@@ -413,6 +458,11 @@ std::string Zone::declareLink(const std::string& source,
     return mProvision->declareLink(source, target);
 }
 
+std::vector<std::string> Zone::declareProvisions(std::vector<ZoneProvisioningConfig::Provision>&& provisions)
+{
+    return mProvision->declareProvisions(std::move(provisions));
+}
+
 std::vector<std::string> Zone::getDeclarations() const
 {
     return mProvision->list();
@@ -426,25 +476,195 @@ void Zone::removeDeclaration(const std::string& declarationId)
 void Zone::setNetdevAttrs(const std::string& netdev, const NetdevAttrs& attrs)
 {
     Lock lock(mReconnectMutex);
-    netdev::setAttrs(mZone.getInitPid(), netdev, attrs);
+    netdev::setAttrs(getInitPid(), netdev, attrs);
 }
 
 Zone::NetdevAttrs Zone::getNetdevAttrs(const std::string& netdev)
 {
     Lock lock(mReconnectMutex);
-    return netdev::getAttrs(mZone.getInitPid(), netdev);
+    return netdev::getAttrs(getInitPid(), netdev);
 }
 
 std::vector<std::string> Zone::getNetdevList()
 {
     Lock lock(mReconnectMutex);
-    return netdev::listNetdev(mZone.getInitPid());
+    return netdev::listNetdev(getInitPid());
 }
 
 void Zone::deleteNetdevIpAddress(const std::string& netdev, const std::string& ip)
 {
     Lock lock(mReconnectMutex);
-    netdev::deleteIpAddress(mZone.getInitPid(), netdev, ip);
+    netdev::deleteIpAddress(getInitPid(), netdev, ip);
+}
+
+std::vector<std::string> Zone::applyNetdev(const netdev::DeviceConfig& config)
+{
+    Lock lock(mReconnectMutex);
+    return netdev::apply(getInitPid(), config);
+}
+
+void Zone::setNetdevBandwidth(const std::string& netdev, const netdev::Bandwidth& limits)
+{
+    Lock lock(mReconnectMutex);
+
+    if (isRunning()) {
+        netdev::setBandwidth(getInitPid(), netdev, limits);
+    }
+
+    std::vector<ZoneBandwidthConfig>& bandwidth = mDynamicConfig.bandwidth;
+    auto it = std::find_if(bandwidth.begin(), bandwidth.end(), [&](const ZoneBandwidthConfig& entry) {
+        return entry.netdev == netdev;
+    });
+    if (limits.downloadRate == 0 && limits.uploadRate == 0) {
+        if (it != bandwidth.end()) {
+            bandwidth.erase(it);
+        }
+    } else {
+        if (it == bandwidth.end()) {
+            it = bandwidth.insert(bandwidth.end(), ZoneBandwidthConfig());
+            it->netdev = netdev;
+        }
+        it->downloadRate = limits.downloadRate;
+        it->uploadRate = limits.uploadRate;
+        it->burst = limits.burst;
+    }
+    saveDynamicConfig();
+}
+
+std::vector<Zone::NetdevStats> Zone::getNetdevStats()
+{
+    Lock lock(mReconnectMutex);
+    std::lock_guard<std::mutex> statsLock(mNetdevStatsMutex);
+
+    std::vector<NetdevStats> result;
+    for (const auto& counters : netdev::getStatistics(getInitPid())) {
+        NetdevStats stats{counters, 0, 0, 0, 0};
+        for (const auto& sample : mNetdevStats) {
+            if (sample.counters.name == counters.name) {
+                stats.rxBytesRate = sample.rxBytesRate;
+                stats.txBytesRate = sample.txBytesRate;
+                stats.rxPacketsRate = sample.rxPacketsRate;
+                stats.txPacketsRate = sample.txPacketsRate;
+                break;
+            }
+        }
+        result.push_back(stats);
+    }
+    return result;
+}
+
+void Zone::sampleNetdevStats()
+{
+    pid_t initPid;
+    {
+        Lock lock(mReconnectMutex);
+        initPid = getInitPid();
+    }
+    // the dump is done without mReconnectMutex, so requests to the zone don't wait for it
+    const std::vector<netdev::Statistics> current = netdev::getStatistics(initPid);
+
+    std::lock_guard<std::mutex> statsLock(mNetdevStatsMutex);
+    const auto now = std::chrono::steady_clock::now();
+    const double seconds = std::chrono::duration<double>(now - mNetdevStatsTime).count();
+    // counters are reset when a device is created again
+    auto rate = [seconds](std::uint64_t previous, std::uint64_t current) -> std::uint64_t {
+        return current >= previous ? static_cast<std::uint64_t>((current - previous) / seconds) : 0;
+    };
+
+    std::vector<NetdevStats> samples;
+    for (const auto& counters : current) {
+        NetdevStats stats{counters, 0, 0, 0, 0};
+        for (const auto& previous : mNetdevStats) {
+            if (previous.counters.name == counters.name && seconds > 0) {
+                stats.rxBytesRate = rate(previous.counters.rxBytes, counters.rxBytes);
+                stats.txBytesRate = rate(previous.counters.txBytes, counters.txBytes);
+                stats.rxPacketsRate = rate(previous.counters.rxPackets, counters.rxPackets);
+                stats.txPacketsRate = rate(previous.counters.txPackets, counters.txPackets);
+                break;
+            }
+        }
+        samples.push_back(stats);
+    }
+    mNetdevStats.swap(samples);
+    mNetdevStatsTime = now;
+}
+
+void Zone::applyBandwidth()
+{
+    for (const ZoneBandwidthConfig& bandwidth : mDynamicConfig.bandwidth) {
+        try {
+            netdev::setBandwidth(getInitPid(), bandwidth.netdev, {bandwidth.downloadRate,
+                                                                  bandwidth.uploadRate,
+                                                                  bandwidth.burst});
+        } catch (const std::exception& ex) {
+            // the zone works, just without limits
+            LOGE(mId << ": Can't limit bandwidth of " << bandwidth.netdev << ": " << ex.what());
+        }
+    }
+}
+
+ZoneRuntimeState Zone::getRuntimeState()
+{
+    Lock lock(mReconnectMutex);
+
+    ZoneRuntimeState state;
+    state.id = mId;
+    state.state = lxc::LxcZone::toString(getState());
+    state.initPid = getInitPid();
+    state.initStartTime = state.initPid > 0 ? getProcessStartTime(state.initPid) : 0;
+    return state;
+}
+
+void Zone::setRuntimeState(const ZoneRuntimeState& state)
+{
+    Lock lock(mReconnectMutex);
+
+    mRuntimeState = lxc::LxcZone::fromString(state.state);
+    mRuntimeInitPid = state.initPid;
+    mRuntimeInitStartTime = state.initStartTime;
+    mHasRuntimeState = true;
+    LOGD(mId << ": Using handed over state " << state.state << ", init pid " << state.initPid);
+}
+
+lxc::LxcZone::State Zone::getState()
+{
+    // assume mutex is locked
+    if (isRuntimeStateValid()) {
+        return mRuntimeState;
+    }
+    return mZone.getState();
+}
+
+pid_t Zone::getInitPid()
+{
+    // assume mutex is locked
+    if (isRuntimeStateValid() && mRuntimeInitPid > 0) {
+        return mRuntimeInitPid;
+    }
+    return mZone.getInitPid();
+}
+
+bool Zone::isRuntimeStateValid()
+{
+    // assume mutex is locked
+    if (!mHasRuntimeState) {
+        return false;
+    }
+    // a zone's state changes only through this object, unless its init dies;
+    // the start time tells if the pid was reused by another process since
+    if (mRuntimeInitPid <= 0 ||
+        (mRuntimeInitStartTime != 0 && getProcessStartTime(mRuntimeInitPid) == mRuntimeInitStartTime)) {
+        return true;
+    }
+    LOGD(mId << ": Handed over state is stale");
+    dropRuntimeState();
+    return false;
+}
+
+void Zone::dropRuntimeState()
+{
+    // assume mutex is locked
+    mHasRuntimeState = false;
 }
 
 std::int64_t Zone::getSchedulerQuota()
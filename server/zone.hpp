@@ -32,6 +32,7 @@
 #include "lxc/zone.hpp"
 #include "netdev.hpp"
 
+#include <chrono>
 #include <mutex>
 #include <string>
 #include <memory>
@@ -51,6 +52,18 @@ class Zone {
 public:
     typedef netdev::Attrs NetdevAttrs;
 
+    /**
+     * Traffic of a zone network device
+     */
+    struct NetdevStats {
+        netdev::Statistics counters;
+        // per second, between the last two samples
+        std::uint64_t rxBytesRate;
+        std::uint64_t txBytesRate;
+        std::uint64_t rxPacketsRate;
+        std::uint64_t txPacketsRate;
+    };
+
     /**
      * Zone constructor
      * @param zoneId zone id
@@ -201,6 +214,11 @@ public:
     std::string declareLink(const std::string& source,
                             const std::string& target);
 
+    /**
+     * Declare many provisions at once, all or none of them
+     */
+    std::vector<std::string> declareProvisions(std::vector<ZoneProvisioningConfig::Provision>&& provisions);
+
     /**
      * Gets all declarations
      */
@@ -259,6 +277,45 @@ public:
      */
     void deleteNetdevIpAddress(const std::string& netdev, const std::string& ip);
 
+    /**
+     * Bring network device to the described configuration
+     *
+     * @return list of changes that were made
+     */
+    std::vector<std::string> applyNetdev(const netdev::DeviceConfig& config);
+
+    /**
+     * Limit bandwidth of zone veth device
+     *
+     * Limits are saved and applied again whenever the zone starts.
+     * Limits of each device are kept until they are set to zero.
+     */
+    void setNetdevBandwidth(const std::string& netdev, const netdev::Bandwidth& limits);
+
+    /**
+     * Get traffic counters of zone network devices
+     *
+     * Rates come from the last two sampleNetdevStats() calls, they are 0 without them.
+     */
+    std::vector<NetdevStats> getNetdevStats();
+
+    /**
+     * Read traffic counters and compute rates since the previous sample
+     */
+    void sampleNetdevStats();
+
+    /**
+     * Get the runtime state that is handed over to a new server instance on update
+     */
+    ZoneRuntimeState getRuntimeState();
+
+    /**
+     * Use runtime state handed over by the previous server instance.
+     * The state is trusted until the zone's state is changed or its init process is gone,
+     * so no lxc queries are needed right after the update.
+     */
+    void setRuntimeState(const ZoneRuntimeState& state);
+
     /**
      * Sets the zones scheduler CFS quota.
      */
@@ -281,11 +338,23 @@ private:
     const std::string mId;
     bool mDetachOnExit;
     bool mDestroyOnExit;
+    bool mHasRuntimeState;
+    lxc::LxcZone::State mRuntimeState;
+    pid_t mRuntimeInitPid;
+    std::uint64_t mRuntimeInitStartTime;
+    std::mutex mNetdevStatsMutex;
+    std::vector<NetdevStats> mNetdevStats;
+    std::chrono::steady_clock::time_point mNetdevStatsTime;
 
     void onNameLostCallback();
+    lxc::LxcZone::State getState();
+    pid_t getInitPid();
+    bool isRuntimeStateValid();
+    void dropRuntimeState();
     void saveDynamicConfig();
     void updateRequestedState(const std::string& state);
     void setSchedulerParams(std::uint64_t cpuShares, std::uint64_t vcpuPeriod, std::int64_t vcpuQuota);
+    void applyBandwidth();
 };
 
 
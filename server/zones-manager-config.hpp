@@ -29,6 +29,7 @@
 #include "cargo/fields.hpp"
 #include "input-monitor-config.hpp"
 #include "proxy-call-config.hpp"
+#include "zone-config.hpp"
 
 #include <string>
 #include <vector>
@@ -84,6 +85,18 @@ struct ZonesManagerConfig {
      */
     std::string runMountPointPrefix;
 
+    /**
+     * If set then links and addresses of zones are read from memory,
+     * the state is kept up to date by netlink notifications.
+     */
+    bool cacheNetworkState;
+
+    /**
+     * Interval (in milliseconds) of sampling zones network statistics
+     * to compute transfer rates, 0 disables the sampling.
+     */
+    unsigned int netdevStatsInterval;
+
     /**
      * Proxy call rules.
      */
@@ -100,6 +113,8 @@ struct ZonesManagerConfig {
         availableVTs,
         inputConfig,
         runMountPointPrefix,
+        cacheNetworkState,
+        netdevStatsInterval,
         proxyCallRules
     )
 };
@@ -123,6 +138,25 @@ struct ZonesManagerDynamicConfig {
     )
 };
 
+struct ZonesManagerRuntimeState {
+
+    /**
+     * An ID of the zone that was in the foreground.
+     */
+    std::string activeZoneId;
+
+    /**
+     * Runtime state of every managed zone.
+     */
+    std::vector<ZoneRuntimeState> zones;
+
+    CARGO_REGISTER
+    (
+        activeZoneId,
+        zones
+    )
+};
+
 } // namespace vasum
 
 
@@ -29,6 +29,7 @@
 #include "zones-manager.hpp"
 #include "lxc/cgroup.hpp"
 #include "exception.hpp"
+#include "zone-provision-config.hpp"
 
 #include "utils/paths.hpp"
 #include "logger/logger.hpp"
@@ -41,6 +42,12 @@
 #include "utils/environment.hpp"
 #include "utils/vt.hpp"
 #include "api/messages.hpp"
+#include "lxcpp/exception.hpp"
+#include "netlink/netlink-message.hpp"
+
+#ifdef DBUS_CONNECTION
+#include "api/dbus-method-result-builder.hpp"
+#endif //DBUS_CONNECTION
 
 #include <boost/filesystem.hpp>
 #include <boost/exception/diagnostic_information.hpp>
@@ -72,6 +79,11 @@ const rgx::regex ZONE_IP_THIRD_OCTET_REGEX("~IP~");
 
 const unsigned int ZONE_IP_BASE_THIRD_OCTET = 100;
 
+#ifdef DBUS_CONNECTION
+// Limit of proxy calls from one caller waiting for the target's reply
+const unsigned int MAX_PENDING_PROXY_CALLS_PER_CALLER = 64;
+#endif //DBUS_CONNECTION
+
 const std::vector<std::string> prohibitedZonesNames{
     ENABLED_FILE_NAME,
     "lxc-monitord.log"
@@ -84,6 +96,62 @@ void remove(std::vector<T>& v, const T& item)
     v.erase(std::remove(v.begin(), v.end(), item), v.end());
 }
 
+ZoneProvisioningConfig::Provision toProvision(const api::DeclarationIn& in)
+{
+    ZoneProvisioningConfig::Provision provision;
+    switch (in.kind) {
+        case api::DECLARATION_FILE:
+            provision.set(ZoneProvisioningConfig::File({in.fileType,
+                                                        in.target,
+                                                        static_cast<std::int32_t>(in.flags),
+                                                        in.mode}));
+            break;
+        case api::DECLARATION_MOUNT:
+            provision.set(ZoneProvisioningConfig::Mount({in.source,
+                                                         in.target,
+                                                         in.fsType,
+                                                         static_cast<std::int64_t>(in.flags),
+                                                         in.data}));
+            break;
+        case api::DECLARATION_LINK:
+            provision.set(ZoneProvisioningConfig::Link({in.source, in.target}));
+            break;
+        default:
+            throw lxcpp::ProvisionNotSupportedException("Unknown declaration type: " +
+                                                        std::to_string(in.kind));
+    }
+    return provision;
+}
+
+netdev::DeviceConfig toDeviceConfig(const api::NetDevApplyIn& in)
+{
+    netdev::DeviceConfig config;
+    switch (in.type) {
+        case api::NETDEV_VETH:
+            config.type = netdev::DeviceConfig::Type::VETH;
+            break;
+        case api::NETDEV_PHYS:
+            config.type = netdev::DeviceConfig::Type::PHYS;
+            break;
+        case api::NETDEV_MACVLAN:
+            config.type = netdev::DeviceConfig::Type::MACVLAN;
+            break;
+        default:
+            throw VasumException("Unknown network device type: " + std::to_string(in.type));
+    }
+    config.name = in.netDev;
+    config.hostDev = in.hostDev;
+    config.macvlanMode = static_cast<macvlan_mode>(in.macvlanMode);
+    config.mtu = in.mtu;
+    config.mac = in.mac;
+    config.addresses = in.addresses;
+    for (const auto& route : in.routes) {
+        config.routes.push_back({route.dst, route.gateway, route.metric});
+    }
+    config.up = in.up;
+    return config;
+}
+
 template<typename Iter, typename Predicate>
 Iter circularFindNext(Iter begin, Iter end, Iter current, Predicate pred)
 {
@@ -104,12 +172,12 @@ Iter circularFindNext(Iter begin, Iter end, Iter current, Predicate pred)
     }
 }
 
-Zone& get(std::vector<std::unique_ptr<Zone>>::iterator iter)
+Zone& get(std::vector<std::shared_ptr<Zone>>::iterator iter)
 {
     return **iter;
 }
 
-bool zoneIsRunning(const std::unique_ptr<Zone>& zone) {
+bool zoneIsRunning(const std::shared_ptr<Zone>& zone) {
     return zone->isRunning();
 }
 
@@ -183,10 +251,16 @@ ZonesManager::ZonesManager(cargo::ipc::epoll::EventPoll& eventPoll, const std::s
                                         mDynamicConfig,
                                         getVasumDbPrefix());
 
+    netlink::setCacheEnabled(mConfig.cacheNetworkState);
+
     if (mConfig.inputConfig.enabled) {
         LOGI("Registering input monitor [" << mConfig.inputConfig.device.c_str() << "]");
         mSwitchingSequenceMonitor.reset(new InputMonitor(eventPoll, mConfig.inputConfig, this));
     }
+
+    if (mConfig.netdevStatsInterval > 0) {
+        mNetdevStatsSampler.reset(new NetdevStatsSampler(eventPoll, mConfig.netdevStatsInterval, this));
+    }
 }
 
 ZonesManager::~ZonesManager()
@@ -216,6 +290,21 @@ void ZonesManager::start()
         insertZone(zoneId, getTemplatePathForExistingZone(zoneId));
     }
 
+    if (mHandedOverState) {
+        for (const auto& zoneState : mHandedOverState->zones) {
+            auto iter = findZone(zoneState.id);
+            if (iter == mZones.end()) {
+                LOGW("Handed over state of unknown zone " << zoneState.id);
+                continue;
+            }
+            get(iter).setRuntimeState(zoneState);
+        }
+        if (findZone(mHandedOverState->activeZoneId) != mZones.end()) {
+            mActiveZoneId = mHandedOverState->activeZoneId;
+        }
+        mHandedOverState.reset();
+    }
+
     updateDefaultId();
 
     LOGD("ZonesManager object instantiated");
@@ -225,12 +314,23 @@ void ZonesManager::start()
         mSwitchingSequenceMonitor->start();
     }
 
+    if (mNetdevStatsSampler) {
+        LOGI("Starting network statistics sampler");
+        mNetdevStatsSampler->start();
+    }
+
     // After everything's initialized start to respond to clients' requests
     mHostIPCConnection.start();
 }
 
 void ZonesManager::stop(bool wait)
 {
+    if (mNetdevStatsSampler) {
+        // before locking mMutex, a sample in progress needs it
+        LOGI("Stopping network statistics sampler");
+        mNetdevStatsSampler->stop();
+    }
+
     Lock lock(mMutex);
     LOGD("Stopping ZonesManager");
 
@@ -264,7 +364,7 @@ bool ZonesManager::isRunning()
 
 ZonesManager::Zones::iterator ZonesManager::findZone(const std::string& id)
 {
-    return std::find_if(mZones.begin(), mZones.end(), [&id](const std::unique_ptr<Zone>& zone) {
+    return std::find_if(mZones.begin(), mZones.end(), [&id](const std::shared_ptr<Zone>& zone) {
         return zone->getId() == id;
     });
 }
@@ -322,7 +422,7 @@ void ZonesManager::insertZone(const std::string& zoneId, const std::string& zone
     }
 
     LOGT("Creating Zone " << zoneId);
-    std::unique_ptr<Zone> zone(new Zone(zoneId,
+    std::shared_ptr<Zone> zone(new Zone(zoneId,
                                         mConfig.zonesPath,
                                         zoneTemplatePath,
                                         mConfig.dbPath,
@@ -563,6 +663,27 @@ void ZonesManager::switchingSequenceMonitorNotify()
     }
 }
 
+void ZonesManager::sampleNetdevStats()
+{
+    // netlink dumps of all zones don't block the manager, a zone destroyed
+    // meanwhile is freed when its sample is done
+    Zones zones;
+    {
+        Lock lock(mMutex);
+        zones = mZones;
+    }
+
+    for (auto& zone : zones) {
+        if (!zone->isRunning()) {
+            continue;
+        }
+        try {
+            zone->sampleNetdevStats();
+        } catch (const std::exception& ex) {
+            LOGW(zone->getId() << ": Can't sample network statistics: " << ex.what());
+        }
+    }
+}
 
 void ZonesManager::setZonesDetachOnExit()
 {
@@ -575,6 +696,24 @@ void ZonesManager::setZonesDetachOnExit()
     }
 }
 
+ZonesManagerRuntimeState ZonesManager::getRuntimeState()
+{
+    Lock lock(mMutex);
+
+    ZonesManagerRuntimeState state;
+    state.activeZoneId = mActiveZoneId;
+    for (auto& zone : mZones) {
+        state.zones.push_back(zone->getRuntimeState());
+    }
+    return state;
+}
+
+void ZonesManager::setRuntimeState(const ZonesManagerRuntimeState& state)
+{
+    Lock lock(mMutex);
+    mHandedOverState.reset(new ZonesManagerRuntimeState(state));
+}
+
 void ZonesManager::disconnectedCallback(const std::string& id)
 {
     LOGD("Client Disconnected: " << id);
@@ -588,8 +727,7 @@ void ZonesManager::disconnectedCallback(const std::string& id)
     }
 }
 
-void ZonesManager::handleSwitchToDefaultCall(const std::string& /*caller*/,
-                                             api::MethodResultBuilder::Pointer result)
+void ZonesManager::handleSwitchToDefaultCall(api::MethodResultBuilder::Pointer result)
 {
     auto handler = [&, this] {
         // get config of currently set zone and switch if switchToDefaultAfterTimeout is true
@@ -652,46 +790,75 @@ void ZonesManager::handleProxyCall(const std::string& caller,
                                    GVariant* parameters,
                                    dbus::MethodResultBuilder::Pointer result)
 {
-    auto handler = [&, this] {
-        if (!mProxyCallPolicy->isProxyCallAllowed(caller,
-                                                  target,
-                                                  targetBusName,
-                                                  targetObjectPath,
-                                                  targetInterface,
-                                                  targetMethod)) {
-            LOGW("Forbidden proxy call; " << caller << " -> " << target << "; " << targetBusName
-                 << "; " << targetObjectPath << "; " << targetInterface << "; " << targetMethod);
-            result->setError(api::ERROR_FORBIDDEN, "Proxy call forbidden");
+    // Proxy calls are dispatched directly from the glib thread and never enter the worker,
+    // so they are not serialized with other calls and cannot be locked by lock/unlock queue.
+    if (!mProxyCallPolicy->isProxyCallAllowed(caller,
+                                              target,
+                                              targetBusName,
+                                              targetObjectPath,
+                                              targetInterface,
+                                              targetMethod)) {
+        LOGW("Forbidden proxy call; " << caller << " -> " << target << "; " << targetBusName
+             << "; " << targetObjectPath << "; " << targetInterface << "; " << targetMethod);
+        result->setError(api::ERROR_FORBIDDEN, "Proxy call forbidden");
+        return;
+    }
+
+    if (target != HOST_ID) {
+        result->setError(api::ERROR_INVALID_ID, "Unknown proxy call target");
+        return;
+    }
+
+    // The policy is checked for the caller's kind, but the pending calls are
+    // limited for each connection, so one busy peer can't starve the others
+    const std::string peerId = api::DBUS_CONNECTION_PREFIX + result->getPeerName();
+    {
+        std::lock_guard<std::mutex> lock(mProxyCallMutex);
+        unsigned int& pending = mPendingProxyCalls[peerId];
+        if (pending >= MAX_PENDING_PROXY_CALLS_PER_CALLER) {
+            LOGW("Too many pending proxy calls from " << peerId);
+            result->setError(api::ERROR_QUEUE, "Too many pending proxy calls");
             return;
         }
+        ++pending;
+    }
 
-        LOGI("Proxy call; " << caller << " -> " << target << "; " << targetBusName
-             << "; " << targetObjectPath << "; " << targetInterface << "; " << targetMethod);
+    LOGI("Proxy call; " << caller << " -> " << target << "; " << targetBusName
+         << "; " << targetObjectPath << "; " << targetInterface << "; " << targetMethod);
 
-        auto asyncResultCallback = [result](dbus::AsyncMethodCallResult & asyncMethodCallResult) {
-            try {
-                GVariant* targetResult = asyncMethodCallResult.get();
-                result->set(g_variant_new("(v)", targetResult));
-            } catch (dbus::DbusException& e) {
-                result->setError(api::ERROR_FORWARDED, e.what());
-            }
-        };
+    auto asyncResultCallback = [this, peerId, result](dbus::AsyncMethodCallResult & asyncMethodCallResult) {
+        releasePendingProxyCall(peerId);
 
-        if (target != HOST_ID) {
-            result->setError(api::ERROR_INVALID_ID, "Unknown proxy call target");
-            return;
+        try {
+            GVariant* targetResult = asyncMethodCallResult.get();
+            result->set(g_variant_new("(v)", targetResult));
+        } catch (dbus::DbusException& e) {
+            result->setError(api::ERROR_FORWARDED, e.what());
         }
+    };
 
+    try {
         mHostDbusConnection.proxyCallAsync(targetBusName,
                                            targetObjectPath,
                                            targetInterface,
                                            targetMethod,
                                            parameters,
                                            asyncResultCallback);
-    };
+    } catch (const std::exception& ex) {
+        // the result callback won't be called
+        releasePendingProxyCall(peerId);
+        LOGE("Proxy call failed: " << ex.what());
+        result->setError(api::ERROR_INTERNAL, ex.what());
+    }
+}
 
-    // This call cannot be locked by lock/unlock queue
-    mWorker->addTaskAndWait(handler);
+void ZonesManager::releasePendingProxyCall(const std::string& peerId)
+{
+    std::lock_guard<std::mutex> lock(mProxyCallMutex);
+    auto it = mPendingProxyCalls.find(peerId);
+    if (it != mPendingProxyCalls.end() && --it->second == 0) {
+        mPendingProxyCalls.erase(it);
+    }
 }
 #endif //DBUS_CONNECTION
 
@@ -1002,6 +1169,85 @@ void ZonesManager::handleDeleteNetdevIpAddressCall(const api::DeleteNetdevIpAddr
     tryAddTask(handler, result, true);
 }
 
+void ZonesManager::handleNetdevApplyCall(const api::NetDevApplyIn& data,
+                                         api::MethodResultBuilder::Pointer result)
+{
+    auto handler = [&, this] {
+        LOGI("NetdevApply call");
+
+        try {
+            const netdev::DeviceConfig config = toDeviceConfig(data);
+            Lock lock(mMutex);
+            auto changes = std::make_shared<api::NetDevApplyOut>();
+            changes->values = getZone(data.zone).applyNetdev(config);
+            result->set(changes);
+        } catch (const InvalidZoneIdException&) {
+            LOGE("No zone with id=" << data.zone);
+            result->setError(api::ERROR_INVALID_ID, "No such zone id");
+        } catch (const std::runtime_error& ex) {
+            LOGE("Can't apply network device configuration: " << ex.what());
+            result->setError(api::ERROR_INTERNAL, ex.what());
+        }
+    };
+
+    tryAddTask(handler, result, true);
+}
+
+void ZonesManager::handleSetNetdevBandwidthCall(const api::SetNetDevBandwidthIn& data,
+                                                api::MethodResultBuilder::Pointer result)
+{
+    auto handler = [&, this] {
+        LOGI("SetNetdevBandwidth call");
+
+        try {
+            Lock lock(mMutex);
+            getZone(data.zone).setNetdevBandwidth(data.netDev,
+                                                  {data.downloadRate, data.uploadRate, data.burst});
+            result->setVoid();
+        } catch (const InvalidZoneIdException&) {
+            LOGE("No zone with id=" << data.zone);
+            result->setError(api::ERROR_INVALID_ID, "No such zone id");
+        } catch (const std::runtime_error& ex) {
+            LOGE("Can't set bandwidth: " << ex.what());
+            result->setError(api::ERROR_INTERNAL, ex.what());
+        }
+    };
+
+    tryAddTask(handler, result, true);
+}
+
+void ZonesManager::handleGetNetdevStatsCall(const api::ZoneId& zoneId,
+                                            api::MethodResultBuilder::Pointer result)
+{
+    auto handler = [&, this] {
+        LOGI("GetNetdevStats call");
+
+        try {
+            Lock lock(mMutex);
+            auto stats = std::make_shared<api::NetDevStatsOut>();
+            for (const auto& netdev : getZone(zoneId.value).getNetdevStats()) {
+                const netdev::Statistics& counters = netdev.counters;
+                stats->values.push_back({counters.name,
+                                         counters.rxBytes, counters.txBytes,
+                                         counters.rxPackets, counters.txPackets,
+                                         counters.rxDropped, counters.txDropped,
+                                         counters.rxErrors, counters.txErrors,
+                                         netdev.rxBytesRate, netdev.txBytesRate,
+                                         netdev.rxPacketsRate, netdev.txPacketsRate});
+            }
+            result->set(stats);
+        } catch (const InvalidZoneIdException&) {
+            LOGE("No zone with id=" << zoneId.value);
+            result->setError(api::ERROR_INVALID_ID, "No such zone id");
+        } catch (const std::runtime_error& ex) {
+            LOGE("Can't get network statistics: " << ex.what());
+            result->setError(api::ERROR_INTERNAL, ex.what());
+        }
+    };
+
+    tryAddTask(handler, result, true);
+}
+
 void ZonesManager::handleDeclareFileCall(const api::DeclareFileIn& data,
                                          api::MethodResultBuilder::Pointer result)
 {
@@ -1071,6 +1317,38 @@ void ZonesManager::handleDeclareLinkCall(const api::DeclareLinkIn& data,
     tryAddTask(handler, result, true);
 }
 
+void ZonesManager::handleDeclareBatchCall(const api::DeclareBatchIn& data,
+                                          api::MethodResultBuilder::Pointer result)
+{
+    auto handler = [&, this] {
+        LOGI("DeclareBatch call, count=" << data.declarations.size());
+
+        try {
+            std::vector<ZoneProvisioningConfig::Provision> provisions;
+            provisions.reserve(data.declarations.size());
+            for (const auto& declaration : data.declarations) {
+                provisions.push_back(toProvision(declaration));
+            }
+
+            Lock lock(mMutex);
+            auto declarations = std::make_shared<api::Declarations>();
+            declarations->values = getZone(data.zone).declareProvisions(std::move(provisions));
+            result->set(declarations);
+        } catch (const InvalidZoneIdException&) {
+            LOGE("No zone with id=" << data.zone);
+            result->setError(api::ERROR_INVALID_ID, "No such zone id");
+        } catch (const lxcpp::Exception& ex) {
+            LOGE("Can't declare batch: " << ex.what());
+            result->setError(api::ERROR_INVALID_STATE, ex.what());
+        } catch (const cargo::CargoException& ex) {
+            LOGE("Can't declare batch: " << ex.what());
+            result->setError(api::ERROR_INTERNAL, "Internal error");
+        }
+    };
+
+    tryAddTask(handler, result, true);
+}
+
 void ZonesManager::handleGetDeclarationsCall(const api::ZoneId& zoneId,
                                              api::MethodResultBuilder::Pointer result)
 {
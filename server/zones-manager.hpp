@@ -30,6 +30,7 @@
 #include "zones-manager-config.hpp"
 #include "api/messages.hpp"
 #include "input-monitor.hpp"
+#include "netdev-stats-sampler.hpp"
 #include "utils/worker.hpp"
 #include "api/method-result-builder.hpp"
 
@@ -42,6 +43,8 @@
 
 #include <string>
 #include <memory>
+#include <mutex>
+#include <unordered_map>
 
 
 namespace vasum {
@@ -136,6 +139,17 @@ public:
      */
     void setZonesDetachOnExit();
 
+    /**
+     * Get the runtime state that is handed over to a new server instance on update
+     */
+    ZonesManagerRuntimeState getRuntimeState();
+
+    /**
+     * Use runtime state handed over by the previous server instance.
+     * Has to be called before start().
+     */
+    void setRuntimeState(const ZonesManagerRuntimeState& state);
+
     /**
      * Callback on a client (ipc/dbus) disconnect
      */
@@ -164,12 +178,20 @@ public:
                                  api::MethodResultBuilder::Pointer result);
     void handleDeleteNetdevIpAddressCall(const api::DeleteNetdevIpAddressIn& data,
                                          api::MethodResultBuilder::Pointer result);
+    void handleNetdevApplyCall(const api::NetDevApplyIn& data,
+                               api::MethodResultBuilder::Pointer result);
+    void handleSetNetdevBandwidthCall(const api::SetNetDevBandwidthIn& data,
+                                      api::MethodResultBuilder::Pointer result);
+    void handleGetNetdevStatsCall(const api::ZoneId& data,
+                                  api::MethodResultBuilder::Pointer result);
     void handleDeclareFileCall(const api::DeclareFileIn& data,
                                api::MethodResultBuilder::Pointer result);
     void handleDeclareMountCall(const api::DeclareMountIn& data,
                                 api::MethodResultBuilder::Pointer result);
     void handleDeclareLinkCall(const api::DeclareLinkIn& data,
                                api::MethodResultBuilder::Pointer result);
+    void handleDeclareBatchCall(const api::DeclareBatchIn& data,
+                                api::MethodResultBuilder::Pointer result);
     void handleGetDeclarationsCall(const api::ZoneId& data,
                                    api::MethodResultBuilder::Pointer result);
     void handleRemoveDeclarationCall(const api::RemoveDeclarationIn& data,
@@ -194,12 +216,16 @@ public:
                                 api::MethodResultBuilder::Pointer result);
     void handleCreateFileCall(const api::CreateFileIn& request,
                               api::MethodResultBuilder::Pointer result);
-    void handleSwitchToDefaultCall(const std::string& caller,
-                                   api::MethodResultBuilder::Pointer result);
+    void handleSwitchToDefaultCall(api::MethodResultBuilder::Pointer result);
     void handleCleanUpZonesRootCall(api::MethodResultBuilder::Pointer result);
 
     void switchingSequenceMonitorNotify();
 
+    /**
+     * Sample network statistics of all running zones
+     */
+    void sampleNetdevStats();
+
 private:
     typedef std::recursive_mutex Mutex;
     typedef std::unique_lock<Mutex> Lock;
@@ -211,12 +237,14 @@ private:
     ZonesManagerDynamicConfig mDynamicConfig;
     // to hold InputMonitor pointer to monitor if zone switching sequence is recognized
     std::unique_ptr<InputMonitor> mSwitchingSequenceMonitor;
+    std::unique_ptr<NetdevStatsSampler> mNetdevStatsSampler;
     // like set but keep insertion order
     // smart pointer is needed because Zone is not moveable (because of mutex)
-    typedef std::vector<std::unique_ptr<Zone>> Zones;
+    typedef std::vector<std::shared_ptr<Zone>> Zones;
     Zones mZones;
     std::string mActiveZoneId;
     bool mDetachOnExit;
+    std::unique_ptr<ZonesManagerRuntimeState> mHandedOverState;
     std::string mExclusiveIDLock;
     Mutex mExclusiveIDMutex; // used to protect mExclusiveIDLock
 
@@ -240,6 +268,8 @@ private:
 #ifdef DBUS_CONNECTION
     HostDbusConnection mHostDbusConnection;
     std::unique_ptr<ProxyCallPolicy> mProxyCallPolicy;
+    std::mutex mProxyCallMutex; // used to protect mPendingProxyCalls
+    std::unordered_map<std::string, unsigned int> mPendingProxyCalls;
     void handleProxyCall(const std::string& caller,
                          const std::string& target,
                          const std::string& targetBusName,
@@ -248,6 +278,7 @@ private:
                          const std::string& targetMethod,
                          GVariant* parameters,
                          dbus::MethodResultBuilder::Pointer result);
+    void releasePendingProxyCall(const std::string& peerId);
 #endif //DBUS_CONNECTION
 };
 
@@ -0,0 +1,324 @@
+/*
+ *  Copyright (c) 2015 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *  Contact: agent (agent@local)
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License
+ */
+
+/**
+ * @file
+ * @author  agent (agent@local)
+ * @brief   Benchmark of the netlink layer and lxcpp network helpers
+ *
+ * It runs in its own user and network namespace, so it needs no privileges
+ * and doesn't touch the host interfaces. Usage:
+ *
+ *   vasum-netlink-benchmark [iterations]
+ */
+
+#include "config.hpp"
+
+#include "lxcpp/network.hpp"
+#include "netlink/netlink-message.hpp"
+
+#include "logger/logger.hpp"
+#include "logger/backend-stderr.hpp"
+#include "utils/exception.hpp"
+#include "utils/fs.hpp"
+#include "utils/make-clean.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <linux/rtnetlink.h>
+#include <linux/veth.h>
+#include <net/if.h>
+#include <sched.h>
+#include <unistd.h>
+
+using namespace lxcpp;
+using namespace vasum::netlink;
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+const unsigned int DEFAULT_ITERATIONS = 1000;
+const unsigned int INTERFACE_COUNTS[] = {10, 100, 1000};
+// interfaces created in one transaction while populating the namespace
+const unsigned int POPULATE_BATCH = 100;
+
+/**
+ * Requests are answered from the cache while it exists, it's disabled by default
+ */
+struct CacheEnabled {
+    CacheEnabled()
+    {
+        setCacheEnabled(true);
+    }
+
+    ~CacheEnabled()
+    {
+        setCacheEnabled(false);
+    }
+};
+
+/**
+ * Latencies of one measured operation
+ */
+class Samples {
+public:
+    explicit Samples(const std::string& name)
+        : mName(name)
+    {
+    }
+
+    void add(Clock::duration duration)
+    {
+        mSamples.push_back(std::chrono::duration<double, std::micro>(duration).count());
+    }
+
+    /**
+     * Print operations per second and median and 99th percentile latency
+     */
+    void report()
+    {
+        if (mSamples.empty()) {
+            return;
+        }
+        double total = 0;
+        for (const double sample : mSamples) {
+            total += sample;
+        }
+        std::sort(mSamples.begin(), mSamples.end());
+        std::cout << std::left << std::setw(40) << mName << std::right
+                  << std::setw(8) << mSamples.size()
+                  << std::setw(14) << std::fixed << std::setprecision(0) << mSamples.size() * 1e6 / total
+                  << std::setw(12) << std::setprecision(1) << percentile(0.50)
+                  << std::setw(12) << percentile(0.99)
+                  << std::endl;
+    }
+
+private:
+    std::string mName;
+    std::vector<double> mSamples;
+
+    double percentile(double p) const
+    {
+        const std::size_t i = static_cast<std::size_t>(p * (mSamples.size() - 1) + 0.5);
+        return mSamples[i];
+    }
+};
+
+template<typename F>
+void measure(const std::string& name, unsigned int iterations, F op)
+{
+    Samples samples(name);
+    for (unsigned int i = 0; i < iterations; ++i) {
+        const Clock::time_point start = Clock::now();
+        op();
+        samples.add(Clock::now() - start);
+    }
+    samples.report();
+}
+
+void enterNamespaces()
+{
+    const uid_t uid = ::getuid();
+    const gid_t gid = ::getgid();
+
+    if (::unshare(CLONE_NEWUSER | CLONE_NEWNET) == -1) {
+        throw std::runtime_error("unshare() failed: " + utils::getSystemErrorMessage());
+    }
+    // root inside is needed to configure the namespace
+    utils::saveFileContent("/proc/self/setgroups", "deny");
+    utils::saveFileContent("/proc/self/uid_map", "0 " + std::to_string(uid) + " 1");
+    utils::saveFileContent("/proc/self/gid_map", "0 " + std::to_string(gid) + " 1");
+
+    NetworkInterface("lo").up();
+}
+
+NetlinkMessage vethMessage(const std::string& ifname, const std::string& peerif)
+{
+    NetlinkMessage nlm(RTM_NEWLINK, NLM_F_REQUEST | NLM_F_CREATE | NLM_F_EXCL | NLM_F_ACK);
+    ifinfomsg info = utils::make_clean<ifinfomsg>();
+    info.ifi_family = AF_UNSPEC;
+    info.ifi_change = 0xFFFFFFFF;
+    nlm.put(info)
+        .put(IFLA_IFNAME, ifname)
+        .beginNested(IFLA_LINKINFO)
+            .put(IFLA_INFO_KIND, "veth")
+            .beginNested(IFLA_INFO_DATA)
+                .beginNested(VETH_INFO_PEER)
+                    .put(info)
+                    .put(IFLA_IFNAME, peerif)
+                .endNested()
+            .endNested()
+        .endNested();
+    return nlm;
+}
+
+unsigned int countMessages(NetlinkResponse&& response)
+{
+    unsigned int count = 0;
+    while (response.hasMessage()) {
+        ++count;
+        response.fetchNextMessage();
+    }
+    return count;
+}
+
+void benchMessages(unsigned int iterations)
+{
+    measure("build veth message", iterations, []() {
+        vethMessage("bench-veth0", "bench-veth1");
+    });
+
+    measure("get link round trip", iterations, []() {
+        NetlinkMessage nlm(RTM_GETLINK, NLM_F_REQUEST | NLM_F_ACK);
+        ifinfomsg info = utils::make_clean<ifinfomsg>();
+        info.ifi_family = AF_UNSPEC;
+        nlm.put(info)
+            .put(IFLA_IFNAME, "lo")
+            .setUncached();
+        countMessages(send(nlm));
+    });
+
+    {
+        CacheEnabled cache;
+        measure("get link from cache", iterations, []() {
+            NetlinkMessage nlm(RTM_GETLINK, NLM_F_REQUEST | NLM_F_ACK);
+            ifinfomsg info = utils::make_clean<ifinfomsg>();
+            info.ifi_family = AF_UNSPEC;
+            nlm.put(info)
+                .put(IFLA_IFNAME, "lo");
+            countMessages(send(nlm));
+        });
+    }
+}
+
+void populate(unsigned int from, unsigned int to)
+{
+    for (unsigned int i = from; i < to;) {
+        NetworkBatch batch;
+        for (unsigned int end = std::min(to, i + POPULATE_BATCH); i < end; ++i) {
+            batch.createBridge("bench-br" + std::to_string(i));
+        }
+        batch.commit();
+    }
+    for (unsigned int i = from; i < to;) {
+        NetworkBatch batch;
+        for (unsigned int end = std::min(to, i + POPULATE_BATCH); i < end; ++i) {
+            const std::string ip = "10." + std::to_string(i >> 8) + "." + std::to_string(i & 0xFF) + ".1";
+            batch.addInetAddrs("bench-br" + std::to_string(i), {InetAddr(ip, 24)});
+        }
+        batch.commit();
+    }
+}
+
+void benchDumps(unsigned int iterations)
+{
+    unsigned int created = 0;
+    for (const unsigned int count : INTERFACE_COUNTS) {
+        populate(created, count);
+        created = count;
+        const std::string suffix = " (" + std::to_string(count) + " interfaces)";
+        // big dumps take long, keep the time of each size similar
+        const unsigned int n = std::max(10u, iterations * 10 / count);
+
+        measure("link dump" + suffix, n, []() {
+            NetlinkMessage nlm(RTM_GETLINK, NLM_F_REQUEST | NLM_F_ACK | NLM_F_DUMP);
+            ifinfomsg info = utils::make_clean<ifinfomsg>();
+            info.ifi_family = AF_UNSPEC;
+            nlm.put(info)
+                .setUncached();
+            countMessages(send(nlm));
+        });
+
+        {
+            CacheEnabled cache;
+            measure("link dump from cache" + suffix, n, []() {
+                NetworkInterface::getInterfaces(0);
+            });
+        }
+
+        measure("address dump" + suffix, n, []() {
+            NetlinkMessage nlm(RTM_GETADDR, NLM_F_REQUEST | NLM_F_ACK | NLM_F_DUMP);
+            ifaddrmsg addr = utils::make_clean<ifaddrmsg>();
+            addr.ifa_family = AF_UNSPEC;
+            nlm.put(addr)
+                .setUncached();
+            countMessages(send(nlm));
+        });
+    }
+    // interfaces disappear together with the namespace
+}
+
+void benchVeth(unsigned int iterations)
+{
+    Samples create("veth create");
+    Samples destroy("veth destroy");
+    NetworkInterface veth("bench-veth0");
+    for (unsigned int i = 0; i < iterations; ++i) {
+        Clock::time_point start = Clock::now();
+        veth.create(InterfaceType::VETH, "bench-veth1");
+        create.add(Clock::now() - start);
+
+        start = Clock::now();
+        veth.destroy();
+        destroy.add(Clock::now() - start);
+    }
+    create.report();
+    destroy.report();
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    logger::Logger::setLogLevel(logger::LogLevel::WARN);
+    logger::Logger::setLogBackend(new logger::StderrBackend());
+
+    const unsigned int iterations = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : DEFAULT_ITERATIONS;
+    if (iterations == 0) {
+        std::cerr << "Usage: " << argv[0] << " [iterations]" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    try {
+        enterNamespaces();
+
+        std::cout << std::left << std::setw(40) << "operation" << std::right
+                  << std::setw(8) << "count"
+                  << std::setw(14) << "ops/s"
+                  << std::setw(12) << "p50 [us]"
+                  << std::setw(12) << "p99 [us]"
+                  << std::endl;
+
+        benchMessages(iterations);
+        benchVeth(iterations);
+        benchDumps(iterations);
+    } catch (const std::exception& e) {
+        std::cerr << "Benchmark failed: " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -426,6 +426,42 @@ BOOST_AUTO_TEST_CASE(Provision)
     vsm_client_free(client);
 }
 
+BOOST_AUTO_TEST_CASE(ProvisionBatch)
+{
+    VsmClient client = vsm_client_create();
+    BOOST_REQUIRE_EQUAL(VSMCLIENT_SUCCESS, vsm_connect(client));
+    const std::string zone = cm->getRunningForegroundZoneId();
+
+    VsmDeclaration batch[2] = {VsmDeclaration(), VsmDeclaration()};
+    batch[0].type = VSMDECLARATION_FILE;
+    batch[0].fileType = VSMFILE_DIRECTORY;
+    batch[0].target = "/tmp/batch";
+    batch[0].mode = 0755;
+    batch[1].type = VSMDECLARATION_LINK;
+    batch[1].source = "/tmp/fake";
+    batch[1].target = "/tmp/batch/link";
+    BOOST_REQUIRE_EQUAL(VSMCLIENT_SUCCESS, vsm_declare_batch(client, zone.c_str(), batch, 2));
+
+    VsmArrayString declarations;
+    BOOST_REQUIRE_EQUAL(VSMCLIENT_SUCCESS, vsm_list_declarations(client, zone.c_str(), &declarations));
+    BOOST_REQUIRE(declarations != NULL && declarations[0] != NULL && declarations[1] != NULL);
+    BOOST_CHECK(declarations[2] == NULL);
+    vsm_array_string_free(declarations);
+
+    // an already declared link rejects the whole batch
+    batch[0].target = "/tmp/batch2";
+    BOOST_CHECK(VSMCLIENT_SUCCESS != vsm_declare_batch(client, zone.c_str(), batch, 2));
+
+    BOOST_REQUIRE_EQUAL(VSMCLIENT_SUCCESS, vsm_list_declarations(client, zone.c_str(), &declarations));
+    BOOST_REQUIRE(declarations != NULL && declarations[0] != NULL && declarations[1] != NULL);
+    BOOST_CHECK(declarations[2] == NULL);
+    for (VsmString* declaration = declarations; *declaration != NULL; ++declaration) {
+        BOOST_CHECK_EQUAL(VSMCLIENT_SUCCESS, vsm_remove_declaration(client, zone.c_str(), *declaration));
+    }
+    vsm_array_string_free(declarations);
+    vsm_client_free(client);
+}
+
 BOOST_AUTO_TEST_CASE(ZoneGetNetdevs)
 {
     const std::string activeZoneId = "zone1";
@@ -441,6 +477,28 @@ BOOST_AUTO_TEST_CASE(ZoneGetNetdevs)
     vsm_client_free(client);
 }
 
+BOOST_AUTO_TEST_CASE(NetdevApplyInvalidConfig)
+{
+    const std::string activeZoneId = "zone1";
+    const char* addresses[] = {"10.0.0.1/33"};
+
+    VsmNetdevConfig config = VsmNetdevConfig();
+    config.name = "nonexistent";
+    config.type = VSMNETDEV_PHYS;
+    config.addresses = addresses;
+    config.addressCount = 1;
+    config.up = 1;
+
+    VsmClient client = vsm_client_create();
+    VsmStatus status = vsm_connect(client);
+    BOOST_REQUIRE_EQUAL(VSMCLIENT_SUCCESS, status);
+    VsmArrayString changes = NULL;
+    status = vsm_netdev_apply(client, activeZoneId.c_str(), &config, &changes);
+    BOOST_CHECK_EQUAL(VSMCLIENT_CUSTOM_ERROR, status);
+    BOOST_CHECK(changes == NULL);
+    vsm_client_free(client);
+}
+
 BOOST_AUTO_TEST_CASE(DefaultDispatcher)
 {
     VsmClient client = vsm_client_create();
@@ -0,0 +1,244 @@
+/*
+ *  Copyright (c) 2015 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *  Contact: agent (agent@local)
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License
+ */
+
+/**
+ * @file
+ * @author  agent (agent@local)
+ * @brief   Unit tests of lxcpp console
+ */
+
+#include "config.hpp"
+#include "ut.hpp"
+
+#include "lxcpp/commands/console.hpp"
+#include "lxcpp/guard/api.hpp"
+#include "lxcpp/terminal.hpp"
+
+#include "cargo-ipc/client.hpp"
+#include "cargo-ipc/service.hpp"
+#include "cargo-ipc/epoll/thread-dispatcher.hpp"
+#include "utils/fd-utils.hpp"
+
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+
+namespace {
+
+const std::string SOCKET_PATH = "/tmp/ut-console.socket";
+const std::size_t TOTAL_SIZE = 256 * 1024 * 1024;
+const std::size_t CHUNK_SIZE = 64 * 1024;
+const std::size_t PATTERN_PERIOD = 251;
+const int TIMEOUT = 5000; //ms
+const char QUIT_KEY = 0x1d; // ^]
+const unsigned int LOG_SIZE = 1024 * 1024;
+const int STALE_LINES = 10;
+const int TOTAL_LINES = 2000;
+
+struct Fixture {
+    cargo::ipc::epoll::ThreadDispatcher mServiceDispatcher;
+    cargo::ipc::epoll::ThreadDispatcher mClientDispatcher;
+    std::unique_ptr<cargo::ipc::Service> mService;
+    std::unique_ptr<cargo::ipc::Client> mClient;
+
+    // the container's side, the console is attached to the master
+    lxcpp::PTYsConfig mTerminals;
+    int mAppFD;
+
+    // the user's side, the console works on the slave
+    int mTermMasterFD;
+    int mTermInFD;
+    int mTermOutFD;
+
+    std::string mPattern;
+
+    Fixture()
+    {
+        ::unlink(SOCKET_PATH.c_str());
+        mService.reset(new cargo::ipc::Service(mServiceDispatcher.getPoll(), SOCKET_PATH));
+        mService->setMethodHandler<lxcpp::api::Void, lxcpp::api::Int>(lxcpp::api::METHOD_RESIZE_TERM,
+            [](const cargo::ipc::PeerID, std::shared_ptr<lxcpp::api::Int>&, cargo::ipc::MethodResult::Pointer result) {
+                result->setVoid();
+                return cargo::ipc::HandlerExitCode::SUCCESS;
+            });
+        mService->start();
+        mClient.reset(new cargo::ipc::Client(mClientDispatcher.getPoll(), SOCKET_PATH));
+        mClient->start();
+
+        const auto app = lxcpp::openPty(true);
+        mTerminals.mCount = 1;
+        mTerminals.mPTYs.emplace_back(app.first, app.second);
+        mAppFD = utils::open(app.second, O_RDWR | O_NOCTTY | O_CLOEXEC);
+
+        const auto term = lxcpp::openPty(true);
+        mTermMasterFD = term.first;
+        mTermInFD = utils::open(term.second, O_RDWR | O_NOCTTY | O_CLOEXEC);
+        mTermOutFD = utils::open(term.second, O_RDWR | O_NOCTTY | O_CLOEXEC);
+
+        for (std::size_t i = 0; i < CHUNK_SIZE + PATTERN_PERIOD; ++i) {
+            mPattern.push_back(static_cast<char>(i % PATTERN_PERIOD));
+        }
+    }
+
+    ~Fixture()
+    {
+        for (const int fd : {mAppFD, mTerminals.mPTYs[0].mMasterFD.value,
+                             mTermMasterFD, mTermInFD, mTermOutFD}) {
+            ::close(fd);
+        }
+        mClient->stop();
+        mService->stop();
+        ::unlink(SOCKET_PATH.c_str());
+    }
+
+    const char* pattern(std::size_t offset) const
+    {
+        return mPattern.data() + offset % PATTERN_PERIOD;
+    }
+};
+
+} // namespace
+
+BOOST_FIXTURE_TEST_SUITE(LxcppConsoleSuite, Fixture)
+
+using namespace lxcpp;
+
+BOOST_AUTO_TEST_CASE(Throughput)
+{
+    // the container prints a lot at once
+    std::thread app([&] {
+        for (std::size_t written = 0; written < TOTAL_SIZE;) {
+            const ssize_t ret = ::write(mAppFD, pattern(written), CHUNK_SIZE);
+            if (ret <= 0) {
+                break;
+            }
+            written += ret;
+        }
+    });
+
+    // the user's terminal shows it and quits when everything arrived
+    std::size_t received = 0;
+    bool corrupted = false;
+    std::thread term([&] {
+        char buf[CHUNK_SIZE];
+        ::pollfd pfd = {mTermMasterFD, POLLIN, 0};
+        while (received < TOTAL_SIZE && ::poll(&pfd, 1, TIMEOUT) > 0) {
+            const ssize_t ret = ::read(mTermMasterFD, buf, sizeof(buf));
+            if (ret <= 0) {
+                continue;
+            }
+            corrupted = corrupted || ::memcmp(buf, pattern(received), ret) != 0;
+            received += ret;
+        }
+        utils::write(mTermMasterFD, &QUIT_KEY, 1);
+    });
+
+    Console console(mTerminals, *mClient, 0, mTermInFD, mTermOutFD);
+    const auto begin = std::chrono::steady_clock::now();
+    BOOST_REQUIRE_NO_THROW(console.execute());
+    const auto end = std::chrono::steady_clock::now();
+
+    term.join();
+    // unblock the container if the console quit early
+    ::close(mTerminals.mPTYs[0].mMasterFD.value);
+    mTerminals.mPTYs[0].mMasterFD.value = -1;
+    app.join();
+
+    BOOST_CHECK_EQUAL(received, TOTAL_SIZE);
+    BOOST_CHECK(!corrupted);
+
+    const double seconds = std::chrono::duration<double>(end - begin).count();
+    BOOST_TEST_MESSAGE("Console throughput: " << TOTAL_SIZE / seconds / (1024 * 1024) << " MiB/s");
+}
+
+BOOST_AUTO_TEST_CASE(ReplayLogOnce)
+{
+    // the guard's part: output is logged and passed to the PTY only while a console is attached
+    std::mutex mutex;
+    std::string log;
+    bool attached = true; // a previous console left its output in the PTY
+    mService->setMethodHandler<api::Void, api::Int>(api::METHOD_DETACH_TERMINAL,
+        [&](const cargo::ipc::PeerID, std::shared_ptr<api::Int>&, cargo::ipc::MethodResult::Pointer result) {
+            std::lock_guard<std::mutex> lock(mutex);
+            attached = false;
+            result->setVoid();
+            return cargo::ipc::HandlerExitCode::SUCCESS;
+        });
+    mService->setMethodHandler<api::String, api::TerminalLogRequest>(api::METHOD_GET_TERMINAL_LOG,
+        [&](const cargo::ipc::PeerID, std::shared_ptr<api::TerminalLogRequest>& data, cargo::ipc::MethodResult::Pointer result) {
+            std::lock_guard<std::mutex> lock(mutex);
+            attached = attached || data->replay;
+            result->set(std::make_shared<api::String>(log));
+            return cargo::ipc::HandlerExitCode::SUCCESS;
+        });
+    mTerminals.mLogSize = LOG_SIZE;
+
+    std::vector<std::string> lines;
+    std::string expected;
+    for (int i = 0; i < TOTAL_LINES; ++i) {
+        lines.push_back("line " + std::to_string(i) + "\n");
+        expected += lines.back();
+    }
+    auto print = [&](const std::string& line) {
+        std::lock_guard<std::mutex> lock(mutex);
+        log += line;
+        if (attached) {
+            utils::write(mAppFD, line.data(), line.size());
+        }
+    };
+
+    // some output waits in the PTY, the rest is printed while the console attaches
+    for (int i = 0; i < STALE_LINES; ++i) {
+        print(lines[i]);
+    }
+    std::thread app([&] {
+        for (int i = STALE_LINES; i < TOTAL_LINES; ++i) {
+            print(lines[i]);
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+    });
+
+    std::string received;
+    std::thread term([&] {
+        char buf[CHUNK_SIZE];
+        ::pollfd pfd = {mTermMasterFD, POLLIN, 0};
+        while (received.size() < expected.size() && ::poll(&pfd, 1, TIMEOUT) > 0) {
+            const ssize_t ret = ::read(mTermMasterFD, buf, sizeof(buf));
+            if (ret > 0) {
+                received.append(buf, ret);
+            }
+        }
+        utils::write(mTermMasterFD, &QUIT_KEY, 1);
+    });
+
+    Console console(mTerminals, *mClient, 0, mTermInFD, mTermOutFD);
+    BOOST_REQUIRE_NO_THROW(console.execute());
+
+    term.join();
+    app.join();
+
+    // each line is shown once and in order
+    BOOST_CHECK_EQUAL(received.size(), expected.size());
+    BOOST_CHECK(received == expected);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -28,6 +28,9 @@
 #include "lxcpp/lxcpp.hpp"
 #include "lxcpp/exception.hpp"
 #include "lxcpp/filesystem.hpp"
+#include "lxcpp/guard-zygote.hpp"
+#include "lxcpp/netns-pool.hpp"
+#include "lxcpp/network.hpp"
 
 #include "utils/scoped-dir.hpp"
 #include "utils/fs.hpp"
@@ -36,7 +39,10 @@
 #include "utils/exception.hpp"
 #include "utils/spin-wait-for.hpp"
 
+#include <algorithm>
+#include <chrono>
 #include <memory>
+#include <thread>
 
 namespace {
 
@@ -150,6 +156,124 @@ BOOST_AUTO_TEST_CASE(StartStop)
     BOOST_REQUIRE(utils::spinWaitFor(TIMEOUT, [&] {return c->getState() == Container::State::STOPPED;}));
 }
 
+BOOST_AUTO_TEST_CASE(StartProfile)
+{
+    auto c = std::unique_ptr<Container>(createContainer("StartProfile", ROOT_DIR, WORK_DIR));
+    BOOST_CHECK_NO_THROW(c->setInit(COMMAND));
+    BOOST_CHECK_NO_THROW(c->setLogger(logger::LogType::LOG_PERSISTENT_FILE,
+                                      logger::LogLevel::DEBUG,
+                                      LOGGER_FILE));
+
+    BOOST_CHECK_NO_THROW(c->start(TIMEOUT));
+    BOOST_REQUIRE(utils::spinWaitFor(TIMEOUT, [&] {return c->getState() == Container::State::RUNNING;}));
+
+    // phases of the host, the guard and the init, all finished, in order
+    lxcpp::StartProfile profile;
+    BOOST_REQUIRE_NO_THROW(profile = c->getStartProfile());
+    std::vector<std::string> names;
+    std::uint64_t begin = 0;
+    for (const auto& phase : profile.mPhases) {
+        BOOST_CHECK(phase.mBegin >= begin);
+        BOOST_CHECK(phase.mEnd >= phase.mBegin);
+        begin = phase.mBegin;
+        names.push_back(phase.mName);
+    }
+    for (const std::string name : {"start", "guard-exec", "clone", "pivot-and-prep-root"}) {
+        BOOST_CHECK(std::find(names.begin(), names.end(), name) != names.end());
+    }
+
+    BOOST_CHECK_NO_THROW(c->stop(TIMEOUT));
+    BOOST_REQUIRE(utils::spinWaitFor(TIMEOUT, [&] {return c->getState() == Container::State::STOPPED;}));
+}
+
+BOOST_AUTO_TEST_CASE(StartWithGuardZygote)
+{
+    auto zygote = std::make_shared<GuardZygote>(WORK_DIR + "/zygote.socket");
+
+    // the zygote forks a guard for each start
+    for (int i = 0; i < 2; ++i) {
+        auto c = std::unique_ptr<Container>(createContainer("GuardZygote", ROOT_DIR, WORK_DIR));
+        BOOST_CHECK_NO_THROW(c->setInit(COMMAND));
+        BOOST_CHECK_NO_THROW(c->setLogger(logger::LogType::LOG_PERSISTENT_FILE,
+                                          logger::LogLevel::DEBUG,
+                                          LOGGER_FILE));
+        BOOST_CHECK_NO_THROW(c->setGuardZygote(zygote));
+
+        BOOST_CHECK_NO_THROW(c->start(TIMEOUT));
+        BOOST_REQUIRE(utils::spinWaitFor(TIMEOUT, [&] {return c->getState() == Container::State::RUNNING;}));
+        BOOST_CHECK(c->getGuardPid() > 0);
+        BOOST_CHECK(c->getGuardPid() != zygote->getPid());
+
+        BOOST_CHECK_NO_THROW(c->stop(TIMEOUT));
+        BOOST_REQUIRE(utils::spinWaitFor(TIMEOUT, [&] {return c->getState() == Container::State::STOPPED;}));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(StartWithNetnsPool)
+{
+    const std::string bridge = "ut-pool-br";
+    const std::string zoneif = "ut-pool";
+    NetworkConfig network;
+    network.addInterfaceConfig(InterfaceConfigType::BRIDGE, bridge, "", {InetAddr("10.100.6.1", 24)});
+    network.addInterfaceConfig(InterfaceConfigType::VETH_BRIDGED, bridge, zoneif);
+
+    {
+        auto pool = std::make_shared<NetnsPool>(network, 1);
+        for (int i = 0; i < 100 && pool->size() == 0; ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        BOOST_REQUIRE_EQUAL(pool->size(), 1u);
+
+        auto c = std::unique_ptr<Container>(createContainer("NetnsPool", ROOT_DIR, WORK_DIR));
+        BOOST_CHECK_NO_THROW(c->setInit(COMMAND));
+        BOOST_CHECK_NO_THROW(c->setLogger(logger::LogType::LOG_PERSISTENT_FILE,
+                                          logger::LogLevel::DEBUG,
+                                          LOGGER_FILE));
+        // addresses differ from the pool ones, they are set per container
+        BOOST_CHECK_NO_THROW(c->addInterfaceConfig(InterfaceConfigType::BRIDGE, bridge, "",
+                                                   {InetAddr("10.100.7.1", 24)}));
+        BOOST_CHECK_NO_THROW(c->addInterfaceConfig(InterfaceConfigType::VETH_BRIDGED, bridge, zoneif));
+        BOOST_CHECK_NO_THROW(c->setNetnsPool(pool));
+
+        BOOST_CHECK_NO_THROW(c->start(TIMEOUT));
+        BOOST_REQUIRE(utils::spinWaitFor(TIMEOUT, [&] {return c->getState() == Container::State::RUNNING;}));
+
+        // the guard got the namespace, so its interfaces weren't created at start
+        std::vector<std::string> names;
+        for (const auto& phase : c->getStartProfile().mPhases) {
+            names.push_back(phase.mName);
+        }
+        BOOST_CHECK(std::find(names.begin(), names.end(), "net-create-all") == names.end());
+        BOOST_CHECK(std::find(names.begin(), names.end(), "net-create-bridges") != names.end());
+        const std::vector<std::string> iflist = c->getInterfaces();
+        BOOST_CHECK(std::find(iflist.begin(), iflist.end(), zoneif) != iflist.end());
+        const std::vector<InetAddr> addrs = NetworkInterface(bridge).getInetAddressList();
+        BOOST_CHECK(std::find(addrs.begin(), addrs.end(), InetAddr("10.100.7.1", 24)) != addrs.end());
+
+        BOOST_CHECK_NO_THROW(c->stop(TIMEOUT));
+        BOOST_REQUIRE(utils::spinWaitFor(TIMEOUT, [&] {return c->getState() == Container::State::STOPPED;}));
+    }
+
+    BOOST_CHECK_NO_THROW(NetworkInterface(bridge).destroy());
+}
+
+BOOST_AUTO_TEST_CASE(StartWithConfigAtGuardExec)
+{
+    auto c = std::unique_ptr<Container>(createContainer("ConfigAtGuardExec", ROOT_DIR, WORK_DIR));
+    BOOST_CHECK_NO_THROW(c->setInit(COMMAND));
+    BOOST_CHECK_NO_THROW(c->setLogger(logger::LogType::LOG_PERSISTENT_FILE,
+                                      logger::LogLevel::DEBUG,
+                                      LOGGER_FILE));
+    BOOST_CHECK_NO_THROW(c->setConfigAtGuardExec(true));
+
+    BOOST_CHECK_NO_THROW(c->start(TIMEOUT));
+    BOOST_REQUIRE(utils::spinWaitFor(TIMEOUT, [&] {return c->getState() == Container::State::RUNNING;}));
+    BOOST_CHECK(c->getInitPid() > 0);
+
+    BOOST_CHECK_NO_THROW(c->stop(TIMEOUT));
+    BOOST_REQUIRE(utils::spinWaitFor(TIMEOUT, [&] {return c->getState() == Container::State::STOPPED;}));
+}
+
 BOOST_AUTO_TEST_CASE(ConnectRunning)
 {
     {
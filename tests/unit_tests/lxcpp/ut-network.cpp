@@ -29,12 +29,22 @@
 #include "logger/logger.hpp"
 
 #include "lxcpp/network-config.hpp"
+#include "lxcpp/netns-pool.hpp"
 #include "lxcpp/process.hpp"
+#include "netlink/netlink.hpp"
+#include "netlink/netlink-message.hpp"
 
 #include "utils/execute.hpp"
+#include "utils/fs.hpp"
 
+#include <chrono>
+#include <cstring>
 #include <iostream>
+#include <memory>
+#include <thread>
 #include <net/if.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
 
 using namespace lxcpp;
 
@@ -54,6 +64,39 @@ struct Fixture {
         return name;
     }
 
+    // dump all links of the own namespace into the buffer, returns the received length
+    static std::size_t dumpLinks(vasum::netlink::Netlink& nl, std::vector<char>& buffer) {
+        struct {
+            nlmsghdr hdr;
+            ifinfomsg info;
+        } request;
+        ::memset(&request, 0, sizeof(request));
+        request.hdr.nlmsg_len = NLMSG_LENGTH(sizeof(ifinfomsg));
+        request.hdr.nlmsg_type = RTM_GETLINK;
+        request.hdr.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+        request.hdr.nlmsg_seq = ++mSeq;
+        request.info.ifi_family = AF_UNSPEC;
+        return nl.rcv(nl.send(&request), buffer);
+    }
+
+    // number of links in a dump, 0 if it isn't terminated properly at the given size
+    static unsigned countLinks(std::vector<char>& buffer, std::size_t size) {
+        unsigned count = 0;
+        unsigned len = size;
+        for (nlmsghdr* msg = reinterpret_cast<nlmsghdr*>(buffer.data()); NLMSG_OK(msg, len); msg = NLMSG_NEXT(msg, len)) {
+            if (msg->nlmsg_type == NLMSG_DONE) {
+                // the answer ends with it
+                return len == NLMSG_ALIGN(msg->nlmsg_len) ? count : 0;
+            }
+            if (msg->nlmsg_type == RTM_NEWLINK) {
+                ++count;
+            }
+        }
+        return 0;
+    }
+
+    static unsigned mSeq;
+
     static void sendCmd(int fd, const char *txt) {
         if (::write(fd, txt, 2) != 2) {
             throw std::runtime_error("pipe write error");
@@ -61,6 +104,7 @@ struct Fixture {
     }
 };
 
+unsigned Fixture::mSeq = 0;
 
 int child_exec(void *_fd)
 {
@@ -139,6 +183,42 @@ BOOST_AUTO_TEST_CASE(NetworkListInterfaces)
 
 }
 
+BOOST_AUTO_TEST_CASE(NetlinkReceiveIntoReusedBuffer)
+{
+    vasum::netlink::Netlink nl;
+    nl.open();
+
+    // an empty buffer grows to fit the whole answer
+    std::vector<char> buffer;
+    const std::size_t size = dumpLinks(nl, buffer);
+    BOOST_CHECK(buffer.size() >= size);
+    const unsigned count = countLinks(buffer, size);
+    BOOST_REQUIRE(count > 0);
+
+    // a bigger buffer left from an earlier answer isn't shrunk, the stale data behind
+    // the new answer isn't taken as a part of it
+    std::vector<char> reused(2 * buffer.size() + 4096, '\xff');
+    const std::size_t reusedSize = reused.size();
+    const std::size_t size2 = dumpLinks(nl, reused);
+    BOOST_CHECK_EQUAL(reused.size(), reusedSize);
+    BOOST_CHECK(size2 < reusedSize);
+    BOOST_CHECK_EQUAL(countLinks(reused, size2), count);
+
+    nl.close();
+}
+
+BOOST_AUTO_TEST_CASE(NetworkReuseConnection)
+{
+    // requests share one cached netlink connection, answers must not get mixed up
+    // (single object query leaves a trailing ACK, dump doesn't, failed query throws)
+    const std::vector<std::string> iflist = NetworkInterface::getInterfaces(0);
+    for (int i = 0; i < 3; ++i) {
+        BOOST_CHECK(NetworkInterface("lo").getAttrs().size() > 0);
+        BOOST_CHECK_THROW(NetworkInterface(getUniqueName("test-none")).getAttrs(), std::exception);
+        BOOST_CHECK(NetworkInterface::getInterfaces(0) == iflist);
+    }
+}
+
 BOOST_AUTO_TEST_CASE(NetworkConfigSerialization)
 {
     std::string tmpConfigFile = "/tmp/netconfig.conf";
@@ -150,9 +230,16 @@ BOOST_AUTO_TEST_CASE(NetworkConfigSerialization)
     cfg.addInterfaceConfig(InterfaceConfigType::BRIDGE, "host-br");
     cfg.addInterfaceConfig(InterfaceConfigType::VETH_BRIDGED, "host-br", "zone-eth0");
     cfg.addInterfaceConfig(InterfaceConfigType::LOOPBACK, "lo");
+    cfg.addInterfaceConfig(InterfaceConfigType::IPVLAN_L3, "host-eth0", "zone-eth1");
 
     cfg.addInetConfig("host-br", InetAddr("1.2.3.4", 24));
 
+    LinkOptions options;
+    options.numTxQueues = 4;
+    options.numRxQueues = 4;
+    cfg.setLinkOptionsConfig("zone-eth0", options);
+    BOOST_CHECK_THROW(cfg.setLinkOptionsConfig("zone-none", options), NetworkException);
+
     cargo::saveToJsonFile(tmpConfigFile, cfg);
 
     NetworkConfig cfg2;
@@ -169,6 +256,8 @@ BOOST_AUTO_TEST_CASE(NetworkConfigSerialization)
         BOOST_CHECK_EQUAL(ni1.getZoneIf(), ni2.getZoneIf());
         BOOST_CHECK(ni1.getType() == ni2.getType());
         BOOST_CHECK(ni1.getMode() == ni2.getMode());
+        BOOST_CHECK_EQUAL(ni1.getLinkOptions().numTxQueues, ni2.getLinkOptions().numTxQueues);
+        BOOST_CHECK_EQUAL(ni1.getLinkOptions().numRxQueues, ni2.getLinkOptions().numRxQueues);
     }
 }
 
@@ -194,6 +283,67 @@ BOOST_AUTO_TEST_CASE(NetworkBridgeCreateDestroy)
     BOOST_CHECK(std::find(iflist.begin(), iflist.end(), ni.getName()) == iflist.end());
 }
 
+BOOST_AUTO_TEST_CASE(NetworkBridgeAddInetAddrs)
+{
+    std::string name = getUniqueName("test-br");
+    NetworkInterface ni(name);
+    std::vector<InetAddr> myips = {
+        InetAddr("10.100.2.1", 32),
+        InetAddr("10.100.2.2", 32),
+        InetAddr("10.100.2.3", 32)
+    };
+
+    BOOST_CHECK_NO_THROW(ni.create(InterfaceType::BRIDGE));
+    BOOST_CHECK_NO_THROW(ni.addInetAddrs(myips));
+
+    std::vector<InetAddr> addrs = ni.getInetAddressList();
+    for (const auto& ip : myips) {
+        BOOST_CHECK(std::find(addrs.begin(), addrs.end(), ip) != addrs.end());
+    }
+
+    // failure of one request in the transaction is reported, the others are applied
+    InetAddr newip("10.100.2.4", 32);
+    BOOST_CHECK_THROW(ni.addInetAddrs({newip, myips[0]}), std::exception);
+    addrs = ni.getInetAddressList();
+    BOOST_CHECK(std::find(addrs.begin(), addrs.end(), newip) != addrs.end());
+
+    BOOST_CHECK_NO_THROW(ni.destroy());
+}
+
+BOOST_AUTO_TEST_CASE(NetworkCachedState)
+{
+    // answers served from cache have to follow the changes like the kernel ones,
+    // the cache is disabled again also when the test fails
+    struct CacheGuard {
+        CacheGuard() { vasum::netlink::setCacheEnabled(true); }
+        ~CacheGuard() { vasum::netlink::setCacheEnabled(false); }
+    };
+    std::unique_ptr<CacheGuard> cacheGuard(new CacheGuard());
+    std::string name = getUniqueName("test-br");
+    NetworkInterface ni(name);
+    InetAddr ip("10.100.3.1", 32);
+
+    BOOST_CHECK_NO_THROW(ni.create(InterfaceType::BRIDGE));
+    std::vector<std::string> iflist = NetworkInterface::getInterfaces(0);
+    BOOST_CHECK(std::find(iflist.begin(), iflist.end(), name) != iflist.end());
+    BOOST_CHECK(ni.getAttrs().size() > 0);
+
+    BOOST_CHECK_NO_THROW(ni.addInetAddr(ip));
+    std::vector<InetAddr> addrs = ni.getInetAddressList();
+    BOOST_CHECK(std::find(addrs.begin(), addrs.end(), ip) != addrs.end());
+    BOOST_CHECK_NO_THROW(ni.delInetAddr(ip));
+    addrs = ni.getInetAddressList();
+    BOOST_CHECK(std::find(addrs.begin(), addrs.end(), ip) == addrs.end());
+
+    BOOST_CHECK_NO_THROW(ni.destroy());
+    iflist = NetworkInterface::getInterfaces(0);
+    BOOST_CHECK(std::find(iflist.begin(), iflist.end(), name) == iflist.end());
+    BOOST_CHECK_THROW(ni.getAttrs(), std::exception);
+
+    cacheGuard.reset();
+    BOOST_CHECK(NetworkInterface::getInterfaces(0) == iflist);
+}
+
 BOOST_AUTO_TEST_CASE(NetworkMacVLanCreateDestroy)
 {
     std::string masterif;
@@ -223,6 +373,124 @@ BOOST_AUTO_TEST_CASE(NetworkMacVLanCreateDestroy)
     BOOST_CHECK(std::find(iflist.begin(), iflist.end(), ni.getName()) == iflist.end());
 }
 
+BOOST_AUTO_TEST_CASE(NetworkVethLinkOptions)
+{
+    NetworkInterface v1(getUniqueName("test-veth"));
+    NetworkInterface v2(getUniqueName("test-veth"));
+
+    LinkOptions options;
+    options.numTxQueues = 4;
+    options.numRxQueues = 4;
+    options.txQueueLen = 5000;
+    BOOST_CHECK_NO_THROW(v1.createVeth(v2.getName(), options));
+
+    // both ends of the pair get the options
+    for (const auto& ni : {v1, v2}) {
+        std::string txqlen;
+        for (const Attr& a : ni.getAttrs()) {
+            if (a.name == AttrName::TXQLEN) {
+                txqlen = a.value;
+            }
+        }
+        BOOST_CHECK_EQUAL(txqlen, "5000");
+        BOOST_CHECK(utils::exists("/sys/class/net/" + ni.getName() + "/queues/tx-3"));
+    }
+
+    BOOST_CHECK_NO_THROW(v1.destroy());
+}
+
+BOOST_AUTO_TEST_CASE(NetworkBatchBridgedVeth)
+{
+    NetworkInterface br(getUniqueName("test-br"));
+    NetworkInterface v1(getUniqueName("test-veth"));
+    NetworkInterface v2(getUniqueName("test-veth"));
+    InetAddr ip("10.100.4.1", 24);
+
+    NetworkBatch bridges;
+    bridges.createBridge(br.getName());
+    BOOST_CHECK_EQUAL(bridges.size(), 1u);
+    BOOST_CHECK_NO_THROW(bridges.commit());
+    BOOST_CHECK_EQUAL(bridges.size(), 0u);
+
+    NetworkBatch batch;
+    batch.createBridgedVeth(v1.getName(), br.getName(), v2.getName(), 0);
+    batch.addInetAddrs(br.getName(), {ip});
+    BOOST_CHECK_NO_THROW(batch.commit());
+
+    BOOST_CHECK(v1.status() == NetStatus::UP);
+    BOOST_CHECK(v2.exists());
+    std::vector<InetAddr> addrs = br.getInetAddressList();
+    BOOST_CHECK(std::find(addrs.begin(), addrs.end(), ip) != addrs.end());
+
+    // failed operation is reported after the whole batch is processed,
+    // interfaces created by the batch are removed
+    NetworkInterface br2(getUniqueName("test-br"));
+    batch.createBridge(br2.getName());
+    batch.createBridge(br.getName());
+    batch.setAttrs(v2.getName(), {Attr{AttrName::MTU, "1400"}});
+    BOOST_CHECK_THROW(batch.commit(), std::exception);
+    BOOST_CHECK(!br2.exists());
+    for (const Attr& a : v2.getAttrs()) {
+        if (a.name == AttrName::MTU) {
+            BOOST_CHECK_EQUAL(a.value, "1400");
+        }
+    }
+
+    // nothing following the failed operation is applied when stopping on error
+    NetworkBatch stopping;
+    stopping.setStopOnError();
+    stopping.createBridge(br2.getName());
+    stopping.createBridge(br.getName());
+    stopping.setAttrs(v2.getName(), {Attr{AttrName::MTU, "1300"}});
+    BOOST_CHECK_THROW(stopping.commit(), std::exception);
+    BOOST_CHECK(!br2.exists());
+    for (const Attr& a : v2.getAttrs()) {
+        if (a.name == AttrName::MTU) {
+            BOOST_CHECK_EQUAL(a.value, "1400");
+        }
+    }
+
+    BOOST_CHECK_NO_THROW(v1.destroy());
+    BOOST_CHECK_NO_THROW(br.destroy());
+}
+
+BOOST_AUTO_TEST_CASE(NetnsPoolBridgedVeth)
+{
+    const std::string bridge = getUniqueName("test-br");
+    const std::string zoneif = getUniqueName("test-np");
+    NetworkConfig network;
+    network.addInterfaceConfig(InterfaceConfigType::BRIDGE, bridge, "", {InetAddr("10.100.5.1", 24)});
+    network.addInterfaceConfig(InterfaceConfigType::VETH_BRIDGED, bridge, zoneif);
+
+    {
+        NetnsPool pool(network, 1);
+        BOOST_CHECK(pool.isCompatible(network));
+        for (int i = 0; i < 100 && pool.size() == 0; ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+
+        int netnsFD = pool.acquire();
+        BOOST_REQUIRE(netnsFD >= 0);
+
+        // host end of the veth pair is already attached and up
+        unsigned hostEnds = 0;
+        for (const auto& ifname : NetworkInterface::getInterfaces(0)) {
+            if (ifname.compare(0, zoneif.size() + 3, zoneif + "-np") == 0) {
+                BOOST_CHECK(NetworkInterface(ifname).status() == NetStatus::UP);
+                ++hostEnds;
+            }
+        }
+        BOOST_CHECK(hostEnds >= 1);
+        ::close(netnsFD);
+
+        NetworkConfig other;
+        other.addInterfaceConfig(InterfaceConfigType::VETH_BRIDGED, bridge, zoneif + "x");
+        BOOST_CHECK(!pool.isCompatible(other));
+    }
+
+    BOOST_CHECK_NO_THROW(NetworkInterface(bridge).destroy());
+}
+
 BOOST_AUTO_TEST_CASE(NetworkListRoutes)
 {
     unsigned mainLo = 0;
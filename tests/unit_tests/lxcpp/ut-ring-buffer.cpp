@@ -0,0 +1,166 @@
+/*
+ *  Copyright (c) 2015 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *  Contact: agent (agent@local)
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License
+ */
+
+/**
+ * @file
+ * @author  agent (agent@local)
+ * @brief   Unit tests of lxcpp ring buffer
+ */
+
+#include "config.hpp"
+#include "ut.hpp"
+
+#include "lxcpp/ring-buffer.hpp"
+
+#include <cerrno>
+#include <string>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+
+// a write to the output pipe bigger than that is partial
+const int OUTPUT_PIPE_SIZE = 4096;
+
+struct Fixture {
+    int in[2];
+    int out[2];
+
+    Fixture()
+    {
+        BOOST_REQUIRE(::pipe2(in, O_NONBLOCK | O_CLOEXEC) == 0);
+        BOOST_REQUIRE(::pipe2(out, O_NONBLOCK | O_CLOEXEC) == 0);
+        BOOST_REQUIRE(::fcntl(out[1], F_SETPIPE_SZ, OUTPUT_PIPE_SIZE) == OUTPUT_PIPE_SIZE);
+    }
+
+    ~Fixture()
+    {
+        for (const int fd : {in[0], in[1], out[0], out[1]}) {
+            ::close(fd);
+        }
+    }
+
+    void put(const std::string& data)
+    {
+        BOOST_REQUIRE(::write(in[1], data.data(), data.size()) == static_cast<ssize_t>(data.size()));
+    }
+
+    std::string get()
+    {
+        std::string data(OUTPUT_PIPE_SIZE, '\0');
+        const ssize_t len = ::read(out[0], &data[0], data.size());
+        data.resize(len > 0 ? len : 0);
+        return data;
+    }
+
+    static std::string pattern(std::size_t size, std::size_t offset = 0)
+    {
+        std::string data;
+        for (std::size_t i = offset; i < offset + size; ++i) {
+            data.push_back('a' + i % 26);
+        }
+        return data;
+    }
+};
+
+} // namespace
+
+BOOST_FIXTURE_TEST_SUITE(LxcppRingBufferSuite, Fixture)
+
+using namespace lxcpp;
+
+BOOST_AUTO_TEST_CASE(RelayWrapped)
+{
+    RingBuffer buffer(8192, 8192);
+
+    put(pattern(6000));
+    BOOST_CHECK_EQUAL(buffer.readFrom(in[0]), 6000);
+    BOOST_CHECK_EQUAL(buffer.writeTo(out[1]), OUTPUT_PIPE_SIZE);
+    BOOST_CHECK_EQUAL(buffer.size(), 6000u - OUTPUT_PIPE_SIZE);
+    std::string output = get();
+
+    // free space is split, the data read now wraps around the end
+    put(pattern(5000, 6000));
+    BOOST_CHECK_EQUAL(buffer.readFrom(in[0]), 5000);
+    BOOST_CHECK_EQUAL(buffer.size(), 11000u - OUTPUT_PIPE_SIZE);
+    while (!buffer.empty()) {
+        BOOST_REQUIRE(buffer.writeTo(out[1]) > 0);
+        output += get();
+    }
+    BOOST_CHECK(output == pattern(11000));
+    BOOST_CHECK_EQUAL(buffer.writeTo(out[1]), 0);
+}
+
+BOOST_AUTO_TEST_CASE(Full)
+{
+    RingBuffer buffer(8, 8);
+
+    put("0123456789");
+    BOOST_CHECK_EQUAL(buffer.readFrom(in[0]), 8);
+    BOOST_CHECK(buffer.full());
+    BOOST_CHECK_EQUAL(buffer.readFrom(in[0]), -1);
+    BOOST_CHECK_EQUAL(errno, ENOBUFS);
+
+    BOOST_CHECK_EQUAL(buffer.writeTo(out[1]), 8);
+    BOOST_CHECK_EQUAL(buffer.readFrom(in[0]), 2);
+    BOOST_CHECK_EQUAL(buffer.writeTo(out[1]), 2);
+    BOOST_CHECK_EQUAL(get(), "0123456789");
+}
+
+BOOST_AUTO_TEST_CASE(Grow)
+{
+    RingBuffer buffer(4, 16);
+
+    put("abc");
+    BOOST_CHECK_EQUAL(buffer.readFrom(in[0]), 3);
+    BOOST_CHECK_EQUAL(buffer.writeTo(out[1]), 3);
+    put("defghijklmnopqrstuvwxyz");
+    BOOST_CHECK_EQUAL(buffer.readFrom(in[0]), 4);
+    BOOST_CHECK_EQUAL(buffer.capacity(), 4u);
+
+    // a full buffer doubles before reading more
+    BOOST_CHECK_EQUAL(buffer.readFrom(in[0]), 4);
+    BOOST_CHECK_EQUAL(buffer.capacity(), 8u);
+    BOOST_CHECK_EQUAL(buffer.readFrom(in[0]), 8);
+    BOOST_CHECK_EQUAL(buffer.capacity(), 16u);
+    BOOST_CHECK(buffer.full());
+
+    BOOST_CHECK_EQUAL(buffer.writeTo(out[1]), 16);
+    BOOST_CHECK_EQUAL(get(), "abcdefghijklmnopqrs");
+}
+
+BOOST_AUTO_TEST_CASE(Push)
+{
+    RingBuffer buffer(4, 8);
+
+    BOOST_CHECK_EQUAL(buffer.push("abcdef", 6), 6u);
+    BOOST_CHECK_EQUAL(buffer.capacity(), 8u);
+    // what doesn't fit is dropped
+    BOOST_CHECK_EQUAL(buffer.push("ghijk", 5), 2u);
+    BOOST_CHECK(buffer.full());
+
+    BOOST_CHECK_EQUAL(buffer.writeTo(out[1]), 8);
+    BOOST_CHECK_EQUAL(get(), "abcdefgh");
+
+    buffer.push("xyz", 3);
+    buffer.clear();
+    BOOST_CHECK(buffer.empty());
+    BOOST_CHECK_EQUAL(buffer.writeTo(out[1]), 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,105 @@
+/*
+ *  Copyright (c) 2015 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *  Contact: agent (agent@local)
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License
+ */
+
+/**
+ * @file
+ * @author  agent (agent@local)
+ * @brief   Unit tests of lxcpp terminal log
+ */
+
+#include "config.hpp"
+#include "ut.hpp"
+
+#include "lxcpp/terminal-log.hpp"
+
+#include "utils/scoped-dir.hpp"
+
+#include <cstdint>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string>
+
+namespace {
+
+const std::string TEST_DIR = "/tmp/ut-terminal-log";
+const std::string LOG_FILE = TEST_DIR + "/terminal.log";
+
+struct Fixture {
+    utils::ScopedDir mTestDir;
+
+    Fixture()
+        : mTestDir(TEST_DIR)
+    {}
+};
+
+} // namespace
+
+BOOST_FIXTURE_TEST_SUITE(LxcppTerminalLogSuite, Fixture)
+
+using namespace lxcpp;
+
+BOOST_AUTO_TEST_CASE(Append)
+{
+    TerminalLog log(8);
+    BOOST_CHECK_EQUAL(log.size(), 0u);
+    BOOST_CHECK_EQUAL(log.tail(), "");
+
+    log.append("abc", 3);
+    log.append("def", 3);
+    BOOST_CHECK_EQUAL(log.size(), 6u);
+    BOOST_CHECK_EQUAL(log.tail(), "abcdef");
+    BOOST_CHECK_EQUAL(log.tail(2), "ef");
+    BOOST_CHECK_EQUAL(log.tail(100), "abcdef");
+}
+
+BOOST_AUTO_TEST_CASE(Overwrite)
+{
+    TerminalLog log(8);
+
+    // the oldest data is overwritten, the newest wraps around the end
+    log.append("abcdef", 6);
+    log.append("ghijk", 5);
+    BOOST_CHECK_EQUAL(log.size(), 8u);
+    BOOST_CHECK_EQUAL(log.tail(), "defghijk");
+    BOOST_CHECK_EQUAL(log.tail(5), "ghijk");
+
+    // only the end of a too big chunk is kept
+    log.append("0123456789", 10);
+    BOOST_CHECK_EQUAL(log.tail(), "23456789");
+}
+
+BOOST_AUTO_TEST_CASE(FileBacked)
+{
+    std::unique_ptr<TerminalLog> log(new TerminalLog(8, LOG_FILE));
+    log->append("abcdefghijk", 11);
+    log.reset();
+
+    // the file outlives the log
+    std::ifstream file(LOG_FILE, std::ios::binary);
+    const std::string content((std::istreambuf_iterator<char>(file)),
+                              std::istreambuf_iterator<char>());
+    BOOST_REQUIRE_EQUAL(content.size(), sizeof(std::uint64_t) + 8);
+
+    std::uint64_t written;
+    content.copy(reinterpret_cast<char*>(&written), sizeof(written));
+    BOOST_CHECK_EQUAL(written, 11u);
+    BOOST_CHECK_EQUAL(content.substr(sizeof(written)), "ijkdefgh");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,84 @@
+/*
+ *  Copyright (c) 2015 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *  Contact: agent <agent@local>
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License
+ */
+
+
+/**
+ * @file
+ * @author  agent (agent@local)
+ * @brief   Unit tests of the ProxyCallPolicy class
+ */
+
+#include "config.hpp"
+
+#include "ut.hpp"
+
+#include "proxy-call-policy.hpp"
+
+#include <string>
+#include <vector>
+
+using namespace vasum;
+
+
+namespace {
+
+const std::vector<ProxyCallRule> RULES = {
+    {"host", "zone1", "org.bus", "/a/b", "org.iface", "Method1"},
+    {"*", "host", "*", "*", "org.iface", "*"},
+    {"zone2", "*", "org.bus", "*", "*", "Method2"}
+};
+
+} // namespace
+
+
+BOOST_AUTO_TEST_SUITE(ProxyCallPolicySuite)
+
+BOOST_AUTO_TEST_CASE(ExactAndWildcardRules)
+{
+    ProxyCallPolicy policy(RULES);
+
+    BOOST_CHECK(policy.isProxyCallAllowed("host", "zone1", "org.bus", "/a/b", "org.iface", "Method1"));
+    BOOST_CHECK(!policy.isProxyCallAllowed("host", "zone1", "org.bus", "/a/b", "org.iface", "Method2"));
+    BOOST_CHECK(!policy.isProxyCallAllowed("host", "zone1", "org.bus", "/a/c", "org.iface", "Method1"));
+
+    BOOST_CHECK(policy.isProxyCallAllowed("zone1", "host", "any.bus", "/x", "org.iface", "Any"));
+    BOOST_CHECK(!policy.isProxyCallAllowed("zone1", "host", "any.bus", "/x", "org.other", "Any"));
+
+    BOOST_CHECK(policy.isProxyCallAllowed("zone2", "zone3", "org.bus", "/x", "org.other", "Method2"));
+    BOOST_CHECK(!policy.isProxyCallAllowed("zone2", "zone3", "org.other", "/x", "org.other", "Method2"));
+}
+
+BOOST_AUTO_TEST_CASE(CachedDecisions)
+{
+    // cache smaller than the number of distinct queries to exercise eviction
+    ProxyCallPolicy policy(RULES, 2);
+
+    for (int i = 0; i < 3; ++i) {
+        BOOST_CHECK(policy.isProxyCallAllowed("host", "zone1", "org.bus", "/a/b", "org.iface", "Method1"));
+        BOOST_CHECK(!policy.isProxyCallAllowed("host", "zone1", "org.bus", "/a/b", "org.iface", "Method2"));
+        BOOST_CHECK(policy.isProxyCallAllowed("zone1", "host", "any.bus", "/x", "org.iface", "Any"));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(NoRules)
+{
+    ProxyCallPolicy policy({});
+    BOOST_CHECK(!policy.isProxyCallAllowed("host", "zone1", "org.bus", "/a/b", "org.iface", "Method1"));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
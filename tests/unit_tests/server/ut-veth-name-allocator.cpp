@@ -0,0 +1,140 @@
+/*
+ *  Copyright (c) 2015 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *  Contact: agent <agent@local>
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License
+ */
+
+
+/**
+ * @file
+ * @author  agent (agent@local)
+ * @brief   Unit tests of the VethNameAllocator class
+ */
+
+#include "config.hpp"
+
+#include "ut.hpp"
+
+#include "veth-name-allocator.hpp"
+#include "netdev.hpp"
+#include "exception.hpp"
+
+#include <set>
+#include <string>
+#include <net/if.h>
+
+using namespace vasum;
+using namespace vasum::netdev;
+
+
+namespace {
+
+// names handed out by allocators limited to 3 numbers
+const std::string VETH1 = "veth01";
+const std::string VETH2 = "veth02";
+const std::string VETH3 = "veth03";
+
+struct Fixture {
+    std::set<std::string> mLinks;
+
+    Fixture()
+    {
+        for (const std::string& name : {VETH1, VETH2, VETH3}) {
+            BOOST_REQUIRE_MESSAGE(::if_nametoindex(name.c_str()) == 0, name << " exists in the host");
+        }
+    }
+
+    ~Fixture()
+    {
+        for (const std::string& name : mLinks) {
+            try {
+                destroyNetdev(name);
+            } catch (const std::exception&) {
+            }
+        }
+    }
+
+    // a link which isn't created by the allocator user
+    void createLink(const std::string& name)
+    {
+        createBridge(name);
+        mLinks.insert(name);
+    }
+
+    void destroyLink(const std::string& name)
+    {
+        destroyNetdev(name);
+        mLinks.erase(name);
+    }
+};
+
+} // namespace
+
+
+BOOST_FIXTURE_TEST_SUITE(VethNameAllocatorSuite, Fixture)
+
+BOOST_AUTO_TEST_CASE(SeedFromHostLinks)
+{
+    createLink(VETH1);
+
+    VethNameAllocator allocator(3);
+    BOOST_CHECK_EQUAL(allocator.allocate(), VETH2);
+    BOOST_CHECK_EQUAL(allocator.allocate(), VETH3);
+    BOOST_CHECK_THROW(allocator.allocate(), ZoneOperationException);
+}
+
+BOOST_AUTO_TEST_CASE(SkipLinkCreatedAfterSeed)
+{
+    VethNameAllocator allocator(3);
+    BOOST_CHECK_EQUAL(allocator.allocate(), VETH1);
+
+    // the next number is taken by someone else
+    createLink(VETH2);
+    BOOST_CHECK_EQUAL(allocator.allocate(), VETH3);
+
+    // and it's free again when the link is removed
+    destroyLink(VETH2);
+    BOOST_CHECK_EQUAL(allocator.allocate(), VETH2);
+}
+
+BOOST_AUTO_TEST_CASE(WrapAroundAfterMaxNumber)
+{
+    VethNameAllocator allocator(3);
+    BOOST_CHECK_EQUAL(allocator.allocate(), VETH1);
+    BOOST_CHECK_EQUAL(allocator.allocate(), VETH2);
+    BOOST_CHECK_EQUAL(allocator.allocate(), VETH3);
+    BOOST_CHECK_THROW(allocator.allocate(), ZoneOperationException);
+
+    allocator.release(VETH2);
+    allocator.release(VETH1);
+    BOOST_CHECK_EQUAL(allocator.allocate(), VETH1);
+    BOOST_CHECK_EQUAL(allocator.allocate(), VETH2);
+    BOOST_CHECK_THROW(allocator.allocate(), ZoneOperationException);
+}
+
+BOOST_AUTO_TEST_CASE(ReleaseOnlyReservations)
+{
+    VethNameAllocator allocator(3);
+    const std::string name = allocator.allocate();
+    createLink(name);
+
+    // the link exists, so releasing the name doesn't free it
+    allocator.release(name);
+    BOOST_CHECK(allocator.allocate() != name);
+    BOOST_CHECK(allocator.allocate() != name);
+    BOOST_CHECK_THROW(allocator.allocate(), ZoneOperationException);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
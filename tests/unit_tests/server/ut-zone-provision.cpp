@@ -239,6 +239,50 @@ BOOST_AUTO_TEST_CASE(Link)
     }
 }
 
+BOOST_AUTO_TEST_CASE(StartOrder)
+{
+    const fs::path mountTarget = fs::path("/opt/usr/data/ut-from-host-provision");
+    const fs::path mountSource = fs::path("/tmp/ut-provision");
+    const fs::path sharedFile = fs::path("ut-regular-file");
+    const fs::path linkFile = fs::path("/opt/usr/ut-from-host-file.txt");
+
+    utils::ScopedDir provisionfs(mountSource.string());
+
+    // declared in reverse order, start() has to put things below mounts and dirs last
+    ZoneProvisioningConfig config;
+    ZoneProvisioningConfig::Provision provision;
+    provision.set(ZoneProvisioningConfig::File({VSMFILE_REGULAR,
+                                    (mountTarget / sharedFile).string(),
+                                    O_CREAT,
+                                    0777}));
+    config.provisions.push_back(provision);
+    provision.set(ZoneProvisioningConfig::Link({SOME_FILE_PATH.string(),
+                                     linkFile.string()}));
+    config.provisions.push_back(provision);
+    provision.set(ZoneProvisioningConfig::Mount({mountSource.string(),
+                                      mountTarget.string(),
+                                      "",
+                                      MS_BIND,
+                                      ""}));
+    config.provisions.push_back(provision);
+    provision.set(ZoneProvisioningConfig::File({VSMFILE_DIRECTORY,
+                                    mountTarget.string(),
+                                    0,
+                                    0777}));
+    config.provisions.push_back(provision);
+    save(config);
+
+    ZoneProvision zoneProvision = create({"/tmp/"});
+    zoneProvision.start();
+
+    BOOST_CHECK(fs::exists(ROOTFS_PATH / mountTarget));
+    BOOST_CHECK(fs::exists(ROOTFS_PATH / linkFile));
+    BOOST_CHECK(fs::exists(ROOTFS_PATH / mountTarget / sharedFile));
+    BOOST_CHECK(fs::exists(mountSource / sharedFile));
+
+    zoneProvision.stop();
+}
+
 BOOST_AUTO_TEST_CASE(DeclareFile)
 {
     ZoneProvision zoneProvision = create({});
@@ -294,6 +338,41 @@ BOOST_AUTO_TEST_CASE(DeclareLink)
     BOOST_CHECK_EQUAL(provision.target, "/fake/path2");
 }
 
+BOOST_AUTO_TEST_CASE(DeclareBatch)
+{
+    ZoneProvision zoneProvision = create({});
+    zoneProvision.declareLink("/fake/path1", "/fake/path2");
+
+    std::vector<ZoneProvisioningConfig::Provision> batch(3);
+    batch[0].set(ZoneProvisioningConfig::File({VSMFILE_DIRECTORY, "/fake/path3", 0, 0777}));
+    batch[1].set(ZoneProvisioningConfig::Mount({"/fake/path1", "/fake/path3", "tmpfs", 077, "fake"}));
+    batch[2].set(ZoneProvisioningConfig::Link({"/fake/path1", "/fake/path2"}));
+
+    // one duplicate rejects the whole batch
+    BOOST_CHECK_THROW(zoneProvision.declareProvisions(std::vector<ZoneProvisioningConfig::Provision>(batch)),
+                      lxcpp::ProvisionExistsException);
+    BOOST_CHECK_EQUAL(zoneProvision.list().size(), 1);
+
+    batch[2].set(ZoneProvisioningConfig::Link({"/fake/path1", "/fake/path3"}));
+    std::vector<ZoneProvisioningConfig::Provision> duplicated = {batch[2], batch[2]};
+    BOOST_CHECK_THROW(zoneProvision.declareProvisions(std::move(duplicated)),
+                      lxcpp::ProvisionExistsException);
+    BOOST_CHECK_EQUAL(zoneProvision.list().size(), 1);
+
+    const std::vector<std::string> ids = zoneProvision.declareProvisions(std::move(batch));
+    const std::vector<std::string> expected = {"file /fake/path3 0 0 511",
+                                               "mount /fake/path1 /fake/path3 tmpfs 63 fake",
+                                               "link /fake/path1 /fake/path3"};
+    BOOST_CHECK(ids == expected);
+
+    ZoneProvisioningConfig config;
+    load(config);
+    BOOST_REQUIRE_EQUAL(config.provisions.size(), 4);
+    BOOST_CHECK(config.provisions[1].is<ZoneProvisioningConfig::File>());
+    BOOST_CHECK(config.provisions[2].is<ZoneProvisioningConfig::Mount>());
+    BOOST_CHECK(config.provisions[3].is<ZoneProvisioningConfig::Link>());
+}
+
 BOOST_AUTO_TEST_CASE(ProvisionedAlready)
 {
     const fs::path dir = fs::path("/opt/usr/data/ut-from-host");
@@ -405,4 +484,32 @@ BOOST_AUTO_TEST_CASE(Remove)
     }
 }
 
+BOOST_AUTO_TEST_CASE(RemoveAndRedeclare)
+{
+    const std::string link1 = "link /fake/path1 /fake/path3";
+    const std::string link2 = "link /fake/path2 /fake/path4";
+    const std::string link3 = "link /fake/path3 /fake/path5";
+    {
+        ZoneProvision zoneProvision = create({});
+        zoneProvision.declareLink("/fake/path1", "/fake/path3");
+        zoneProvision.declareLink("/fake/path2", "/fake/path4");
+        zoneProvision.declareLink("/fake/path3", "/fake/path5");
+
+        zoneProvision.remove(link1);
+        BOOST_CHECK_EXCEPTION(zoneProvision.declareLink("/fake/path2", "/fake/path4"),
+                              lxcpp::ProvisionExistsException,
+                              WhatEquals("Can't add provision. It already exists: " + link2));
+        BOOST_CHECK_EQUAL(zoneProvision.declareLink("/fake/path1", "/fake/path3"), link1);
+        zoneProvision.remove(link2);
+    }
+    {
+        // removals are persistent as well
+        ZoneProvision zoneProvision = create({});
+        const std::vector<std::string> expected = {link3, link1};
+        BOOST_CHECK(zoneProvision.list() == expected);
+        zoneProvision.remove(link3);
+        BOOST_CHECK_NO_THROW(zoneProvision.remove(link1));
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -37,13 +37,18 @@
 #include "cargo-json/cargo-json.hpp"
 #include "cargo/exception.hpp"
 #include "netdev.hpp"
+#include "netlink/netlink-message.hpp"
 
+#include <algorithm>
 #include <memory>
+#include <set>
 #include <string>
 #include <thread>
 #include <chrono>
 #include <sys/socket.h>
 #include <linux/if.h>
+#include <linux/rtnetlink.h>
+#include <linux/pkt_sched.h>
 
 using namespace utils;
 using namespace vasum;
@@ -101,6 +106,42 @@ struct Fixture {
     }
 
 
+    // host side index of a zone veth
+    static int getPeerIndex(const Zone::NetdevAttrs& attrs)
+    {
+        for (const auto& attr : attrs) {
+            if (std::get<0>(attr) == "link") {
+                return std::stoi(std::get<1>(attr));
+            }
+        }
+        return 0;
+    }
+
+    // priorities of ingress filters of a host network device
+    static std::set<uint32_t> getIngressFilters(int index)
+    {
+        using namespace vasum::netlink;
+        NetlinkMessage nlm(RTM_GETTFILTER, NLM_F_REQUEST | NLM_F_ACK | NLM_F_DUMP);
+        tcmsg tc = tcmsg();
+        tc.tcm_family = AF_UNSPEC;
+        tc.tcm_ifindex = index;
+        tc.tcm_parent = TC_H_MAKE(TC_H_INGRESS, 0);
+        nlm.put(tc);
+        NetlinkResponse response = send(nlm);
+
+        std::set<uint32_t> priorities;
+        for (; response.hasMessage(); response.fetchNextMessage()) {
+            if (response.getMessageType() != RTM_NEWTFILTER) {
+                continue;
+            }
+            response.fetch(tc);
+            if (tc.tcm_ifindex == index) {
+                priorities.insert(TC_H_MAJ(tc.tcm_info) >> 16);
+            }
+        }
+        return priorities;
+    }
+
     static void ensureStarted()
     {
         // wait for zones init to fully start
@@ -464,4 +505,104 @@ BOOST_AUTO_TEST_CASE(DelNetdevIpAddress)
     BOOST_CHECK_THROW(c->deleteNetdevIpAddress(ZONE_NETDEV, "2001:db8::1/64"), VasumException);
 }
 
+BOOST_AUTO_TEST_CASE(ApplyNetdevTwice)
+{
+    // attributes which don't change by themselves after the link goes up
+    auto stableAttrs = [](const Zone::NetdevAttrs& attrs) {
+        Zone::NetdevAttrs result;
+        for (const auto& attr : attrs) {
+            if (std::get<0>(attr) == "mtu" || std::get<0>(attr) == "ipv4") {
+                result.push_back(attr);
+            }
+        }
+        return result;
+    };
+
+    setupBridge(BRIDGE_NAME);
+    auto c = create(TEST_CONFIG_PATH);
+    c->start();
+    ensureStarted();
+
+    netdev::DeviceConfig config;
+    config.name = ZONE_NETDEV;
+    config.type = netdev::DeviceConfig::Type::VETH;
+    config.hostDev = BRIDGE_NAME;
+    config.macvlanMode = MACVLAN_MODE_PRIVATE;
+    config.mtu = 1400;
+    config.addresses = {"192.168.4.1/24", "192.168.5.1/24"};
+    config.routes = {{"10.1.0.0/16", "192.168.4.254", 0}};
+    config.up = true;
+
+    const std::vector<std::string> changes = c->applyNetdev(config);
+    BOOST_CHECK(!changes.empty());
+    const Zone::NetdevAttrs attrs = stableAttrs(c->getNetdevAttrs(ZONE_NETDEV));
+
+    BOOST_CHECK(c->applyNetdev(config).empty());
+    const Zone::NetdevAttrs attrsAgain = stableAttrs(c->getNetdevAttrs(ZONE_NETDEV));
+    BOOST_CHECK(attrs == attrsAgain);
+    BOOST_CHECK(std::find(attrsAgain.begin(), attrsAgain.end(),
+                          std::make_tuple(std::string("mtu"), std::string("1400"))) != attrsAgain.end());
+}
+
+BOOST_AUTO_TEST_CASE(SetNetdevBandwidth)
+{
+    setupBridge(BRIDGE_NAME);
+    auto c = create(TEST_CONFIG_PATH);
+    c->start();
+    ensureStarted();
+    c->createNetdevVeth(ZONE_NETDEV, BRIDGE_NAME);
+
+    BOOST_CHECK_NO_THROW(c->setNetdevBandwidth(ZONE_NETDEV, {10000000, 0, 0}));
+    BOOST_CHECK_NO_THROW(c->setNetdevBandwidth(ZONE_NETDEV, {20000000, 0, 100000}));
+    BOOST_CHECK_NO_THROW(c->setNetdevBandwidth(ZONE_NETDEV, {0, 0, 0}));
+    BOOST_CHECK_THROW(c->setNetdevBandwidth(ZONE_NETDEV, {10000000, 0, 100}), VasumException);
+    BOOST_CHECK_THROW(c->setNetdevBandwidth("lo", {10000000, 0, 0}), VasumException);
+}
+
+BOOST_AUTO_TEST_CASE(SetNetdevUploadBandwidth)
+{
+    setupBridge(BRIDGE_NAME);
+    auto c = create(TEST_CONFIG_PATH);
+    c->start();
+    ensureStarted();
+    c->createNetdevVeth(ZONE_NETDEV, BRIDGE_NAME);
+    const int hostIndex = getPeerIndex(c->getNetdevAttrs(ZONE_NETDEV));
+    BOOST_REQUIRE(hostIndex != 0);
+
+    BOOST_REQUIRE_NO_THROW(c->setNetdevBandwidth(ZONE_NETDEV, {0, 8000000, 0}));
+    const std::set<uint32_t> policers = getIngressFilters(hostIndex);
+    BOOST_CHECK_EQUAL(policers.size(), 1u);
+
+    // the new policer replaces the old one
+    BOOST_REQUIRE_NO_THROW(c->setNetdevBandwidth(ZONE_NETDEV, {10000000, 16000000, 0}));
+    const std::set<uint32_t> changed = getIngressFilters(hostIndex);
+    BOOST_CHECK_EQUAL(changed.size(), 1u);
+    BOOST_CHECK(changed != policers);
+
+    // invalid limits keep the current ones
+    BOOST_CHECK_THROW(c->setNetdevBandwidth(ZONE_NETDEV, {0, 8000000, 100}), VasumException);
+    BOOST_CHECK(getIngressFilters(hostIndex) == changed);
+
+    BOOST_REQUIRE_NO_THROW(c->setNetdevBandwidth(ZONE_NETDEV, {0, 0, 0}));
+    BOOST_CHECK(getIngressFilters(hostIndex).empty());
+}
+
+BOOST_AUTO_TEST_CASE(GetNetdevStats)
+{
+    setupBridge(BRIDGE_NAME);
+    auto c = create(TEST_CONFIG_PATH);
+    c->start();
+    ensureStarted();
+    c->createNetdevVeth(ZONE_NETDEV, BRIDGE_NAME);
+
+    BOOST_CHECK_NO_THROW(c->sampleNetdevStats());
+    BOOST_CHECK_NO_THROW(c->sampleNetdevStats());
+
+    const auto stats = c->getNetdevStats();
+    const auto isNetdev = [](const Zone::NetdevStats& netdev) {
+        return netdev.counters.name == ZONE_NETDEV;
+    };
+    BOOST_CHECK(std::find_if(stats.begin(), stats.end(), isNetdev) != stats.end());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
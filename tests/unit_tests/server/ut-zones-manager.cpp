@@ -88,6 +88,7 @@ const std::string FILE_CONTENT = "File content\n"
 const std::string NON_EXISTANT_ZONE_ID = "NON_EXISTANT_ZONE_ID";
 const std::string ZONES_PATH = "/tmp/ut-zones"; // the same as in daemon.conf
 const std::string SIMPLE_TEMPLATE = "console-ipc";
+const unsigned int MAX_PENDING_PROXY_CALLS = 64; // the same as in zones-manager.cpp
 
 #ifdef DBUS_CONNECTION
 /**
@@ -214,6 +215,30 @@ public:
         return ret;
     }
 
+    void testApiProxyCallAsync(const std::string& target,
+                               const std::string& argument,
+                               const VoidResultCallback& result)
+    {
+        auto asyncResult = [result](dbus::AsyncMethodCallResult& asyncMethodCallResult) {
+            asyncMethodCallResult.get();
+            result();
+        };
+
+        GVariant* packedParameters = g_variant_new("(sssssv)",
+                                                   target.c_str(),
+                                                   testapi::BUS_NAME.c_str(),
+                                                   testapi::OBJECT_PATH.c_str(),
+                                                   testapi::INTERFACE.c_str(),
+                                                   testapi::METHOD.c_str(),
+                                                   g_variant_new("(s)", argument.c_str()));
+        mClient->callMethodAsync(api::dbus::BUS_NAME,
+                                 api::dbus::OBJECT_PATH,
+                                 api::dbus::INTERFACE,
+                                 api::dbus::METHOD_PROXY_CALL,
+                                 packedParameters,
+                                 "(v)",
+                                 dropException(asyncResult));
+    }
 
     GVariantPtr proxyCall(const std::string& target,
                           const std::string& busName,
@@ -687,6 +712,42 @@ BOOST_AUTO_TEST_CASE(DetachOnExit)
     }
 }
 
+BOOST_AUTO_TEST_CASE(RuntimeStateHandoff)
+{
+    ZonesManagerRuntimeState state;
+    {
+        ZonesManager cm(dispatcher.getPoll(), TEST_CONFIG_PATH);
+        cm.start();
+        cm.createZone("zone1", SIMPLE_TEMPLATE);
+        cm.createZone("zone2", SIMPLE_TEMPLATE);
+        cm.restoreAll();
+        cm.focus("zone2");
+        state = cm.getRuntimeState();
+        cm.setZonesDetachOnExit();
+    }
+    BOOST_CHECK_EQUAL(state.activeZoneId, "zone2");
+    BOOST_REQUIRE_EQUAL(state.zones.size(), 2);
+    for (auto& zoneState : state.zones) {
+        BOOST_CHECK_EQUAL(zoneState.state, "RUNNING");
+        BOOST_CHECK(zoneState.initPid > 0);
+        BOOST_CHECK(zoneState.initStartTime > 0);
+
+        // both zones keep running, only a valid handed over state is trusted
+        zoneState.state = "FROZEN";
+        if (zoneState.id == "zone2") {
+            ++zoneState.initStartTime;
+        }
+    }
+    {
+        ZonesManager cm(dispatcher.getPoll(), TEST_CONFIG_PATH);
+        cm.setRuntimeState(state);
+        cm.start();
+        BOOST_CHECK(cm.isPaused("zone1"));
+        BOOST_CHECK(cm.isRunning("zone2"));
+        BOOST_CHECK_EQUAL(cm.getRunningForegroundZoneId(), "zone2");
+    }
+}
+
 BOOST_AUTO_TEST_CASE(Focus)
 {
     ZonesManager cm(dispatcher.getPoll(), TEST_CONFIG_PATH);
@@ -810,6 +871,59 @@ MULTI_FIXTURE_TEST_CASE(ProxyCall, F, DbusFixture)
                           DbusCustomException,
                           WhatEquals("Proxy call forbidden"));
 }
+
+MULTI_FIXTURE_TEST_CASE(ProxyCallPendingLimit, F, DbusFixture)
+{
+    ZonesManager cm(F::dispatcher.getPoll(), TEST_CONFIG_PATH);
+    cm.start();
+
+    typename F::HostAccessory host;
+    host.setName(testapi::BUS_NAME);
+
+    // calls with "hold" are answered only when the test releases them
+    std::mutex heldMutex;
+    std::vector<MethodResultBuilder::Pointer> heldResults;
+    Latch callHeld;
+    auto handler = [&](const std::string& argument, MethodResultBuilder::Pointer result) {
+        if (argument == "hold") {
+            std::lock_guard<std::mutex> lock(heldMutex);
+            heldResults.push_back(result);
+            callHeld.set();
+        } else {
+            std::string ret = "reply from host: " + argument;
+            result->set(g_variant_new("(s)", ret.c_str()));
+        }
+    };
+    host.registerTestApiObject(handler);
+
+    Latch callDone;
+    auto resultCallback = [&]() {
+        callDone.set();
+    };
+
+    for (unsigned int i = 0; i < MAX_PENDING_PROXY_CALLS; ++i) {
+        host.testApiProxyCallAsync("host", "hold", resultCallback);
+    }
+    BOOST_REQUIRE(callHeld.waitForN(MAX_PENDING_PROXY_CALLS, EVENT_TIMEOUT));
+
+    // limit reached
+    BOOST_CHECK_EXCEPTION(host.testApiProxyCall("host", "param"),
+                          DbusCustomException,
+                          WhatEquals("Too many pending proxy calls"));
+
+    // replies release the pending calls
+    {
+        std::lock_guard<std::mutex> lock(heldMutex);
+        for (auto& result : heldResults) {
+            result->set(g_variant_new("(s)", "released"));
+        }
+        heldResults.clear();
+    }
+    BOOST_REQUIRE(callDone.waitForN(MAX_PENDING_PROXY_CALLS, EVENT_TIMEOUT));
+
+    BOOST_CHECK_EQUAL("reply from host: param",
+                      host.testApiProxyCall("host", "param"));
+}
 #endif //DBUS_CONNECTION
 
 namespace {